@@ -0,0 +1,68 @@
+# Command-line tools built against the plugin's shared code (Cellyz.a).
+# This lives beside the Projucer-generated Makefile, which it includes for the
+# configuration, flags and the shared code target, so re-saving test.jucer
+# doesn't lose these targets.
+#
+#   make -f Tools.mk CONFIG=Release benchmark
+#   make -f Tools.mk CONFIG=Release render
+
+include Makefile
+
+JUCE_TARGET_BENCHMARK := CellyzBenchmark
+JUCE_TARGET_RENDER := CellyzRender
+
+OBJECTS_BENCHMARK := \
+  $(JUCE_OBJDIR)/CellyzBenchmark.o \
+  $(JUCE_OBJDIR)/StageBenchmarks.o \
+
+OBJECTS_RENDER := \
+  $(JUCE_OBJDIR)/CellyzRender.o \
+  $(JUCE_OBJDIR)/OfflineRenderer.o \
+  $(JUCE_OBJDIR)/BatchRenderer.o \
+
+.PHONY: tools benchmark render
+.DEFAULT_GOAL := tools
+
+tools : benchmark render
+
+benchmark : $(JUCE_OUTDIR)/$(JUCE_TARGET_BENCHMARK)
+
+$(JUCE_OUTDIR)/$(JUCE_TARGET_BENCHMARK) : $(OBJECTS_BENCHMARK) $(JUCE_OBJDIR)/execinfo.cmd $(JUCE_OUTDIR)/$(JUCE_TARGET_SHARED_CODE) $(JUCE_OBJDIR)/cxxfs.cmd
+	@echo Linking "Cellyz - Benchmark"
+	-$(V_AT)mkdir -p $(JUCE_OUTDIR)
+	$(V_AT)$(CXX) -o $(JUCE_OUTDIR)/$(JUCE_TARGET_BENCHMARK) $(OBJECTS_BENCHMARK) $(JUCE_OUTDIR)/$(JUCE_TARGET_SHARED_CODE) $(JUCE_LDFLAGS) $(shell cat $(JUCE_OBJDIR)/execinfo.cmd) $(shell cat $(JUCE_OBJDIR)/cxxfs.cmd) $(TARGET_ARCH)
+
+$(JUCE_OBJDIR)/CellyzBenchmark.o: ../../Tools/Benchmark/CellyzBenchmark.cpp
+	-$(V_AT)mkdir -p $(@D)
+	@echo "Compiling CellyzBenchmark.cpp"
+	$(V_AT)$(CXX) $(JUCE_CXXFLAGS) -o "$@" -c "$<"
+
+$(JUCE_OBJDIR)/StageBenchmarks.o: ../../Tools/Benchmark/StageBenchmarks.cpp
+	-$(V_AT)mkdir -p $(@D)
+	@echo "Compiling StageBenchmarks.cpp"
+	$(V_AT)$(CXX) $(JUCE_CXXFLAGS) -o "$@" -c "$<"
+
+render : $(JUCE_OUTDIR)/$(JUCE_TARGET_RENDER)
+
+$(JUCE_OUTDIR)/$(JUCE_TARGET_RENDER) : $(OBJECTS_RENDER) $(JUCE_OBJDIR)/execinfo.cmd $(JUCE_OUTDIR)/$(JUCE_TARGET_SHARED_CODE) $(JUCE_OBJDIR)/cxxfs.cmd
+	@echo Linking "Cellyz - Render"
+	-$(V_AT)mkdir -p $(JUCE_OUTDIR)
+	$(V_AT)$(CXX) -o $(JUCE_OUTDIR)/$(JUCE_TARGET_RENDER) $(OBJECTS_RENDER) $(JUCE_OUTDIR)/$(JUCE_TARGET_SHARED_CODE) $(JUCE_LDFLAGS) $(shell cat $(JUCE_OBJDIR)/execinfo.cmd) $(shell cat $(JUCE_OBJDIR)/cxxfs.cmd) $(TARGET_ARCH)
+
+$(JUCE_OBJDIR)/CellyzRender.o: ../../Tools/Render/CellyzRender.cpp
+	-$(V_AT)mkdir -p $(@D)
+	@echo "Compiling CellyzRender.cpp"
+	$(V_AT)$(CXX) $(JUCE_CXXFLAGS) -o "$@" -c "$<"
+
+$(JUCE_OBJDIR)/OfflineRenderer.o: ../../Tools/Render/OfflineRenderer.cpp
+	-$(V_AT)mkdir -p $(@D)
+	@echo "Compiling OfflineRenderer.cpp"
+	$(V_AT)$(CXX) $(JUCE_CXXFLAGS) -o "$@" -c "$<"
+
+$(JUCE_OBJDIR)/BatchRenderer.o: ../../Tools/Render/BatchRenderer.cpp
+	-$(V_AT)mkdir -p $(@D)
+	@echo "Compiling BatchRenderer.cpp"
+	$(V_AT)$(CXX) $(JUCE_CXXFLAGS) -o "$@" -c "$<"
+
+-include $(OBJECTS_BENCHMARK:%.o=%.d)
+-include $(OBJECTS_RENDER:%.o=%.d)
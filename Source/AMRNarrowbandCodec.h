@@ -0,0 +1,990 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    AMR narrowband speech codec (ACELP, 4.75 - 12.2 kbps): one encoder and one
+    decoder, so a call can be run through the codec and back, with the mode
+    chosen afresh for every frame the way link adaptation switches it.
+
+    The structure is that of 3GPP TS 26.090: high-pass preprocessing, 10th
+    order LPC analysis on an asymmetric window with LSP interpolation over
+    four 5ms subframes, open-loop pitch on the weighted speech, closed-loop
+    fractional pitch (1/3 or 1/6 sample), an algebraic codebook of signed
+    pulses on interleaved tracks with pitch sharpening, and the decoder's
+    adaptive postfilter. The eight modes differ where the real ones do - the
+    number of pulses and tracks, the pitch resolution and how finely the LSFs
+    and gains are quantised - so the bitrate steps are audible in the same
+    way.
+
+    It is a floating-point emulation, not the bit-exact reference: the split
+    matrix LSF and gain vector quantisers are replaced by scalar quantisers
+    with step sizes chosen to give each mode a comparable coarseness, and the
+    coded parameters are passed from encoder to decoder as a struct rather
+    than packed into bits. The correlation, filtering and codebook searches
+    are straight loops over contiguous arrays (dot products are summed in
+    eight lanes) so the compiler vectorises them.
+
+    Frames are 160 samples at 8kHz, as floats in the usual -1 to 1 range.
+*/
+class AMRNarrowbandCodec
+{
+public:
+    static constexpr int frameSize = 160;
+    static constexpr int subframeSize = 40;
+    static constexpr int numSubframes = 4;
+    static constexpr int order = 10;
+    static constexpr int maxPulses = 10;
+
+    enum Mode
+    {
+        mr475 = 0,
+        mr515,
+        mr59,
+        mr67,
+        mr74,
+        mr795,
+        mr102,
+        mr122,
+        numModes
+    };
+
+    static float getBitrate (Mode mode) noexcept      { return getSettings (mode).bitrate; }
+
+    // The coded parameters of one frame
+    struct Subframe
+    {
+        int lag = 40;                   // Integer pitch lag
+        int fraction = 0;               // Fractional part of the lag, in sixths (-5 to 5)
+        float pitchGain = 0.0f;
+        float codeGain = 0.0f;
+        int numPulses = 0;
+        int positions[maxPulses] = {};
+        float signs[maxPulses] = {};
+    };
+
+    struct Frame
+    {
+        Mode mode = mr122;
+        float lsp[order] = {};          // Quantised line spectral pairs (cosine domain)
+        Subframe subframes[numSubframes];
+    };
+
+    AMRNarrowbandCodec()
+    {
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        encoder = EncoderState();
+        decoder = DecoderState();
+
+        for (int i = 0; i < order; ++i)
+            encoder.lsp[i] = encoder.quantisedLsp[i] = decoder.quantisedLsp[i]
+                = std::cos (juce::MathConstants<float>::pi * (float) (i + 1) / (float) (order + 1));
+    }
+
+    //==============================================================================
+    void encode (const float* input, Mode mode, Frame& frame) noexcept
+    {
+        const auto& settings = getSettings (mode);
+        frame.mode = mode;
+
+        auto* speech = encoder.speech + historyLength;
+        preprocess (input, speech);
+
+        // LPC analysis and LSP quantisation, then the filters for each subframe
+        float a[order + 1], lsp[order];
+        lpcAnalysis (encoder.speech, a);
+        lpcToLsp (a, lsp, encoder.lsp);
+        quantiseLsp (lsp, frame.lsp, settings.lspStep);
+
+        float Aw[numSubframes][order + 1], Aq[numSubframes][order + 1];
+
+        for (int k = 0; k < numSubframes; ++k)
+        {
+            interpolateLsp (encoder.lsp, lsp, k, Aw[k]);
+            interpolateLsp (encoder.quantisedLsp, frame.lsp, k, Aq[k]);
+        }
+
+        // Weighted speech and the open-loop pitch of each half frame
+        const float gamma1 = mode == mr122 ? 0.94f : 0.9f;
+        auto* weightedSpeech = encoder.weightedSpeech + maxLag;
+
+        for (int k = 0; k < numSubframes; ++k)
+            weightSpeech (Aw[k], gamma1, speech + k * subframeSize, weightedSpeech + k * subframeSize);
+
+        const int openLoopLags[2] = { openLoopPitch (weightedSpeech), openLoopPitch (weightedSpeech + frameSize / 2) };
+
+        auto* excitation = encoder.excitation + excitationHistory;
+
+        for (int k = 0; k < numSubframes; ++k)
+        {
+            auto& subframe = frame.subframes[k];
+            auto* exc = excitation + k * subframeSize;
+            const auto* s = speech + k * subframeSize;
+
+            float Ap1[order + 1], Ap2[order + 1];
+            weight (Aw[k], gamma1, Ap1);
+            weight (Aw[k], gamma2, Ap2);
+
+            // Impulse response of the weighted synthesis filter
+            float h1[subframeSize] = {};
+            std::copy (Ap1, Ap1 + order + 1, h1);
+            synthesise (Aq[k], h1, h1, subframeSize, nullptr);
+            synthesise (Ap2, h1, h1, subframeSize, nullptr);
+
+            // Target: the weighted error left once the previous subframes' ringing is removed
+            float residualSignal[subframeSize], error[order + subframeSize], target[subframeSize];
+            residual (Aq[k], s, residualSignal, subframeSize);
+            std::copy (encoder.errorMemory, encoder.errorMemory + order, error);
+            synthesise (Aq[k], residualSignal, error + order, subframeSize, encoder.errorMemory);
+            residual (Ap1, error + order, target, subframeSize);
+            synthesise (Ap2, target, target, subframeSize, encoder.weightingMemory);
+
+            // Adaptive codebook
+            float y1[subframeSize];
+            const int centreLag = (k & 1) == 0 ? openLoopLags[k / 2] : encoder.previousLag;
+            const int lowestLag = (k & 1) == 0 ? centreLag - 3 : centreLag - 5;
+            const int highestLag = (k & 1) == 0 ? centreLag + 3 : centreLag + 4;
+
+            searchPitch (exc, h1, target, juce::jlimit (minLag, maxLag, lowestLag), juce::jlimit (minLag, maxLag, highestLag),
+                         settings.pitchResolution, subframe.lag, subframe.fraction);
+            predictLongTerm (exc, subframe.lag, subframe.fraction);
+            convolve (exc, h1, y1);
+
+            const float y1Energy = dotProduct (y1, y1, subframeSize);
+            const float pitchGain = y1Energy > 0.0f ? dotProduct (target, y1, subframeSize) / y1Energy : 0.0f;
+            subframe.pitchGain = quantiseUniform (juce::jlimit (0.0f, maxPitchGain, pitchGain), maxPitchGain, settings.pitchGainLevels);
+
+            // Algebraic codebook, searched through the pitch-sharpened response
+            float codebookTarget[subframeSize], h2[subframeSize];
+
+            for (int i = 0; i < subframeSize; ++i)
+                codebookTarget[i] = target[i] - subframe.pitchGain * y1[i];
+
+            std::copy (h1, h1 + subframeSize, h2);
+            sharpen (h2, subframe.lag, encoder.sharpening);
+            searchCodebook (codebookTarget, h2, settings, k, subframe);
+
+            float code[subframeSize], y2[subframeSize];
+            buildCodeVector (subframe, subframe.lag, encoder.sharpening, code);
+            convolve (code, h1, y2);
+
+            const float y2Energy = dotProduct (y2, y2, subframeSize);
+            const float codeGain = y2Energy > 0.0f ? dotProduct (codebookTarget, y2, subframeSize) / y2Energy : 0.0f;
+            subframe.codeGain = quantiseLogarithmic (codeGain, settings.codeGainStep);
+
+            // The local decoder, which keeps the filter memories in step with the real one
+            for (int i = 0; i < subframeSize; ++i)
+                exc[i] = subframe.pitchGain * exc[i] + subframe.codeGain * code[i];
+
+            float synthesis[subframeSize];
+            synthesise (Aq[k], exc, synthesis, subframeSize, encoder.synthesisMemory);
+
+            for (int i = 0; i < order; ++i)
+            {
+                const int n = subframeSize - order + i;
+                encoder.errorMemory[i] = s[n] - synthesis[n];
+                encoder.weightingMemory[i] = target[n] - subframe.pitchGain * y1[n] - subframe.codeGain * y2[n];
+            }
+
+            encoder.sharpening = juce::jmin (subframe.pitchGain, maxSharpening);
+            encoder.previousLag = subframe.lag;
+        }
+
+        std::copy (lsp, lsp + order, encoder.lsp);
+        std::copy (frame.lsp, frame.lsp + order, encoder.quantisedLsp);
+
+        std::memmove (encoder.speech, encoder.speech + frameSize, historyLength * sizeof (float));
+        std::memmove (encoder.weightedSpeech, encoder.weightedSpeech + frameSize, maxLag * sizeof (float));
+        std::memmove (encoder.excitation, encoder.excitation + frameSize, excitationHistory * sizeof (float));
+    }
+
+    void decode (const Frame& frame, float* output) noexcept
+    {
+        const bool highRate = frame.mode >= mr102;
+        auto* excitation = decoder.excitation + excitationHistory;
+
+        for (int k = 0; k < numSubframes; ++k)
+        {
+            const auto& subframe = frame.subframes[k];
+            auto* exc = excitation + k * subframeSize;
+
+            float Aq[order + 1];
+            interpolateLsp (decoder.quantisedLsp, frame.lsp, k, Aq);
+
+            float code[subframeSize];
+            predictLongTerm (exc, subframe.lag, subframe.fraction);
+            buildCodeVector (subframe, subframe.lag, decoder.sharpening, code);
+
+            for (int i = 0; i < subframeSize; ++i)
+                exc[i] = subframe.pitchGain * exc[i] + subframe.codeGain * code[i];
+
+            float* synthesis = decoder.synthesis + order;
+            synthesise (Aq, exc, synthesis, subframeSize, decoder.synthesisMemory);
+            postfilter (Aq, highRate ? 0.7f : 0.55f, highRate ? 0.75f : 0.7f, output + k * subframeSize);
+
+            std::copy (synthesis + subframeSize - order, synthesis + subframeSize, decoder.synthesis);
+            decoder.sharpening = juce::jmin (subframe.pitchGain, maxSharpening);
+        }
+
+        std::copy (frame.lsp, frame.lsp + order, decoder.quantisedLsp);
+        std::memmove (decoder.excitation, decoder.excitation + frameSize, excitationHistory * sizeof (float));
+    }
+
+    // Encodes and decodes one frame in place
+    void process (float* samples, Mode mode) noexcept
+    {
+        Frame frame;
+        encode (samples, mode, frame);
+        decode (frame, samples);
+    }
+
+private:
+    //==============================================================================
+    static constexpr int minLag = 20, maxLag = 143;
+    static constexpr int interpolationTaps = 4;                 // Each side of the fractional pitch interpolator
+    static constexpr int excitationHistory = maxLag + interpolationTaps + 1;
+    static constexpr int windowLength = 240;
+    static constexpr int historyLength = windowLength - frameSize;
+    static constexpr int gridPoints = 60;
+
+    static constexpr float gamma2 = 0.6f;
+    static constexpr float maxPitchGain = 1.2f;
+    static constexpr float maxSharpening = 0.8f;
+
+    // What sets the modes apart
+    struct ModeSettings
+    {
+        float bitrate;
+        float lspStep;              // LSF quantiser step, in radians
+        int pitchResolution;        // Fractional lag steps per sample
+        int numTracks;
+        int pulsesPerTrack;
+        int trackStride;            // Track t holds positions t, t + stride, ...
+        int pitchGainLevels;
+        float codeGainStep;         // In dB
+    };
+
+    static const ModeSettings& getSettings (Mode mode) noexcept
+    {
+        static const ModeSettings settings[numModes] =
+        {
+            { 4.75f, 0.034f, 3, 2, 1, 4,  8, 2.5f },
+            { 5.15f, 0.030f, 3, 2, 1, 4,  8, 2.5f },
+            { 5.90f, 0.026f, 3, 2, 1, 2, 16, 2.0f },
+            { 6.70f, 0.024f, 3, 3, 1, 3, 16, 2.0f },
+            { 7.40f, 0.022f, 3, 4, 1, 4, 16, 1.5f },
+            { 7.95f, 0.020f, 3, 4, 1, 4, 16, 1.2f },
+            { 10.2f, 0.018f, 3, 4, 2, 4, 32, 1.2f },
+            { 12.2f, 0.012f, 6, 5, 2, 5, 32, 1.0f }
+        };
+
+        return settings[juce::jlimit (0, numModes - 1, static_cast<int> (mode))];
+    }
+
+    struct EncoderState
+    {
+        float highPassInput[2] = {}, highPassOutput[2] = {};
+
+        float speech[historyLength + frameSize] = {};           // Preprocessed speech, with the window's history
+        float weightedSpeech[maxLag + frameSize] = {};
+        float weightedSpeechMemory[order] = {};
+        float excitation[excitationHistory + frameSize] = {};
+
+        float lsp[order] = {};                                  // Last frame's, unquantised and quantised
+        float quantisedLsp[order] = {};
+
+        float errorMemory[order] = {};                          // Speech minus local synthesis
+        float weightingMemory[order] = {};                      // Weighted error
+        float synthesisMemory[order] = {};
+
+        float sharpening = 0.0f;
+        int previousLag = 40;
+    };
+
+    struct DecoderState
+    {
+        float excitation[excitationHistory + frameSize] = {};
+        float quantisedLsp[order] = {};
+        float synthesisMemory[order] = {};
+
+        float synthesis[order + subframeSize] = {};             // This subframe, with the last one's tail
+        float postfilterMemory[order] = {};
+        float tiltMemory = 0.0f;
+        float agcGain = 1.0f;
+
+        float sharpening = 0.0f;
+    };
+
+    //==============================================================================
+    // Sums in eight lanes, so the loop vectorises without reordering a single sum
+    static float dotProduct (const float* a, const float* b, int numSamples) noexcept
+    {
+        constexpr int numLanes = 8;
+        float sums[numLanes] = {};
+        int i = 0;
+
+        for (; i + numLanes <= numSamples; i += numLanes)
+            for (int lane = 0; lane < numLanes; ++lane)
+                sums[lane] += a[i + lane] * b[i + lane];
+
+        float sum = 0.0f;
+
+        for (; i < numSamples; ++i)
+            sum += a[i] * b[i];
+
+        for (auto laneSum : sums)
+            sum += laneSum;
+
+        return sum;
+    }
+
+    // y = x filtered by the subframe-long impulse response h (zero initial state)
+    static void convolve (const float* x, const float* h, float* y) noexcept
+    {
+        std::fill (y, y + subframeSize, 0.0f);
+
+        for (int i = 0; i < subframeSize; ++i)
+        {
+            const float xi = x[i];
+
+            for (int n = i; n < subframeSize; ++n)
+                y[n] += xi * h[n - i];
+        }
+    }
+
+    // FIR A(z); x must have order samples of history before it
+    static void residual (const float* a, const float* x, float* y, int numSamples) noexcept
+    {
+        std::copy (x, x + numSamples, y);
+
+        for (int k = 1; k <= order; ++k)
+            for (int n = 0; n < numSamples; ++n)
+                y[n] += a[k] * x[n - k];
+    }
+
+    // IIR 1 / A(z). memory holds the last order outputs (oldest first) and is updated;
+    // without it the filter starts from rest. x and y may be the same array.
+    static void synthesise (const float* a, const float* x, float* y, int numSamples, float* memory) noexcept
+    {
+        float buffer[order + frameSize];
+        std::fill (buffer, buffer + order, 0.0f);
+
+        if (memory != nullptr)
+            std::copy (memory, memory + order, buffer);
+
+        for (int n = 0; n < numSamples; ++n)
+        {
+            float sum = x[n];
+
+            for (int k = 1; k <= order; ++k)
+                sum -= a[k] * buffer[order + n - k];
+
+            buffer[order + n] = sum;
+        }
+
+        std::copy (buffer + order, buffer + order + numSamples, y);
+
+        if (memory != nullptr)
+            std::copy (buffer + numSamples, buffer + numSamples + order, memory);
+    }
+
+    // A(z / gamma)
+    static void weight (const float* a, float gamma, float* weighted) noexcept
+    {
+        float factor = 1.0f;
+
+        for (int k = 0; k <= order; ++k)
+        {
+            weighted[k] = a[k] * factor;
+            factor *= gamma;
+        }
+    }
+
+    static float quantiseUniform (float value, float range, int levels) noexcept
+    {
+        const float step = range / (float) (levels - 1);
+        return std::round (value / step) * step;
+    }
+
+    static float quantiseLogarithmic (float value, float stepInDecibels) noexcept
+    {
+        if (value <= 1.0e-6f)
+            return 0.0f;
+
+        const float decibels = std::round (20.0f * std::log10 (value) / stepInDecibels) * stepInDecibels;
+        return std::pow (10.0f, decibels / 20.0f);
+    }
+
+    //==============================================================================
+    // The 80Hz high-pass of the preprocessing (without its halving)
+    void preprocess (const float* input, float* output) noexcept
+    {
+        constexpr float b0 = 0.927246f, b1 = -1.854492f, b2 = 0.927246f;
+        constexpr float a1 = 1.906006f, a2 = -0.911377f;
+
+        auto& x = encoder.highPassInput;
+        auto& y = encoder.highPassOutput;
+
+        for (int n = 0; n < frameSize; ++n)
+        {
+            const float out = b0 * input[n] + b1 * x[0] + b2 * x[1] + a1 * y[0] + a2 * y[1];
+
+            x[1] = x[0];
+            x[0] = input[n];
+            y[1] = y[0];
+            y[0] = out;
+            output[n] = out;
+        }
+    }
+
+    // Autocorrelation on the asymmetric window, lag windowing and Levinson-Durbin
+    static void lpcAnalysis (const float* speech, float* a) noexcept
+    {
+        static const auto tables = []
+        {
+            struct { float window[windowLength]; float lagWindow[order + 1]; } t;
+
+            for (int n = 0; n < windowLength; ++n)
+                t.window[n] = n < 200 ? 0.54f - 0.46f * std::cos (juce::MathConstants<float>::pi * (float) n / 199.0f)
+                                      : std::cos (juce::MathConstants<float>::twoPi * (float) (n - 200) / 159.0f);
+
+            // 60Hz of bandwidth expansion, and a 40dB noise floor on r[0]
+            for (int k = 0; k <= order; ++k)
+            {
+                const float x = juce::MathConstants<float>::twoPi * 60.0f * (float) k / 8000.0f;
+                t.lagWindow[k] = std::exp (-0.5f * x * x);
+            }
+
+            t.lagWindow[0] = 1.0001f;
+            return t;
+        }();
+
+        float windowed[windowLength];
+
+        for (int n = 0; n < windowLength; ++n)
+            windowed[n] = speech[n] * tables.window[n];
+
+        float r[order + 1];
+
+        for (int k = 0; k <= order; ++k)
+            r[k] = dotProduct (windowed, windowed + k, windowLength - k) * tables.lagWindow[k];
+
+        std::fill (a, a + order + 1, 0.0f);
+        a[0] = 1.0f;
+
+        if (r[0] < 1.0e-9f)
+            return;
+
+        float error = r[0];
+
+        for (int i = 1; i <= order; ++i)
+        {
+            float sum = r[i];
+
+            for (int j = 1; j < i; ++j)
+                sum += a[j] * r[i - j];
+
+            const float reflection = -sum / error;
+            float previous[order + 1];
+            std::copy (a, a + order + 1, previous);
+
+            for (int j = 1; j < i; ++j)
+                a[j] = previous[j] + reflection * previous[i - j];
+
+            a[i] = reflection;
+            error *= 1.0f - reflection * reflection;
+
+            if (error <= 0.0f)
+            {
+                std::fill (a + 1, a + order + 1, 0.0f);
+                return;
+            }
+        }
+    }
+
+    //==============================================================================
+    // Chebyshev evaluation of a sum or difference polynomial at x = cos (w)
+    static float chebyshev (float x, const float* f) noexcept
+    {
+        const float x2 = 2.0f * x;
+        float b2 = 1.0f, b1 = x2 + f[1];
+
+        for (int i = 2; i < order / 2; ++i)
+        {
+            const float b0 = x2 * b1 - b2 + f[i];
+            b2 = b1;
+            b1 = b0;
+        }
+
+        return x * b1 - b2 + 0.5f * f[order / 2];
+    }
+
+    // Roots of the sum and difference polynomials, which interlace; if any are missed
+    // (very sharp resonances) the last frame's are kept
+    static void lpcToLsp (const float* a, float* lsp, const float* previousLsp) noexcept
+    {
+        static const auto grid = []
+        {
+            std::array<float, gridPoints + 1> g;
+
+            for (int j = 0; j <= gridPoints; ++j)
+                g[(size_t) j] = std::cos (juce::MathConstants<float>::pi * (float) j / (float) gridPoints);
+
+            return g;
+        }();
+
+        float f1[order / 2 + 1], f2[order / 2 + 1];
+        f1[0] = f2[0] = 1.0f;
+
+        for (int i = 0; i < order / 2; ++i)
+        {
+            f1[i + 1] = a[i + 1] + a[order - i] - f1[i];
+            f2[i + 1] = a[i + 1] - a[order - i] + f2[i];
+        }
+
+        const float* coefficients = f1;
+        int numFound = 0;
+        float xLow = grid[0], yLow = chebyshev (xLow, coefficients);
+
+        for (int j = 1; numFound < order && j <= gridPoints; ++j)
+        {
+            float xHigh = xLow, yHigh = yLow;
+            xLow = grid[(size_t) j];
+            yLow = chebyshev (xLow, coefficients);
+
+            if (yLow * yHigh > 0.0f)
+                continue;
+
+            for (int i = 0; i < 4; ++i)
+            {
+                const float xMid = 0.5f * (xLow + xHigh);
+                const float yMid = chebyshev (xMid, coefficients);
+
+                if (yLow * yMid <= 0.0f)
+                {
+                    yHigh = yMid;
+                    xHigh = xMid;
+                }
+                else
+                {
+                    yLow = yMid;
+                    xLow = xMid;
+                }
+            }
+
+            const float difference = yHigh - yLow;
+            const float root = difference == 0.0f ? xLow : xLow - yLow * (xHigh - xLow) / difference;
+
+            lsp[numFound++] = root;
+            coefficients = (numFound & 1) != 0 ? f2 : f1;
+
+            xLow = root;
+            yLow = chebyshev (xLow, coefficients);
+            --j;    // Search on from the root just found, on the same grid step
+        }
+
+        if (numFound < order)
+            std::copy (previousLsp, previousLsp + order, lsp);
+    }
+
+    static void lspPolynomial (const float* lsp, float* f) noexcept
+    {
+        f[0] = 1.0f;
+        f[1] = -2.0f * lsp[0];
+
+        for (int i = 2; i <= order / 2; ++i)
+        {
+            const float b = -2.0f * lsp[2 * i - 2];
+            f[i] = b * f[i - 1] + 2.0f * f[i - 2];
+
+            for (int j = i - 1; j >= 2; --j)
+                f[j] += b * f[j - 1] + f[j - 2];
+
+            f[1] += b;
+        }
+    }
+
+    static void lspToLpc (const float* lsp, float* a) noexcept
+    {
+        float f1[order / 2 + 1], f2[order / 2 + 1];
+        lspPolynomial (lsp, f1);
+        lspPolynomial (lsp + 1, f2);
+
+        for (int i = order / 2; i > 0; --i)
+        {
+            f1[i] += f1[i - 1];
+            f2[i] -= f2[i - 1];
+        }
+
+        a[0] = 1.0f;
+
+        for (int i = 1; i <= order / 2; ++i)
+        {
+            a[i] = 0.5f * (f1[i] + f2[i]);
+            a[order + 1 - i] = 0.5f * (f1[i] - f2[i]);
+        }
+    }
+
+    // Rounds the line spectral frequencies to the mode's step, keeping them ordered
+    // at least 50Hz apart so the synthesis filter stays stable
+    static void quantiseLsp (const float* lsp, float* quantised, float step) noexcept
+    {
+        constexpr float minimumGap = 0.0393f;
+        float previous = 0.0f;
+
+        for (int i = 0; i < order; ++i)
+        {
+            const float frequency = std::acos (juce::jlimit (-1.0f, 1.0f, lsp[i]));
+            const float rounded = juce::jmax (previous + minimumGap, std::round (frequency / step) * step);
+
+            quantised[i] = juce::jmin (rounded, juce::MathConstants<float>::pi - minimumGap * (float) (order - i));
+            previous = quantised[i];
+        }
+
+        for (int i = 0; i < order; ++i)
+            quantised[i] = std::cos (quantised[i]);
+    }
+
+    // The filter for subframe k, a quarter of the way further from last frame's LSPs each time
+    static void interpolateLsp (const float* previous, const float* current, int k, float* a) noexcept
+    {
+        const float amount = (float) (k + 1) / (float) numSubframes;
+        float lsp[order];
+
+        for (int i = 0; i < order; ++i)
+            lsp[i] = previous[i] + amount * (current[i] - previous[i]);
+
+        lspToLpc (lsp, a);
+    }
+
+    //==============================================================================
+    // A(z / gamma1) / A(z / 0.6) over one subframe of speech
+    void weightSpeech (const float* a, float gamma1, const float* speech, float* weighted) noexcept
+    {
+        float Ap1[order + 1], Ap2[order + 1];
+        weight (a, gamma1, Ap1);
+        weight (a, gamma2, Ap2);
+
+        residual (Ap1, speech, weighted, subframeSize);
+        synthesise (Ap2, weighted, weighted, subframeSize, encoder.weightedSpeechMemory);
+    }
+
+    // Best normalised correlation in each of three lag ranges, favouring the shorter
+    // lags so a pitch multiple isn't taken for the pitch
+    static int openLoopPitch (const float* weighted) noexcept
+    {
+        constexpr int length = frameSize / 2;
+        constexpr int ranges[4] = { minLag, 40, 80, maxLag + 1 };
+
+        int bestLags[3];
+        float bestScores[3];
+
+        for (int range = 0; range < 3; ++range)
+        {
+            bestLags[range] = ranges[range];
+            bestScores[range] = -1.0f;
+
+            for (int lag = ranges[range]; lag < ranges[range + 1]; ++lag)
+            {
+                const float correlation = dotProduct (weighted, weighted - lag, length);
+                const float energy = dotProduct (weighted - lag, weighted - lag, length);
+                const float score = energy > 0.0f ? correlation / std::sqrt (energy) : 0.0f;
+
+                if (score > bestScores[range])
+                {
+                    bestScores[range] = score;
+                    bestLags[range] = lag;
+                }
+            }
+        }
+
+        int lag = bestLags[2];
+        float score = bestScores[2];
+
+        for (int range = 1; range >= 0; --range)
+        {
+            if (bestScores[range] >= 0.85f * score)
+            {
+                lag = bestLags[range];
+                score = bestScores[range];
+            }
+        }
+
+        return lag;
+    }
+
+    //==============================================================================
+    // Windowed sinc interpolation taps, in sixths of a sample
+    static const float* getInterpolationFilter (int sixths) noexcept
+    {
+        static const auto filters = []
+        {
+            std::array<std::array<float, 2 * interpolationTaps>, 6> f;
+
+            for (int k = 0; k < 6; ++k)
+            {
+                float sum = 0.0f;
+
+                for (int i = 0; i < 2 * interpolationTaps; ++i)
+                {
+                    const float t = (float) k / 6.0f - (float) (i - interpolationTaps + 1);
+                    const float x = juce::MathConstants<float>::pi * t;
+                    const float sinc = std::abs (t) < 1.0e-6f ? 1.0f : std::sin (x) / x;
+                    const float window = 0.54f + 0.46f * std::cos (x / ((float) interpolationTaps + 0.5f));
+
+                    f[(size_t) k][(size_t) i] = sinc * window;
+                    sum += sinc * window;
+                }
+
+                for (auto& tap : f[(size_t) k])
+                    tap /= sum;
+            }
+
+            return f;
+        }();
+
+        return filters[(size_t) sixths].data();
+    }
+
+    // The adaptive codebook vector for a lag of lag + fraction / 6, written over the subframe
+    // at exc. Lags under a subframe repeat the samples just written.
+    static void predictLongTerm (float* exc, int lag, int fraction) noexcept
+    {
+        const int totalSixths = lag * 6 + fraction;
+        const int integerLag = (totalSixths + 5) / 6;
+        const float* filter = getInterpolationFilter (integerLag * 6 - totalSixths);
+
+        for (int n = 0; n < subframeSize; ++n)
+        {
+            const float* x = exc + n - integerLag - interpolationTaps + 1;
+            float sum = 0.0f;
+
+            for (int i = 0; i < 2 * interpolationTaps; ++i)
+                sum += x[i] * filter[i];
+
+            exc[n] = sum;
+        }
+    }
+
+    // Closed-loop pitch: the lag whose filtered past excitation best matches the target,
+    // first in whole samples and then to the mode's fractional resolution
+    static void searchPitch (float* exc, const float* h, const float* target, int lowestLag, int highestLag,
+                             int resolution, int& bestLag, int& bestFraction) noexcept
+    {
+        float filtered[subframeSize];
+        float bestScore = -std::numeric_limits<float>::max();
+
+        auto tryLag = [&] (int lag, int fraction)
+        {
+            predictLongTerm (exc, lag, fraction);
+            convolve (exc, h, filtered);
+
+            const float energy = dotProduct (filtered, filtered, subframeSize);
+            const float score = energy > 0.0f ? dotProduct (target, filtered, subframeSize) / std::sqrt (energy) : 0.0f;
+
+            if (score > bestScore)
+            {
+                bestScore = score;
+                bestLag = lag;
+                bestFraction = fraction;
+            }
+        };
+
+        bestLag = lowestLag;
+        bestFraction = 0;
+
+        for (int lag = lowestLag; lag <= highestLag; ++lag)
+            tryLag (lag, 0);
+
+        const int step = 6 / resolution;
+        const int integerLag = bestLag;
+
+        for (int fraction = step - 6; fraction < 6; fraction += step)
+        {
+            const int totalSixths = integerLag * 6 + fraction;
+
+            if (fraction != 0 && totalSixths >= minLag * 6 && totalSixths <= maxLag * 6)
+                tryLag (integerLag, fraction);
+        }
+    }
+
+    // Comb filtering by the pitch lag, for lags shorter than a subframe
+    static void sharpen (float* x, int lag, float sharpening) noexcept
+    {
+        for (int n = lag; n < subframeSize; ++n)
+            x[n] += sharpening * x[n - lag];
+    }
+
+    static void buildCodeVector (const Subframe& subframe, int lag, float sharpening, float* code) noexcept
+    {
+        std::fill (code, code + subframeSize, 0.0f);
+
+        for (int i = 0; i < subframe.numPulses; ++i)
+            code[subframe.positions[i]] += subframe.signs[i];
+
+        sharpen (code, lag, sharpening);
+    }
+
+    //==============================================================================
+    // Algebraic codebook search. Signs are fixed up front by the backward-filtered
+    // target; pulses are then placed track by track to maximise (d.c)^2 / (c'Phi c),
+    // and every pulse is placed again once with the others in place. The criterion
+    // for all 40 positions is updated as whole rows, so the search is a few vector
+    // passes rather than nested loops.
+    void searchCodebook (const float* target, const float* h, const ModeSettings& settings, int subframeIndex, Subframe& subframe) noexcept
+    {
+        float d[subframeSize], sign[subframeSize];
+
+        for (int n = 0; n < subframeSize; ++n)
+        {
+            d[n] = dotProduct (target + n, h, subframeSize - n);
+            sign[n] = d[n] < 0.0f ? -1.0f : 1.0f;
+            d[n] = std::abs (d[n]);
+        }
+
+        // Phi(i, j) = sum over k of h[k - i] h[k - j], with the signs folded in
+        auto& phi = codebookCorrelations;
+
+        for (int offset = 0; offset < subframeSize; ++offset)
+        {
+            float sum = 0.0f;
+
+            for (int i = subframeSize - 1 - offset; i >= 0; --i)
+            {
+                sum += h[subframeSize - 1 - i] * h[subframeSize - 1 - i - offset];
+                phi[i][i + offset] = phi[i + offset][i] = sum * sign[i] * sign[i + offset];
+            }
+        }
+
+        const int numPulses = settings.numTracks * settings.pulsesPerTrack;
+        const int trackShift = (subframeIndex & 1) != 0 ? settings.trackStride - settings.numTracks : 0;
+
+        float rowSum[subframeSize] = {};
+        float correlation = 0.0f, energy = 0.0f;
+        int positions[maxPulses];
+
+        auto place = [&] (int pulse, int position)
+        {
+            correlation += d[position];
+            energy += phi[position][position] + 2.0f * rowSum[position];
+
+            for (int n = 0; n < subframeSize; ++n)
+                rowSum[n] += phi[position][n];
+
+            positions[pulse] = position;
+        };
+
+        auto remove = [&] (int pulse)
+        {
+            const int position = positions[pulse];
+
+            for (int n = 0; n < subframeSize; ++n)
+                rowSum[n] -= phi[position][n];
+
+            correlation -= d[position];
+            energy -= phi[position][position] + 2.0f * rowSum[position];
+        };
+
+        auto choose = [&] (int pulse)
+        {
+            const int track = pulse % settings.numTracks;
+            float numerator[subframeSize], denominator[subframeSize];
+
+            for (int n = 0; n < subframeSize; ++n)
+            {
+                const float c = correlation + d[n];
+                numerator[n] = c * c;
+                denominator[n] = energy + phi[n][n] + 2.0f * rowSum[n];
+            }
+
+            int best = -1;
+            float bestNumerator = 0.0f, bestDenominator = 1.0f;
+
+            for (int n = track + trackShift; n < subframeSize; n += settings.trackStride)
+            {
+                if (best < 0 || numerator[n] * bestDenominator > bestNumerator * denominator[n])
+                {
+                    best = n;
+                    bestNumerator = numerator[n];
+                    bestDenominator = denominator[n];
+                }
+            }
+
+            return best;
+        };
+
+        for (int pulse = 0; pulse < numPulses; ++pulse)
+            place (pulse, choose (pulse));
+
+        for (int pulse = 0; pulse < numPulses; ++pulse)
+        {
+            remove (pulse);
+            place (pulse, choose (pulse));
+        }
+
+        subframe.numPulses = numPulses;
+
+        for (int pulse = 0; pulse < numPulses; ++pulse)
+        {
+            subframe.positions[pulse] = positions[pulse];
+            subframe.signs[pulse] = sign[positions[pulse]];
+        }
+    }
+
+    //==============================================================================
+    // Formant postfilter A(z / numerator) / A(z / denominator), tilt compensation and
+    // gain control back to the level of the synthesis
+    void postfilter (const float* Aq, float numeratorGamma, float denominatorGamma, float* output) noexcept
+    {
+        const float* synthesis = decoder.synthesis + order;
+
+        float Ap3[order + 1], Ap4[order + 1];
+        weight (Aq, numeratorGamma, Ap3);
+        weight (Aq, denominatorGamma, Ap4);
+
+        // Tilt of the formant filter, from its truncated impulse response
+        constexpr int responseLength = 22;
+        float response[responseLength] = {};
+        std::copy (Ap3, Ap3 + order + 1, response);
+        synthesise (Ap4, response, response, responseLength, nullptr);
+
+        const float energy = dotProduct (response, response, responseLength);
+        const float firstCorrelation = dotProduct (response, response + 1, responseLength - 1);
+        const float tilt = firstCorrelation > 0.0f && energy > 0.0f ? 0.8f * firstCorrelation / energy : 0.0f;
+
+        float filtered[subframeSize];
+        residual (Ap3, synthesis, filtered, subframeSize);
+        synthesise (Ap4, filtered, filtered, subframeSize, decoder.postfilterMemory);
+
+        for (int n = 0; n < subframeSize; ++n)
+        {
+            const float previous = decoder.tiltMemory;
+            decoder.tiltMemory = filtered[n];
+            filtered[n] -= tilt * previous;
+        }
+
+        const float inputEnergy = dotProduct (synthesis, synthesis, subframeSize);
+        const float outputEnergy = dotProduct (filtered, filtered, subframeSize);
+        constexpr float agcFactor = 0.9f;
+        const float targetGain = outputEnergy > 0.0f ? (1.0f - agcFactor) * std::sqrt (inputEnergy / outputEnergy) : 0.0f;
+
+        for (int n = 0; n < subframeSize; ++n)
+        {
+            decoder.agcGain = decoder.agcGain * agcFactor + targetGain;
+            output[n] = filtered[n] * decoder.agcGain;
+        }
+    }
+
+    //==============================================================================
+    EncoderState encoder;
+    DecoderState decoder;
+
+    float codebookCorrelations[subframeSize][subframeSize];
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AMRNarrowbandCodec)
+};
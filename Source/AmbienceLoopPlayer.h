@@ -0,0 +1,311 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "PolyphaseResampler.h"
+#include "SharedAssetCache.h"
+
+//==============================================================================
+/**
+    Plays a long recorded ambience loop (café, car, tube...) for the
+    processor, streamed so no instance ever holds a loop in memory.
+
+    Loops are WAV or AIFF files in getLoopFolder(), named after the ambience
+    (getLoopFileName()). Each file is memory-mapped rather than loaded, and
+    the mapping is shared through SharedAssetCache, so however many
+    instances play the same loop, the file is opened and mapped once and
+    the operating system keeps one copy of it. A background thread shared by every
+    player in the process reads ahead from the mapping, mixes it to mono
+    (the phone's microphone is mono), resamples it to the output rate and
+    pushes it into each player's lock-free ring (juce::AbstractFifo). The
+    audio thread only ever reads from that ring, so it never touches the
+    disk, waits or allocates - if the reader ever falls behind, the gap
+    plays as silence. Offline renders can ask read() to wait instead.
+
+    Loops are expected to be cut to loop seamlessly. Every player starts at
+    its own point in the loop (setStartPosition()), so instances playing
+    the same ambience don't play it in unison.
+
+    prepare() sizes everything; read() never allocates.
+*/
+class AmbienceLoopPlayer  : private juce::TimeSliceClient
+{
+public:
+    static constexpr int numLoops = 8;      // Loop 0 is silence and has no file
+
+    AmbienceLoopPlayer() = default;
+
+    ~AmbienceLoopPlayer() override
+    {
+        readerThread->removeTimeSliceClient (this);
+    }
+
+    //==============================================================================
+    // Where the loop files are installed
+    static juce::File getLoopFolder()
+    {
+       #if JUCE_MAC
+        return juce::File::getSpecialLocation (juce::File::userApplicationDataDirectory).getChildFile ("Application Support/Cellyz/Ambience");
+       #else
+        return juce::File::getSpecialLocation (juce::File::userApplicationDataDirectory).getChildFile ("Cellyz/Ambience");
+       #endif
+    }
+
+    // File name of a loop, without its extension (.wav, .aif or .aiff)
+    static juce::String getLoopFileName (int loop)
+    {
+        static const char* const names[numLoops] = { "", "Cafe", "Car", "Street", "Tube", "Office", "Train", "Airport" };
+        return juce::isPositiveAndBelow (loop, numLoops) ? names[loop] : "";
+    }
+
+    //==============================================================================
+    void prepare (double newOutputRate, int maximumBlockSize)
+    {
+        // Stops the reader (waiting for a slice in progress) while its buffers change
+        readerThread->removeTimeSliceClient (this);
+
+        outputRate = newOutputRate;
+
+        const int ringLength = juce::roundToInt (outputRate * ringSeconds) + 2 * juce::jmax (1, maximumBlockSize);
+        ring.setSize (1, ringLength);
+        fifo.setTotalSize (ringLength);
+
+        reset();
+        readerThread->addTimeSliceClient (this);
+    }
+
+    void release()
+    {
+        readerThread->removeTimeSliceClient (this);
+        reader.reset();
+        loadedLoop = 0;
+    }
+
+    // Position (0 - 1) in each loop that this player starts from. Takes effect from the next loop selected.
+    void setStartPosition (float newStartPosition) noexcept     { startPosition.store (juce::jlimit (0.0f, 1.0f, newStartPosition)); }
+
+    //==============================================================================
+    // Audio thread: picks the loop to play (0 for none)
+    void selectLoop (int loop) noexcept
+    {
+        loop = juce::jlimit (0, numLoops - 1, loop);
+
+        if (loop == selectedLoop)
+            return;
+
+        selectedLoop = loop;
+        switching = true;
+        requestedLoop.store (loop, std::memory_order_release);
+    }
+
+    // Audio thread: fills destination with the next numSamples of the selected loop. Returns false
+    // if the loop has no recording installed (destination is left alone), true otherwise - with
+    // silence wherever the reader hasn't caught up yet. waitForData is for offline rendering only.
+    bool read (float* destination, int numSamples, bool waitForData) noexcept
+    {
+        if (waitForData)
+            waitForReader (numSamples);
+
+        if (switching)
+        {
+            // Whatever is left in the ring belongs to the previous loop
+            fifo.finishedRead (fifo.getNumReady());
+
+            if (streamingLoop.load (std::memory_order_acquire) == selectedLoop)
+            {
+                switching = false;
+                fadeInPosition = 0;
+            }
+        }
+
+        if (! switching && loopMissing.load (std::memory_order_relaxed))
+            return false;
+
+        juce::FloatVectorOperations::clear (destination, numSamples);
+
+        if (switching || selectedLoop == 0)
+            return true;
+
+        int start1, size1, start2, size2;
+        fifo.prepareToRead (numSamples, start1, size1, start2, size2);
+        juce::FloatVectorOperations::copy (destination, ring.getReadPointer (0, start1), size1);
+        juce::FloatVectorOperations::copy (destination + size1, ring.getReadPointer (0, start2), size2);
+        fifo.finishedRead (size1 + size2);
+
+        // A newly selected loop fades in rather than starting mid-sound
+        const int fadeLength = juce::roundToInt (outputRate * fadeSeconds);
+
+        for (int i = 0; i < numSamples && fadeInPosition < fadeLength; ++i)
+            destination[i] *= (float) fadeInPosition++ / (float) fadeLength;
+
+        return true;
+    }
+
+private:
+    //==============================================================================
+    static constexpr double ringSeconds = 1.0;      // Read-ahead, should the reader thread be starved
+    static constexpr double fadeSeconds = 0.05;
+    static constexpr int sourceBlockSize = 4096;    // Loop samples read per step
+
+    // One reader thread for every player in the process
+    struct ReaderThread  : public juce::TimeSliceThread
+    {
+        ReaderThread()  : juce::TimeSliceThread ("Cellyz ambience reader")   { startThread (juce::Thread::Priority::low); }
+        ~ReaderThread() override                                            { stopThread (2000); }
+    };
+
+    //==============================================================================
+    void reset() noexcept
+    {
+        fifo.reset();
+        ring.clear();
+
+        reader.reset();
+        loadedLoop = 0;
+        selectedLoop = 0;
+        switching = false;
+        fadeInPosition = 0;
+
+        requestedLoop.store (0);
+        streamingLoop.store (0);
+        loopMissing.store (false);
+    }
+
+    // Reader thread: follows the selected loop and keeps the ring topped up
+    int useTimeSlice() override
+    {
+        const int loop = requestedLoop.load (std::memory_order_acquire);
+
+        if (loop != loadedLoop)
+        {
+            openLoop (loop);
+            loopMissing.store (loop != 0 && reader == nullptr, std::memory_order_relaxed);
+            streamingLoop.store (loop, std::memory_order_release);
+        }
+
+        if (reader == nullptr)
+            return 50;
+
+        while (fifo.getFreeSpace() >= resampler.getMaxOutputSamples (sourceBlockSize))
+            readBlock();
+
+        return 20;
+    }
+
+    void openLoop (int loop)
+    {
+        reader.reset();
+        loadedLoop = loop;
+
+        if (loop == 0)
+            return;
+
+        for (auto* extension : { ".wav", ".aif", ".aiff" })
+        {
+            const auto file = getLoopFolder().getChildFile (getLoopFileName (loop) + extension);
+
+            if (! file.existsAsFile())
+                continue;
+
+            reader = SharedAssetCache::acquire<juce::MemoryMappedAudioFormatReader> ("ambience:" + file.getFullPathName(), [&file]
+            {
+                juce::WavAudioFormat wavFormat;
+                juce::AiffAudioFormat aiffFormat;
+                juce::AudioFormat& format = file.hasFileExtension ("wav") ? static_cast<juce::AudioFormat&> (wavFormat) : aiffFormat;
+
+                std::unique_ptr<juce::MemoryMappedAudioFormatReader> mapped (format.createMemoryMappedReader (file));
+
+                if (mapped == nullptr || mapped->lengthInSamples <= 0 || ! mapped->mapEntireFile())
+                    return std::unique_ptr<juce::MemoryMappedAudioFormatReader>();
+
+                return mapped;
+            });
+
+            if (reader != nullptr)
+                break;
+        }
+
+        if (reader == nullptr)
+            return;
+
+        resampler.prepare (reader->sampleRate, outputRate);
+        frame.resize ((size_t) juce::jmax (1u, reader->numChannels));
+        mono.resize ((size_t) sourceBlockSize);
+        resampled.resize ((size_t) resampler.getMaxOutputSamples (sourceBlockSize));
+        readPosition = (juce::int64) (startPosition.load() * (float) (reader->lengthInSamples - 1));
+    }
+
+    // Reads, mixes down and resamples the next block of the loop into the ring. The reader is
+    // shared with other players, so it is only read through its const, stateless getSample().
+    void readBlock()
+    {
+        const int numSourceChannels = (int) juce::jmin ((size_t) 2, frame.size());
+        const float channelGain = 1.0f / (float) numSourceChannels;
+
+        for (auto& sample : mono)
+        {
+            reader->getSample (readPosition, frame.data());
+
+            sample = frame[0];
+
+            if (numSourceChannels > 1)
+                sample += frame[1];
+
+            sample *= channelGain;
+
+            if (++readPosition >= reader->lengthInSamples)
+                readPosition = 0;
+        }
+
+        const int numResampled = resampler.process (mono.data(), sourceBlockSize, resampled.data());
+
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite (numResampled, start1, size1, start2, size2);
+        juce::FloatVectorOperations::copy (ring.getWritePointer (0, start1), resampled.data(), size1);
+        juce::FloatVectorOperations::copy (ring.getWritePointer (0, start2), resampled.data() + size1, size2);
+        fifo.finishedWrite (size1 + size2);
+    }
+
+    // Offline only: lets the reader catch up before a block is read
+    void waitForReader (int numSamples) noexcept
+    {
+        for (int attempt = 0; attempt < 1000; ++attempt)
+        {
+            const bool switched = streamingLoop.load (std::memory_order_acquire) == selectedLoop;
+
+            if (switched && (selectedLoop == 0 || loopMissing.load() || fifo.getNumReady() >= numSamples))
+                return;
+
+            readerThread->moveToFrontOfQueue (this);
+            juce::Thread::sleep (1);
+        }
+    }
+
+    //==============================================================================
+    juce::SharedResourcePointer<ReaderThread> readerThread;
+    double outputRate = 8000.0;
+
+    // The ring: written by the reader thread, read by the audio thread
+    juce::AbstractFifo fifo { 1 };
+    juce::AudioBuffer<float> ring;
+
+    std::atomic<int> requestedLoop { 0 };       // Audio thread -> reader
+    std::atomic<int> streamingLoop { 0 };       // Reader -> audio thread: the loop the ring now fills with
+    std::atomic<bool> loopMissing { false };    // Reader -> audio thread: streamingLoop has no file
+    std::atomic<float> startPosition { 0.0f };
+
+    // Audio thread only
+    int selectedLoop = 0;
+    bool switching = false;
+    int fadeInPosition = 0;
+
+    // Reader thread only
+    SharedAssetCache::Handle<juce::MemoryMappedAudioFormatReader> reader;
+    int loadedLoop = 0;
+    juce::int64 readPosition = 0;
+    PolyphaseResampler resampler;
+    std::vector<float> frame;                   // One sample of every channel of the loop
+    std::vector<float> mono;
+    std::vector<float> resampled;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AmbienceLoopPlayer)
+};
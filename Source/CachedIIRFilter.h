@@ -0,0 +1,208 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Biquad low-cut/high-cut filter driven by a discrete choice parameter.
+
+    All coefficient sets for the available choices are designed once per sample
+    rate in prepare(), so the audio thread never does trig math or touches
+    ref-counted coefficient objects. When the choice changes the filter
+    crossfades from the old to the new response over a short ramp instead of
+    swapping coefficients mid-stream, which avoids zipper clicks.
+
+    A choice whose frequency is 0 means "Off" and is realised as an identity
+    biquad, so fading in and out of the filter is handled the same way.
+*/
+class CachedIIRFilter
+{
+public:
+    enum Type
+    {
+        highPass = 0,
+        lowPass = 1
+    };
+
+    static constexpr int numChoices = 5;
+
+    explicit CachedIIRFilter (Type filterType) : type (filterType) {}
+
+    //==============================================================================
+    // Called from prepareToPlay: designs every coefficient set and sizes the state
+    void prepare (double sampleRate, int numChannels, const std::array<float, numChoices>& choiceFrequencies)
+    {
+        const auto nyquistLimit = static_cast<float> (sampleRate * 0.49);
+
+        for (int i = 0; i < numChoices; ++i)
+        {
+            const float frequency = choiceFrequencies[(size_t) i];
+
+            if (frequency <= 0.0f)
+            {
+                table[(size_t) i] = {}; // Off: identity
+                continue;
+            }
+
+            auto designed = (type == highPass)
+                ? juce::dsp::IIR::Coefficients<float>::makeHighPass (sampleRate, juce::jmin (frequency, nyquistLimit))
+                : juce::dsp::IIR::Coefficients<float>::makeLowPass  (sampleRate, juce::jmin (frequency, nyquistLimit));
+
+            // Raw layout is normalised { b0, b1, b2, a1, a2 }
+            const auto* raw = designed->getRawCoefficients();
+            table[(size_t) i] = { raw[0], raw[1], raw[2], raw[3], raw[4] };
+        }
+
+        for (auto& slot : states)
+            slot.assign ((size_t) juce::jmax (1, numChannels), {});
+
+        fadeLengthSamples = juce::jmax (1, static_cast<int> (sampleRate * fadeTimeSeconds));
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        for (auto& slot : states)
+            std::fill (slot.begin(), slot.end(), State{});
+
+        activeIndex = requestedIndex;
+        fadeFromIndex = activeIndex;
+        fadePosition = fadeLengthSamples;
+    }
+
+    //==============================================================================
+    // Audio thread. A new choice is picked up once any running crossfade has finished.
+    void setChoice (int choiceIndex) noexcept
+    {
+        requestedIndex = juce::jlimit (0, numChoices - 1, choiceIndex);
+    }
+
+    void process (juce::AudioBuffer<float>& buffer, int numChannels) noexcept
+    {
+        const int numSamples = buffer.getNumSamples();
+        numChannels = juce::jmin (numChannels, buffer.getNumChannels(), static_cast<int> (states[0].size()));
+
+        if (! isFading())
+        {
+            const int requested = requestedIndex;
+
+            if (requested != activeIndex)
+                startFade (requested);
+        }
+
+        if (! isFading())
+        {
+            if (isIdentity (activeIndex))
+                return;
+
+            const auto& coeffs = table[(size_t) activeIndex];
+
+            for (int channel = 0; channel < numChannels; ++channel)
+                processSteady (coeffs, states[(size_t) activeSlot][(size_t) channel], buffer.getWritePointer (channel), numSamples);
+
+            return;
+        }
+
+        // Crossfade: run the outgoing and incoming responses side by side
+        const auto& fromCoeffs = table[(size_t) fadeFromIndex];
+        const auto& toCoeffs   = table[(size_t) activeIndex];
+        const float rampStep   = 1.0f / static_cast<float> (fadeLengthSamples);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto& fromState = states[(size_t) (1 - activeSlot)][(size_t) channel];
+            auto& toState   = states[(size_t) activeSlot][(size_t) channel];
+            auto* data = buffer.getWritePointer (channel);
+
+            float gain = static_cast<float> (fadePosition) * rampStep;
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const float input = data[i];
+                const float fromOutput = tick (fromCoeffs, fromState, input);
+                const float toOutput   = tick (toCoeffs, toState, input);
+
+                data[i] = fromOutput + (toOutput - fromOutput) * juce::jmin (1.0f, gain);
+                gain += rampStep;
+            }
+        }
+
+        fadePosition = juce::jmin (fadeLengthSamples, fadePosition + numSamples);
+    }
+
+    bool isFading() const noexcept { return fadePosition < fadeLengthSamples; }
+
+private:
+    //==============================================================================
+    struct Coefficients
+    {
+        float b0 = 1.0f, b1 = 0.0f, b2 = 0.0f, a1 = 0.0f, a2 = 0.0f;
+    };
+
+    struct State
+    {
+        float z1 = 0.0f, z2 = 0.0f;
+    };
+
+    // Transposed direct form II
+    static inline float tick (const Coefficients& c, State& s, float input) noexcept
+    {
+        const float output = c.b0 * input + s.z1;
+        s.z1 = c.b1 * input - c.a1 * output + s.z2;
+        s.z2 = c.b2 * input - c.a2 * output;
+        return output;
+    }
+
+    static void processSteady (const Coefficients& c, State& s, float* data, int numSamples) noexcept
+    {
+        // Keep the state in locals so the loop runs from registers
+        float z1 = s.z1, z2 = s.z2;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float input = data[i];
+            const float output = c.b0 * input + z1;
+            z1 = c.b1 * input - c.a1 * output + z2;
+            z2 = c.b2 * input - c.a2 * output;
+            data[i] = output;
+        }
+
+        s.z1 = z1;
+        s.z2 = z2;
+    }
+
+    bool isIdentity (int index) const noexcept
+    {
+        const auto& c = table[(size_t) index];
+        return c.b0 == 1.0f && c.b1 == 0.0f && c.b2 == 0.0f && c.a1 == 0.0f && c.a2 == 0.0f;
+    }
+
+    void startFade (int newIndex) noexcept
+    {
+        // The incoming filter starts from the outgoing filter's state, which keeps
+        // its start-up transient small; the ramp hides whatever is left.
+        const int newSlot = 1 - activeSlot;
+        std::copy (states[(size_t) activeSlot].begin(), states[(size_t) activeSlot].end(), states[(size_t) newSlot].begin());
+
+        fadeFromIndex = activeIndex;
+        activeIndex = newIndex;
+        activeSlot = newSlot;
+        fadePosition = 0;
+    }
+
+    //==============================================================================
+    static constexpr double fadeTimeSeconds = 0.02; // 20ms crossfade between settings
+
+    const Type type;
+    std::array<Coefficients, numChoices> table;
+    std::array<std::vector<State>, 2> states;      // [slot][channel]
+
+    int requestedIndex = 0;
+    int activeIndex = 0;
+    int fadeFromIndex = 0;
+    int activeSlot = 0;
+    int fadeLengthSamples = 1;
+    int fadePosition = 1;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CachedIIRFilter)
+};
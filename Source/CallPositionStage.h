@@ -0,0 +1,342 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Places the call in the stereo field: phone held to either ear, on
+    speakerphone near or far, or in a Bluetooth earpiece.
+
+    Each position is a 2x2 gain matrix taking the left and right inputs to
+    the left and right outputs. The matrix is chosen once per block and
+    applied on juce::dsp::SIMDRegister lanes. When the position changes the
+    matrix is ramped linearly from the old one to the new one, so a change
+    never clicks; like CachedIIRFilter, a change made during a ramp is
+    picked up once the ramp has finished.
+
+    Binaural mode renders the ear and Bluetooth positions through short FIR
+    filters instead: the call, mixed to mono, reaches the near ear directly
+    and the far ear around the head - delayed by the interaural time
+    difference (Woodworth's formula, for a source at the side) and dulled
+    by the head's shadow (Brown and Duda's spherical head model). Both
+    filters have unity gain at DC and are scaled by the position's near and
+    far ear gains. Moving into or out of a binaural position crossfades
+    between the two renderings over the same ramp.
+
+    prepare() designs the filters for the sample rate and sizes everything;
+    process() never allocates.
+*/
+class CallPositionStage
+{
+public:
+    static constexpr int numPositions = 7;      // As TestAudioProcessor::CallPosition
+
+    CallPositionStage() = default;
+
+    //==============================================================================
+    void prepare (double sampleRate, int maximumBlockSize)
+    {
+        maximumBlockSize = juce::jmax (1, maximumBlockSize);
+        rampLength = juce::jmax (1, juce::roundToInt (sampleRate * rampSeconds));
+
+        designEarFilters (sampleRate);
+
+        history.setSize (1, filterLength - 1 + maximumBlockSize);
+        scratch.setSize (3, maximumBlockSize);
+
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        history.clear();
+
+        current = previous = requested;
+        rampPosition = rampLength;
+    }
+
+    //==============================================================================
+    // Audio thread, once per block: the position to play (0 - numPositions - 1) and whether
+    // the ear and Bluetooth positions are rendered binaurally
+    void setPosition (int position, bool binaural) noexcept
+    {
+        requested = { juce::jlimit (0, numPositions - 1, position), binaural };
+    }
+
+    // Positions numSamples of a stereo pair in place
+    void process (float* left, float* right, int numSamples) noexcept
+    {
+        jassert (numSamples <= scratch.getNumSamples());
+
+        // The ear filters always run on the latest input, so they are ready whenever they're needed
+        auto* mono = history.getWritePointer (0) + filterLength - 1;
+        juce::FloatVectorOperations::add (mono, left, right, numSamples);
+        juce::FloatVectorOperations::multiply (mono, 0.5f, numSamples);
+
+        if (rampPosition >= rampLength && ! (requested == current))
+        {
+            previous = current;
+            current = requested;
+            rampPosition = 0;
+        }
+
+        const int numRamped = juce::jmin (numSamples, rampLength - rampPosition);
+
+        if (numRamped == 0)
+        {
+            render (current, left, right, numSamples);
+        }
+        else if (! previous.usesEarFilters() && ! current.usesEarFilters())
+        {
+            // The matrix itself ramps
+            const auto from = getMatrix (previous.position);
+            const auto to = getMatrix (current.position);
+            const float step = 1.0f / (float) rampLength;
+
+            applyMatrix (left, right, numRamped, from.interpolatedTo (to, (float) rampPosition * step), (to - from) * step);
+            applyMatrix (left + numRamped, right + numRamped, numSamples - numRamped, to, {});
+        }
+        else
+        {
+            // Render both positions and crossfade
+            auto* previousLeft = scratch.getWritePointer (1);
+            auto* previousRight = scratch.getWritePointer (2);
+            juce::FloatVectorOperations::copy (previousLeft, left, numSamples);
+            juce::FloatVectorOperations::copy (previousRight, right, numSamples);
+
+            render (previous, previousLeft, previousRight, numSamples);
+            render (current, left, right, numSamples);
+
+            const float step = 1.0f / (float) rampLength;
+            const float fade = (float) rampPosition * step;
+
+            mix (previousLeft, left, left, numRamped, 1.0f - fade, -step, fade, step);
+            mix (previousRight, right, right, numRamped, 1.0f - fade, -step, fade, step);
+        }
+
+        rampPosition += numRamped;
+
+        auto* line = history.getWritePointer (0);
+        std::memmove (line, line + numSamples, sizeof (float) * (size_t) (filterLength - 1));
+    }
+
+private:
+    //==============================================================================
+    static constexpr double rampSeconds = 0.03;
+    static constexpr double headRadius = 0.0875;            // Metres
+    static constexpr double speedOfSound = 343.0;           // Metres per second
+    static constexpr int delayTaps = 16;                    // Windowed sinc for the fractional part of the time difference
+
+    using Vec = juce::dsp::SIMDRegister<float>;
+    static constexpr int vecSize = (int) Vec::SIMDNumElements;
+
+    // left/right inputs -> left/right outputs
+    struct Matrix
+    {
+        float leftToLeft = 0.0f, rightToLeft = 0.0f, leftToRight = 0.0f, rightToRight = 0.0f;
+
+        Matrix operator- (const Matrix& other) const noexcept
+        {
+            return { leftToLeft - other.leftToLeft, rightToLeft - other.rightToLeft, leftToRight - other.leftToRight, rightToRight - other.rightToRight };
+        }
+
+        Matrix operator* (float gain) const noexcept
+        {
+            return { leftToLeft * gain, rightToLeft * gain, leftToRight * gain, rightToRight * gain };
+        }
+
+        Matrix interpolatedTo (const Matrix& other, float proportion) const noexcept
+        {
+            const auto difference = (other - *this) * proportion;
+            return { leftToLeft + difference.leftToLeft, rightToLeft + difference.rightToLeft,
+                     leftToRight + difference.leftToRight, rightToRight + difference.rightToRight };
+        }
+    };
+
+    struct Setting
+    {
+        int position = 0;
+        bool binaural = false;
+
+        // Ear and Bluetooth positions (1, 2, 5 and 6) have a near and a far ear
+        bool isAtAnEar() const noexcept             { return position == 1 || position == 2 || position == 5 || position == 6; }
+        bool isLeft() const noexcept                { return position == 1 || position == 5; }
+        bool usesEarFilters() const noexcept        { return binaural && isAtAnEar(); }
+
+        bool operator== (const Setting& other) const noexcept
+        {
+            return position == other.position && binaural == other.binaural;
+        }
+    };
+
+    static Matrix getMatrix (int position) noexcept
+    {
+        static constexpr Matrix matrices[numPositions] =
+        {
+            { 1.0f,   0.0f,   0.0f,   1.0f  },      // Center
+            { 0.5f,   0.5f,   0.1f,   0.1f  },      // Left ear: mono, a little bleeding to the right
+            { 0.1f,   0.1f,   0.5f,   0.5f  },      // Right ear
+            { 1.1f,  -0.1f,  -0.1f,   1.1f  },      // Speakerphone near: slightly widened
+            { 0.8f,   0.4f,   0.4f,   0.8f  },      // Speakerphone far: mostly mono
+            { 0.45f,  0.45f,  0.05f,  0.05f },      // Bluetooth left
+            { 0.05f,  0.05f,  0.45f,  0.45f }       // Bluetooth right
+        };
+
+        return matrices[position];
+    }
+
+    //==============================================================================
+    void render (const Setting& setting, float* left, float* right, int numSamples) noexcept
+    {
+        if (! setting.usesEarFilters())
+        {
+            applyMatrix (left, right, numSamples, getMatrix (setting.position), {});
+            return;
+        }
+
+        // The matrix's rows give the ears' gains for the mono call
+        const auto matrix = getMatrix (setting.position);
+        const float leftGain = matrix.leftToLeft + matrix.rightToLeft;
+        const float rightGain = matrix.leftToRight + matrix.rightToRight;
+
+        applyEarFilter (setting.isLeft() ? nearEarFilter : farEarFilter, leftGain, left, numSamples);
+        applyEarFilter (setting.isLeft() ? farEarFilter : nearEarFilter, rightGain, right, numSamples);
+    }
+
+    // Every tap is one vectorised pass over the block
+    void applyEarFilter (const std::vector<float>& filter, float gain, float* destination, int numSamples) const noexcept
+    {
+        const auto* mono = history.getReadPointer (0) + filterLength - 1;
+
+        juce::FloatVectorOperations::clear (destination, numSamples);
+
+        for (int tap = 0; tap < filterLength; ++tap)
+            juce::FloatVectorOperations::addWithMultiply (destination, mono - tap, filter[(size_t) tap] * gain, numSamples);
+    }
+
+    // The matrix starts at 'from' and moves by 'step' every sample
+    void applyMatrix (float* left, float* right, int numSamples, const Matrix& from, const Matrix& step) noexcept
+    {
+        auto* newLeft = scratch.getWritePointer (0);
+
+        mix (left, right, newLeft, numSamples, from.leftToLeft, step.leftToLeft, from.rightToLeft, step.rightToLeft);
+        mix (left, right, right, numSamples, from.leftToRight, step.leftToRight, from.rightToRight, step.rightToRight);
+        juce::FloatVectorOperations::copy (left, newLeft, numSamples);
+    }
+
+    // destination = a * x + b * y, with a and b moving by their steps every sample. Works in place.
+    static void mix (const float* x, const float* y, float* destination, int numSamples,
+                     float a, float aStep, float b, float bStep) noexcept
+    {
+        int i = 0;
+
+        if (numSamples >= vecSize)
+        {
+            alignas (Vec::SIMDRegisterSize) float lanes[vecSize];
+
+            for (int lane = 0; lane < vecSize; ++lane)
+                lanes[lane] = (float) lane;
+
+            const auto laneIndex = Vec::fromRawArray (lanes);
+            auto aLanes = Vec::expand (a) + laneIndex * aStep;
+            auto bLanes = Vec::expand (b) + laneIndex * bStep;
+            const auto aIncrement = Vec::expand (aStep * (float) vecSize);
+            const auto bIncrement = Vec::expand (bStep * (float) vecSize);
+
+            for (; i + vecSize <= numSamples; i += vecSize)
+            {
+                store (destination + i, load (x + i) * aLanes + load (y + i) * bLanes);
+                aLanes += aIncrement;
+                bLanes += bIncrement;
+            }
+        }
+
+        for (; i < numSamples; ++i)
+            destination[i] = x[i] * (a + aStep * (float) i) + y[i] * (b + bStep * (float) i);
+    }
+
+    // Host buffers carry no alignment guarantee (see PhoneWaveshaper)
+    static Vec load (const float* source) noexcept
+    {
+        alignas (Vec::SIMDRegisterSize) float lanes[vecSize];
+        std::memcpy (lanes, source, sizeof (lanes));
+        return Vec::fromRawArray (lanes);
+    }
+
+    static void store (float* destination, Vec value) noexcept
+    {
+        alignas (Vec::SIMDRegisterSize) float lanes[vecSize];
+        value.copyToRawArray (lanes);
+        std::memcpy (destination, lanes, sizeof (lanes));
+    }
+
+    //==============================================================================
+    // Head shadow H(s) = (alpha s + beta) / (s + beta), beta = 2c/a: alpha above 1 lifts the highs
+    // at the near ear, below 1 shadows them at the far one. The far ear hears it delayed as well.
+    void designEarFilters (double sampleRate)
+    {
+        const double interauralDelay = sampleRate * headRadius / speedOfSound * (juce::MathConstants<double>::halfPi + 1.0);
+        const double delayCentre = juce::jmax ((double) delayTaps / 2, interauralDelay);
+        const int tailLength = (int) std::ceil (sampleRate * 0.001);      // The shadow has rung down well within 1ms
+
+        filterLength = (int) std::ceil (delayCentre) + delayTaps / 2 + tailLength;
+        filterLength = (filterLength + vecSize - 1) / vecSize * vecSize;
+
+        nearEarFilter.assign ((size_t) filterLength, 0.0f);
+        farEarFilter.assign ((size_t) filterLength, 0.0f);
+
+        nearEarFilter[0] = 1.0f;
+
+        // Fractional delay: Hann windowed sinc
+        for (int tap = 0; tap < filterLength; ++tap)
+        {
+            const double offset = (double) tap - delayCentre;
+
+            if (std::abs (offset) >= delayTaps / 2)
+                continue;
+
+            const double window = 0.5 + 0.5 * std::cos (juce::MathConstants<double>::pi * offset / (delayTaps / 2));
+            const double sinc = offset == 0.0 ? 1.0 : std::sin (juce::MathConstants<double>::pi * offset) / (juce::MathConstants<double>::pi * offset);
+            farEarFilter[(size_t) tap] = (float) (window * sinc);
+        }
+
+        applyHeadShadow (nearEarFilter, 1.5, sampleRate);
+        applyHeadShadow (farEarFilter, 0.1, sampleRate);
+    }
+
+    // Bilinear transform of the head shadow, run over the filter in place
+    static void applyHeadShadow (std::vector<float>& filter, double alpha, double sampleRate)
+    {
+        const double beta = 2.0 * speedOfSound / headRadius;
+        const double k = 2.0 * sampleRate;
+
+        const double a0 = k + beta;
+        const double b0 = (alpha * k + beta) / a0;
+        const double b1 = (beta - alpha * k) / a0;
+        const double a1 = (beta - k) / a0;
+
+        double previousInput = 0.0, previousOutput = 0.0;
+
+        for (auto& sample : filter)
+        {
+            const double input = sample;
+            previousOutput = b0 * input + b1 * previousInput - a1 * previousOutput;
+            previousInput = input;
+            sample = (float) previousOutput;
+        }
+    }
+
+    //==============================================================================
+    int rampLength = 1;
+    int rampPosition = 1;
+
+    Setting requested, current, previous;
+
+    int filterLength = vecSize;
+    std::vector<float> nearEarFilter, farEarFilter;
+
+    juce::AudioBuffer<float> history;       // The mono call, filterLength - 1 samples back from this block
+    juce::AudioBuffer<float> scratch;       // The matrix's new left, then the previous position's rendering
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CallPositionStage)
+};
@@ -0,0 +1,308 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "AMRNarrowbandCodec.h"
+#include "GSMFullRateCodec.h"
+#include "NoiseEngine.h"
+#include "OscillatorBank.h"
+
+//==============================================================================
+/**
+    Speech codec simulation that works the way the codecs do: on 20ms frames
+    of 160 samples at 8kHz. The stage runs inside the processor's telephone
+    band (see NarrowbandResampler), so it is fed 8kHz audio directly.
+
+    Incoming audio is collected into a frame per channel. Once a frame is
+    full it is coded in one go, and it plays out while the next frame is
+    being collected - so the stage delays the signal by exactly one frame
+    (getLatencySamples()). GSM full rate runs the real GSM 06.10 encoder and
+    decoder (GSMFullRateCodec), and the AMR types run an ACELP encoder and
+    decoder (AMRNarrowbandCodec) whose mode follows the signal strength frame
+    by frame, as the network's link adaptation would. The other codecs are
+    the per-sample models the processor used to have (GSM half rate, CDMA
+    QCELP, early VoIP), reworked to quantise and decorate a whole frame at a
+    time. Their per-frame decisions (voice activity, comfort noise,
+    reconstruction glitches, frame noise) are taken once per frame, and
+    everything else is a straight loop.
+
+    All buffers are sized by prepare(); process() never allocates.
+*/
+class CodecStage
+{
+public:
+    enum Codec
+    {
+        gsmFullRate = 0,        // GSM 06.10 (13 kbps)
+        gsmHalfRate = 1,        // GSM half rate (5.6 kbps)
+        cdmaQCELP = 2,          // CDMA QCELP
+        amr475 = 3,             // AMR 4.75 kbps
+        amr122 = 4,             // AMR 12.2 kbps
+        earlyVoIP = 5,          // Early internet calling
+        digitalArtifact = 6     // Early VoIP, pushed harder
+    };
+
+    static constexpr double sampleRate = 8000.0;
+    static constexpr int frameSize = GSMFullRateCodec::frameSize;
+
+    CodecStage() = default;
+
+    //==============================================================================
+    void prepare (int newNumChannels)
+    {
+        numChannels = juce::jmax (1, newNumChannels);
+
+        gsmCodecs.clear();
+        amrCodecs.clear();
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            gsmCodecs.add (new GSMFullRateCodec());
+            amrCodecs.add (new AMRNarrowbandCodec());
+        }
+
+        inputFrames.setSize (numChannels, frameSize);
+        previousInputFrames.setSize (numChannels, frameSize);
+        outputFrames.setSize (numChannels, frameSize);
+
+        oscillators.prepare (sampleRate);
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        for (int channel = 0; channel < gsmCodecs.size(); ++channel)
+        {
+            gsmCodecs[channel]->reset();
+            amrCodecs[channel]->reset();
+        }
+
+        inputFrames.clear();
+        previousInputFrames.clear();
+        outputFrames.clear();
+
+        framePosition = 0;
+        amrMode = AMRNarrowbandCodec::mr122;
+        oscillators.reset();
+    }
+
+    // Fixed delay of the stage (one frame), in 8kHz samples
+    int getLatencySamples() const noexcept      { return frameSize; }
+
+    // Radio link quality (0 = no signal, 1 = perfect), which the AMR codecs adapt their rate to
+    void setSignalStrength (float newSignalStrength) noexcept   { signalStrength = juce::jlimit (0.0f, 1.0f, newSignalStrength); }
+
+    // The AMR mode used for the last frame
+    AMRNarrowbandCodec::Mode getAMRMode() const noexcept        { return amrMode; }
+
+    //==============================================================================
+    // Runs numSamples of every channel (at 8kHz) through the codec in place
+    void process (float* const* channels, int numChannelsToProcess, int numSamples,
+                  Codec codec, float intensity, NoiseGenerator& noise) noexcept
+    {
+        jassert (numChannelsToProcess <= numChannels);
+        numChannelsToProcess = juce::jmin (numChannelsToProcess, numChannels);
+
+        for (int start = 0; start < numSamples;)
+        {
+            const int numThisTime = juce::jmin (numSamples - start, frameSize - framePosition);
+
+            for (int channel = 0; channel < numChannelsToProcess; ++channel)
+            {
+                auto* data = channels[channel] + start;
+
+                juce::FloatVectorOperations::copy (inputFrames.getWritePointer (channel, framePosition), data, numThisTime);
+                juce::FloatVectorOperations::copy (data, outputFrames.getReadPointer (channel, framePosition), numThisTime);
+            }
+
+            start += numThisTime;
+            framePosition += numThisTime;
+
+            if (framePosition == frameSize)
+            {
+                encodeFrames (numChannelsToProcess, codec, intensity, noise);
+                framePosition = 0;
+            }
+        }
+    }
+
+private:
+    //==============================================================================
+    enum Oscillator
+    {
+        artifactOscillator = 0      // CDMA digital whine / VoIP jitter tone
+    };
+
+    // Turns the collected input frames into the next output frames
+    void encodeFrames (int numChannelsToProcess, Codec codec, float intensity, NoiseGenerator& noise) noexcept
+    {
+        for (int channel = 0; channel < numChannelsToProcess; ++channel)
+            juce::FloatVectorOperations::copy (outputFrames.getWritePointer (channel), inputFrames.getReadPointer (channel), frameSize);
+
+        switch (codec)
+        {
+            case gsmFullRate:       encodeGSMFullRate (numChannelsToProcess); break;
+            case gsmHalfRate:       encodeGSMHalfRate (numChannelsToProcess, intensity, noise); break;
+            case cdmaQCELP:         encodeCDMA (numChannelsToProcess, intensity, noise); break;
+            case amr475:            encodeAMR (numChannelsToProcess, AMRNarrowbandCodec::mr475); break;
+            case amr122:            encodeAMR (numChannelsToProcess, AMRNarrowbandCodec::mr122); break;
+            case earlyVoIP:         encodeVoIP (numChannelsToProcess, intensity, noise); break;
+            case digitalArtifact:   encodeVoIP (numChannelsToProcess, intensity * 1.5f, noise); break; // More extreme
+            default:                break;
+        }
+
+        for (int channel = 0; channel < numChannelsToProcess; ++channel)
+        {
+            auto* frame = outputFrames.getWritePointer (channel);
+            juce::FloatVectorOperations::clip (frame, frame, -1.0f, 1.0f, frameSize);
+        }
+
+        // The frame just encoded becomes the one-frame-old input
+        std::swap (inputFrames, previousInputFrames);
+    }
+
+    // GSM full rate: the real codec, encoded and decoded at 13 bits
+    void encodeGSMFullRate (int numChannelsToProcess) noexcept
+    {
+        juce::int16 pcm[frameSize];
+
+        for (int channel = 0; channel < numChannelsToProcess; ++channel)
+        {
+            auto* frame = outputFrames.getWritePointer (channel);
+
+            for (int i = 0; i < frameSize; ++i)
+                pcm[i] = static_cast<juce::int16> (juce::jlimit (-32768.0f, 32767.0f, std::round (frame[i] * 32768.0f)));
+
+            gsmCodecs[channel]->process (pcm);
+
+            for (int i = 0; i < frameSize; ++i)
+                frame[i] = pcm[i] * (1.0f / 32768.0f);
+        }
+    }
+
+    // GSM half rate: 8-bit quantisation, plus a noise offset that jumps at every
+    // frame boundary - the codec's 50Hz frame "buzz"
+    void encodeGSMHalfRate (int numChannelsToProcess, float intensity, NoiseGenerator& noise) noexcept
+    {
+        for (int channel = 0; channel < numChannelsToProcess; ++channel)
+        {
+            auto* frame = outputFrames.getWritePointer (channel);
+            quantise (frame, frameSize, 256.0f);
+            juce::FloatVectorOperations::add (frame, (noise.nextFloat() * 2.0f - 1.0f) * 0.02f * intensity, frameSize);
+        }
+    }
+
+    // CDMA QCELP: frames without voice are replaced by comfort noise; voiced frames get
+    // 9-bit quantisation and a digital whine at the top of the band
+    void encodeCDMA (int numChannelsToProcess, float intensity, NoiseGenerator& noise) noexcept
+    {
+        constexpr float voiceThreshold = 0.05f;
+
+        oscillators.setFrequency (artifactOscillator, 3600.0);
+        oscillators.render (artifactOscillator, toneFrame, frameSize);
+
+        for (int channel = 0; channel < numChannelsToProcess; ++channel)
+        {
+            auto* frame = outputFrames.getWritePointer (channel);
+            const auto range = juce::FloatVectorOperations::findMinAndMax (frame, frameSize);
+
+            if (juce::jmax (-range.getStart(), range.getEnd()) <= voiceThreshold)
+            {
+                noise.fillBipolar (frame, frameSize, 0.01f * intensity);
+                continue;
+            }
+
+            quantise (frame, frameSize, 512.0f);
+            juce::FloatVectorOperations::addWithMultiply (frame, toneFrame, 0.01f * intensity, frameSize);
+        }
+    }
+
+    // AMR: the ACELP codec at a mode picked for this frame
+    void encodeAMR (int numChannelsToProcess, AMRNarrowbandCodec::Mode highestMode) noexcept
+    {
+        adaptAMRMode (highestMode);
+
+        for (int channel = 0; channel < numChannelsToProcess; ++channel)
+            amrCodecs[channel]->process (outputFrames.getWritePointer (channel), amrMode);
+    }
+
+    // Link adaptation: the signal strength spread over the modes up to highestMode picks a
+    // target, and the mode moves one step per frame towards it, with a quarter of a step of
+    // hysteresis so a strength sitting on a boundary doesn't flip the rate every frame.
+    // AMR 4.75 is the bottom of the set, so it stays there.
+    void adaptAMRMode (AMRNarrowbandCodec::Mode highestMode) noexcept
+    {
+        constexpr float hysteresis = 0.25f;
+
+        const float position = signalStrength * (float) (highestMode + 1);
+        int mode = juce::jmin ((int) amrMode, (int) highestMode);
+
+        if (position >= (float) (mode + 1) + hysteresis && mode < highestMode)
+            ++mode;
+        else if (position < (float) mode - hysteresis && mode > 0)
+            --mode;
+
+        amrMode = static_cast<AMRNarrowbandCodec::Mode> (mode);
+    }
+
+    // Early VoIP: now and then a frame can't be decoded and the previous one is replayed
+    // quieter; otherwise a faint echo-canceller residue and a wobbling jitter tone
+    void encodeVoIP (int numChannelsToProcess, float intensity, NoiseGenerator& noise) noexcept
+    {
+        constexpr int echoDelay = 8;
+
+        // The jitter wobble is drawn once per frame
+        oscillators.setFrequency (artifactOscillator, 636.6 * (1.0 + noise.nextFloat() * 0.2));
+        oscillators.render (artifactOscillator, toneFrame, frameSize);
+
+        const bool reconstructionGlitch = noise.nextFloat() < 0.02f * intensity;
+
+        for (int channel = 0; channel < numChannelsToProcess; ++channel)
+        {
+            auto* frame = outputFrames.getWritePointer (channel);
+            const auto* input = inputFrames.getReadPointer (channel);
+            const auto* previousInput = previousInputFrames.getReadPointer (channel);
+
+            if (reconstructionGlitch)
+            {
+                juce::FloatVectorOperations::copyWithMultiply (frame, previousInput, 0.7f, frameSize);
+                continue;
+            }
+
+            const int echoSplit = juce::jmin (echoDelay, frameSize);
+
+            for (int i = 0; i < echoSplit; ++i)
+                frame[i] += previousInput[frameSize - echoSplit + i] * 0.05f;
+
+            juce::FloatVectorOperations::addWithMultiply (frame + echoSplit, input, 0.05f, frameSize - echoSplit);
+            juce::FloatVectorOperations::addWithMultiply (frame, toneFrame, 0.02f * intensity, frameSize);
+        }
+    }
+
+    // Rounds every sample to the nearest multiple of 1 / levels. Adding and removing
+    // 1.5 * 2^23 rounds to nearest without a call, so the loop vectorises.
+    static void quantise (float* data, int numSamples, float levels) noexcept
+    {
+        constexpr float roundingConstant = 12582912.0f;
+        const float inverseLevels = 1.0f / levels;
+
+        for (int i = 0; i < numSamples; ++i)
+            data[i] = ((data[i] * levels + roundingConstant) - roundingConstant) * inverseLevels;
+    }
+
+    //==============================================================================
+    int numChannels = 1;
+
+    juce::OwnedArray<GSMFullRateCodec> gsmCodecs;
+    juce::OwnedArray<AMRNarrowbandCodec> amrCodecs;
+
+    juce::AudioBuffer<float> inputFrames, previousInputFrames, outputFrames;
+    int framePosition = 0;
+
+    float signalStrength = 1.0f;
+    AMRNarrowbandCodec::Mode amrMode = AMRNarrowbandCodec::mr122;
+
+    float toneFrame[frameSize] = {};
+    OscillatorBank oscillators;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CodecStage)
+};
@@ -0,0 +1,781 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    GSM 06.10 full-rate speech codec (RPE-LTP, 13 kbps): one encoder and one
+    decoder, so a call can be run through the real codec and back.
+
+    This follows the ETSI fixed-point reference arithmetic step by step (the
+    same arithmetic as the widely used libgsm), so encoder and decoder are bit
+    exact: every frame decodes to the samples a GSM handset of the time would
+    have played. Everything is 16/32-bit integer maths on a few hundred bytes
+    of state, with no tables beyond the standard's own, so dozens of instances
+    run comfortably in real time.
+
+    The codec works on 20ms frames of 160 samples at 8kHz, 13-bit linear
+    (passed as 16-bit; the low three bits are ignored, as in the standard).
+    A frame is handed from encoder to decoder as its 76 coded parameters
+    (260 bits) - packing them into the 33-byte over-the-air format adds
+    nothing to the sound, so it is left out.
+*/
+class GSMFullRateCodec
+{
+public:
+    static constexpr int frameSize = 160;
+    static constexpr int subframeSize = 40;
+
+    // The coded parameters of one frame
+    struct Frame
+    {
+        juce::int16 LARc[8];        // Log area ratios (6, 6, 5, 5, 4, 4, 3, 3 bits)
+        juce::int16 Nc[4];          // LTP lag per subframe (7 bits)
+        juce::int16 bc[4];          // LTP gain per subframe (2 bits)
+        juce::int16 Mc[4];          // RPE grid position per subframe (2 bits)
+        juce::int16 xmaxc[4];       // Block amplitude per subframe (6 bits)
+        juce::int16 xMc[4][13];     // RPE pulses per subframe (3 bits each)
+    };
+
+    GSMFullRateCodec()
+    {
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        encoder = EncoderState();
+        decoder = DecoderState();
+    }
+
+    //==============================================================================
+    void encode (const juce::int16* input, Frame& frame) noexcept
+    {
+        Word so[frameSize];
+
+        preprocess (input, so);
+        lpcAnalysis (so, frame.LARc);
+        shortTermAnalysisFilter (frame.LARc, so);
+
+        Word* dp = encoder.dp0 + 120;       // Reconstructed residual [-120..-1]
+        Word* dpp = dp;                     // LTP estimate [0..39]
+
+        for (int k = 0; k < 4; ++k)
+        {
+            Word* e = encoder.e + 5;
+
+            longTermPredictor (so + k * subframeSize, dp, e, dpp, frame.Nc[k], frame.bc[k]);
+            rpeEncoding (e, frame.xmaxc[k], frame.Mc[k], frame.xMc[k]);
+
+            for (int i = 0; i < subframeSize; ++i)
+                dp[i] = add (e[i], dpp[i]);
+
+            dp += subframeSize;
+            dpp += subframeSize;
+        }
+
+        std::memmove (encoder.dp0, encoder.dp0 + frameSize, 120 * sizeof (Word));
+    }
+
+    void decode (const Frame& frame, juce::int16* output) noexcept
+    {
+        Word wt[frameSize];
+        Word* drp = decoder.dp0 + 120;
+
+        for (int j = 0; j < 4; ++j)
+        {
+            Word erp[subframeSize];
+
+            rpeDecoding (frame.xmaxc[j], frame.Mc[j], frame.xMc[j], erp);
+            longTermSynthesisFilter (frame.Nc[j], frame.bc[j], erp, drp);
+
+            for (int k = 0; k < subframeSize; ++k)
+                wt[j * subframeSize + k] = drp[k];
+        }
+
+        shortTermSynthesisFilter (frame.LARc, wt, output);
+        postprocess (output);
+    }
+
+    // Encodes and decodes one frame in place
+    void process (juce::int16* samples) noexcept
+    {
+        Frame frame;
+        encode (samples, frame);
+        decode (frame, samples);
+    }
+
+private:
+    //==============================================================================
+    using Word = juce::int16;
+    using LongWord = juce::int32;
+
+    static constexpr LongWord minWord = -32768, maxWord = 32767;
+    static constexpr juce::int64 minLongWord = -2147483647LL - 1, maxLongWord = 2147483647LL;
+
+    struct EncoderState
+    {
+        Word dp0[280] = {};         // Past reconstructed residual
+        Word e[50] = {};            // Residual with 5 zero samples either side
+
+        Word z1 = 0;                // Offset compensation
+        LongWord L_z2 = 0;
+        Word mp = 0;                // Preemphasis
+
+        Word u[8] = {};             // Short-term analysis filter
+        Word LARpp[2][8] = {};      // Decoded LARs of this and the last frame
+        int j = 0;
+    };
+
+    struct DecoderState
+    {
+        Word dp0[280] = {};         // Past reconstructed residual
+
+        Word v[9] = {};             // Short-term synthesis filter
+        Word LARpp[2][8] = {};
+        int j = 0;
+
+        Word nrp = 40;              // Last valid LTP lag
+        Word msr = 0;               // Deemphasis
+    };
+
+    //==============================================================================
+    // Basic operators of the reference arithmetic
+    static Word saturate (LongWord x) noexcept                  { return static_cast<Word> (juce::jlimit (minWord, maxWord, x)); }
+    static Word add (LongWord a, LongWord b) noexcept            { return saturate (a + b); }
+    static Word sub (LongWord a, LongWord b) noexcept            { return saturate (a - b); }
+    static Word mult (Word a, Word b) noexcept                   { return static_cast<Word> ((static_cast<LongWord> (a) * b) >> 15); }
+    static Word abs (Word a) noexcept                            { return a < 0 ? (a == minWord ? static_cast<Word> (maxWord) : static_cast<Word> (-a)) : a; }
+
+    static Word multR (Word a, Word b) noexcept
+    {
+        if (a == minWord && b == minWord)
+            return static_cast<Word> (maxWord);
+
+        return static_cast<Word> ((static_cast<LongWord> (a) * b + 16384) >> 15);
+    }
+
+    static LongWord addL (LongWord a, LongWord b) noexcept
+    {
+        return static_cast<LongWord> (juce::jlimit (minLongWord, maxLongWord, static_cast<juce::int64> (a) + b));
+    }
+
+    // Left shifts that normalise a (0 for a == 0 gives 31)
+    static int norm (LongWord a) noexcept
+    {
+        if (a < 0)
+        {
+            if (a <= -1073741824)
+                return 0;
+
+            a = ~a;
+        }
+
+        int bits = 0;
+
+        for (auto v = static_cast<juce::uint32> (a); v != 0; v >>= 1)
+            ++bits;
+
+        return 31 - bits;
+    }
+
+    static Word asr (Word a, int n) noexcept
+    {
+        if (n >= 16)    return static_cast<Word> (-(a < 0));
+        if (n <= -16)   return 0;
+        if (n < 0)      return static_cast<Word> (a << -n);
+        return static_cast<Word> (a >> n);
+    }
+
+    static Word asl (Word a, int n) noexcept
+    {
+        if (n >= 16)    return 0;
+        if (n <= -16)   return static_cast<Word> (-(a < 0));
+        if (n < 0)      return asr (a, -n);
+        return static_cast<Word> (a << n);
+    }
+
+    // num / denum for 0 <= num <= denum, as a 15-bit fraction
+    static Word div (Word num, Word denum) noexcept
+    {
+        if (num == 0)
+            return 0;
+
+        LongWord L_num = num;
+        const LongWord L_denum = denum;
+        Word result = 0;
+
+        for (int k = 15; k--;)
+        {
+            result = static_cast<Word> (result << 1);
+            L_num <<= 1;
+
+            if (L_num >= L_denum)
+            {
+                L_num -= L_denum;
+                ++result;
+            }
+        }
+
+        return result;
+    }
+
+    //==============================================================================
+    // Tables 4.3a/b (LTP gain levels) and 4.5/4.6 (RPE mantissas)
+    static constexpr Word DLB[4]   = { 6554, 16384, 26214, 32767 };
+    static constexpr Word QLB[4]   = { 3277, 11469, 21299, 32767 };
+    static constexpr Word NRFAC[8] = { 29128, 26215, 23832, 21846, 20165, 18725, 17476, 16384 };
+    static constexpr Word FAC[8]   = { 18431, 20479, 22527, 24575, 26623, 28671, 30719, 32767 };
+
+    //==============================================================================
+    // 4.2.1 - 4.2.3: downscaling, offset compensation and preemphasis
+    void preprocess (const juce::int16* s, Word* so) noexcept
+    {
+        Word z1 = encoder.z1;
+        LongWord L_z2 = encoder.L_z2;
+        Word mp = encoder.mp;
+
+        for (int k = 0; k < frameSize; ++k)
+        {
+            const Word SO = static_cast<Word> ((s[k] >> 3) << 2);
+
+            const Word s1 = static_cast<Word> (SO - z1);
+            z1 = SO;
+
+            LongWord L_s2 = static_cast<LongWord> (s1) << 15;
+
+            const Word msp = static_cast<Word> (L_z2 >> 15);
+            const Word lsp = static_cast<Word> (L_z2 - (static_cast<LongWord> (msp) << 15));
+
+            L_s2 += multR (lsp, 32735);
+            L_z2 = addL (static_cast<LongWord> (msp) * 32735, L_s2);
+
+            const LongWord L_temp = addL (L_z2, 16384);
+
+            const Word preemphasis = multR (mp, -28180);
+            mp = static_cast<Word> (L_temp >> 15);
+            so[k] = add (mp, preemphasis);
+        }
+
+        encoder.z1 = z1;
+        encoder.L_z2 = L_z2;
+        encoder.mp = mp;
+    }
+
+    //==============================================================================
+    // 4.2.4 - 4.2.7: LPC analysis down to the coded log area ratios
+    static void lpcAnalysis (Word* s, Word* LARc) noexcept
+    {
+        LongWord L_ACF[9];
+
+        autocorrelation (s, L_ACF);
+        reflectionCoefficients (L_ACF, LARc);
+        transformToLogAreaRatios (LARc);
+        quantiseLogAreaRatios (LARc);
+    }
+
+    static void autocorrelation (Word* s, LongWord* L_ACF) noexcept
+    {
+        Word smax = 0;
+
+        for (int k = 0; k < frameSize; ++k)
+            smax = juce::jmax (smax, abs (s[k]));
+
+        const int scalauto = smax == 0 ? 0 : 4 - norm (static_cast<LongWord> (smax) << 16);
+
+        if (scalauto > 0)
+        {
+            const auto factor = static_cast<Word> (16384 >> (scalauto - 1));
+
+            for (int k = 0; k < frameSize; ++k)
+                s[k] = multR (s[k], factor);
+        }
+
+        for (int k = 0; k < 9; ++k)
+        {
+            LongWord sum = 0;
+
+            for (int i = k; i < frameSize; ++i)
+                sum += static_cast<LongWord> (s[i]) * s[i - k];
+
+            L_ACF[k] = sum << 1;
+        }
+
+        if (scalauto > 0)
+            for (int k = 0; k < frameSize; ++k)
+                s[k] = static_cast<Word> (s[k] << scalauto);
+    }
+
+    // Schur recursion with 16-bit arithmetic
+    static void reflectionCoefficients (const LongWord* L_ACF, Word* r) noexcept
+    {
+        if (L_ACF[0] == 0)
+        {
+            std::fill (r, r + 8, Word (0));
+            return;
+        }
+
+        const int temp = norm (L_ACF[0]);
+        Word P[9], K[9];
+
+        for (int i = 0; i <= 8; ++i)
+            P[i] = static_cast<Word> ((L_ACF[i] << temp) >> 16);
+
+        for (int i = 1; i <= 7; ++i)
+            K[i] = P[i];
+
+        for (int n = 1; n <= 8; ++n, ++r)
+        {
+            const Word absP1 = abs (P[1]);
+
+            if (P[0] < absP1)
+            {
+                std::fill (r, r + (9 - n), Word (0));
+                return;
+            }
+
+            *r = div (absP1, P[0]);
+
+            if (P[1] > 0)
+                *r = static_cast<Word> (-*r);
+
+            if (n == 8)
+                return;
+
+            P[0] = add (P[0], multR (P[1], *r));
+
+            for (int m = 1; m <= 8 - n; ++m)
+            {
+                P[m] = add (P[m + 1], multR (K[m], *r));
+                K[m] = add (K[m], multR (P[m + 1], *r));
+            }
+        }
+    }
+
+    static void transformToLogAreaRatios (Word* r) noexcept
+    {
+        for (int i = 0; i < 8; ++i)
+        {
+            Word temp = abs (r[i]);
+
+            if (temp < 22118)       temp = static_cast<Word> (temp >> 1);
+            else if (temp < 31130)  temp = static_cast<Word> (temp - 11059);
+            else                    temp = static_cast<Word> ((temp - 26112) << 2);
+
+            r[i] = r[i] < 0 ? static_cast<Word> (-temp) : temp;
+        }
+    }
+
+    // Table 4.1: A, B, MAC and MIC per LAR
+    static void quantiseLogAreaRatios (Word* LAR) noexcept
+    {
+        static constexpr Word A[8]   = { 20480, 20480, 20480, 20480, 13964, 15360, 8534, 9036 };
+        static constexpr Word B[8]   = { 0, 0, 2048, -2560, 94, -1792, -341, -1144 };
+        static constexpr Word MAC[8] = { 31, 31, 15, 15, 7, 7, 3, 3 };
+        static constexpr Word MIC[8] = { -32, -32, -16, -16, -8, -8, -4, -4 };
+
+        for (int i = 0; i < 8; ++i)
+        {
+            Word temp = mult (A[i], LAR[i]);
+            temp = add (temp, B[i]);
+            temp = add (temp, 256);
+            temp = static_cast<Word> (temp >> 9);
+
+            LAR[i] = static_cast<Word> (temp > MAC[i] ? MAC[i] - MIC[i] : (temp < MIC[i] ? 0 : temp - MIC[i]));
+        }
+    }
+
+    //==============================================================================
+    // 4.2.8 - 4.2.10 and 4.3.2: LAR decoding and interpolation, shared by both filters
+    static void decodeLogAreaRatios (const Word* LARc, Word* LARpp) noexcept
+    {
+        static constexpr Word B[8]    = { 0, 0, 2048, -2560, 94, -1792, -341, -1144 };
+        static constexpr Word MIC[8]  = { -32, -32, -16, -16, -8, -8, -4, -4 };
+        static constexpr Word INVA[8] = { 13107, 13107, 13107, 13107, 19223, 17476, 31454, 29708 };
+
+        for (int i = 0; i < 8; ++i)
+        {
+            Word temp = static_cast<Word> (add (LARc[i], MIC[i]) << 10);
+            temp = sub (temp, B[i] * 2);
+            temp = multR (INVA[i], temp);
+            LARpp[i] = add (temp, temp);
+        }
+    }
+
+    // LARs for the four interpolation segments (samples 0-12, 13-26, 27-39, 40-159)
+    static void interpolateLogAreaRatios (int segment, const Word* previous, const Word* current, Word* LARp) noexcept
+    {
+        for (int i = 0; i < 8; ++i)
+        {
+            switch (segment)
+            {
+                case 0:     LARp[i] = add (add (previous[i] >> 2, current[i] >> 2), previous[i] >> 1); break;
+                case 1:     LARp[i] = add (previous[i] >> 1, current[i] >> 1); break;
+                case 2:     LARp[i] = add (add (previous[i] >> 2, current[i] >> 2), current[i] >> 1); break;
+                default:    LARp[i] = current[i]; break;
+            }
+        }
+    }
+
+    // Converts interpolated LARs back to reflection coefficients in place
+    static void logAreaRatiosToReflection (Word* LARp) noexcept
+    {
+        for (int i = 0; i < 8; ++i)
+        {
+            const bool negative = LARp[i] < 0;
+            const Word temp = negative ? abs (LARp[i]) : LARp[i];
+
+            const Word rp = temp < 11059 ? static_cast<Word> (temp << 1)
+                          : temp < 20070 ? static_cast<Word> (temp + 11059)
+                                         : add (temp >> 2, 26112);
+
+            LARp[i] = negative ? static_cast<Word> (-rp) : rp;
+        }
+    }
+
+    static constexpr int segmentStart[5] = { 0, 13, 27, 40, frameSize };
+
+    void shortTermAnalysisFilter (const Word* LARc, Word* s) noexcept
+    {
+        Word* LARpp_j = encoder.LARpp[encoder.j];
+        const Word* LARpp_j_1 = encoder.LARpp[encoder.j ^= 1];
+        Word LARp[8];
+
+        decodeLogAreaRatios (LARc, LARpp_j);
+
+        for (int segment = 0; segment < 4; ++segment)
+        {
+            interpolateLogAreaRatios (segment, LARpp_j_1, LARpp_j, LARp);
+            logAreaRatiosToReflection (LARp);
+
+            // Lattice filter
+            for (int k = segmentStart[segment]; k < segmentStart[segment + 1]; ++k)
+            {
+                Word di = s[k], sav = s[k];
+
+                for (int i = 0; i < 8; ++i)
+                {
+                    const Word ui = encoder.u[i];
+                    encoder.u[i] = sav;
+                    sav = add (ui, multR (LARp[i], di));
+                    di = add (di, multR (LARp[i], ui));
+                }
+
+                s[k] = di;
+            }
+        }
+    }
+
+    void shortTermSynthesisFilter (const Word* LARcr, const Word* wt, Word* sr) noexcept
+    {
+        Word* LARpp_j = decoder.LARpp[decoder.j];
+        const Word* LARpp_j_1 = decoder.LARpp[decoder.j ^= 1];
+        Word LARp[8];
+
+        decodeLogAreaRatios (LARcr, LARpp_j);
+
+        for (int segment = 0; segment < 4; ++segment)
+        {
+            interpolateLogAreaRatios (segment, LARpp_j_1, LARpp_j, LARp);
+            logAreaRatiosToReflection (LARp);
+
+            // Inverse lattice filter
+            for (int k = segmentStart[segment]; k < segmentStart[segment + 1]; ++k)
+            {
+                Word sri = wt[k];
+
+                for (int i = 7; i >= 0; --i)
+                {
+                    sri = sub (sri, multR (LARp[i], decoder.v[i]));
+                    decoder.v[i + 1] = add (decoder.v[i], multR (LARp[i], sri));
+                }
+
+                sr[k] = decoder.v[0] = sri;
+            }
+        }
+    }
+
+    //==============================================================================
+    // 4.2.11 - 4.2.12: long-term (pitch) prediction of one subframe
+    static void longTermPredictor (const Word* d, const Word* dp, Word* e, Word* dpp, Word& Nc, Word& bc) noexcept
+    {
+        calculateLTPParameters (d, dp, bc, Nc);
+
+        const Word bp = QLB[bc];
+
+        for (int k = 0; k < subframeSize; ++k)
+        {
+            dpp[k] = multR (bp, dp[k - Nc]);
+            e[k] = sub (d[k], dpp[k]);
+        }
+    }
+
+    static void calculateLTPParameters (const Word* d, const Word* dp, Word& bcOut, Word& NcOut) noexcept
+    {
+        Word dmax = 0;
+
+        for (int k = 0; k < subframeSize; ++k)
+            dmax = juce::jmax (dmax, abs (d[k]));
+
+        const int temp = dmax == 0 ? 0 : norm (static_cast<LongWord> (dmax) << 16);
+        const int scal = temp > 6 ? 0 : 6 - temp;
+
+        Word wt[subframeSize];
+
+        for (int k = 0; k < subframeSize; ++k)
+            wt[k] = static_cast<Word> (d[k] >> scal);
+
+        // Lag with the largest cross-correlation
+        LongWord L_max = 0;
+        Word Nc = 40;
+
+        for (int lambda = 40; lambda <= 120; ++lambda)
+        {
+            LongWord L_result = 0;
+
+            for (int k = 0; k < subframeSize; ++k)
+                L_result += static_cast<LongWord> (wt[k]) * dp[k - lambda];
+
+            if (L_result > L_max)
+            {
+                Nc = static_cast<Word> (lambda);
+                L_max = L_result;
+            }
+        }
+
+        NcOut = Nc;
+        L_max <<= 1;
+        L_max >>= (6 - scal);
+
+        // Power of the reconstructed residual at that lag
+        LongWord L_power = 0;
+
+        for (int k = 0; k < subframeSize; ++k)
+        {
+            const LongWord L_temp = dp[k - Nc] >> 3;
+            L_power += L_temp * L_temp;
+        }
+
+        L_power <<= 1;
+
+        if (L_max <= 0)
+        {
+            bcOut = 0;
+            return;
+        }
+
+        if (L_max >= L_power)
+        {
+            bcOut = 3;
+            return;
+        }
+
+        const int shift = norm (L_power);
+        const auto R = static_cast<Word> ((L_max << shift) >> 16);
+        const auto S = static_cast<Word> ((L_power << shift) >> 16);
+
+        Word bc = 0;
+
+        while (bc <= 2 && R > mult (S, DLB[bc]))
+            ++bc;
+
+        bcOut = bc;
+    }
+
+    //==============================================================================
+    // 4.2.13 - 4.2.18: RPE encoding of one subframe; e is updated with the quantised residual
+    static void rpeEncoding (Word* e, Word& xmaxc, Word& Mc, Word* xMc) noexcept
+    {
+        Word x[subframeSize], xM[13], xMp[13];
+        int exp = 0, mant = 0;
+
+        weightingFilter (e, x);
+        selectRPEGrid (x, xM, Mc);
+        quantiseAPCM (xM, xMc, mant, exp, xmaxc);
+        inverseQuantiseAPCM (xMc, mant, exp, xMp);
+        positionRPEGrid (Mc, xMp, e);
+    }
+
+    // Block filter with the 11-tap weighting impulse response (e[-5..-1] and e[40..44] are zero)
+    static void weightingFilter (const Word* e, Word* x) noexcept
+    {
+        static constexpr LongWord H[11] = { -134, -374, 0, 2054, 5741, 8192, 5741, 2054, 0, -374, -134 };
+
+        for (int k = 0; k < subframeSize; ++k)
+        {
+            LongWord L_result = 8192 >> 1;
+
+            for (int i = 0; i < 11; ++i)
+                L_result += e[k + i - 5] * H[i];
+
+            x[k] = saturate (L_result >> 13);
+        }
+    }
+
+    static void selectRPEGrid (const Word* x, Word* xM, Word& McOut) noexcept
+    {
+        LongWord EM = 0;
+        Word Mc = 0;
+
+        for (int m = 0; m <= 3; ++m)
+        {
+            LongWord L_result = 0;
+
+            for (int i = 0; i <= 12; ++i)
+            {
+                const LongWord L_temp = x[m + 3 * i] >> 2;
+                L_result += L_temp * L_temp;
+            }
+
+            L_result <<= 1;
+
+            if (m == 0 || L_result > EM)
+            {
+                Mc = static_cast<Word> (m);
+                EM = L_result;
+            }
+        }
+
+        for (int i = 0; i <= 12; ++i)
+            xM[i] = x[Mc + 3 * i];
+
+        McOut = Mc;
+    }
+
+    static void quantiseAPCM (const Word* xM, Word* xMc, int& mantOut, int& expOut, Word& xmaxcOut) noexcept
+    {
+        Word xmax = 0;
+
+        for (int i = 0; i <= 12; ++i)
+            xmax = juce::jmax (xmax, abs (xM[i]));
+
+        // Block maximum to a 6-bit pseudo-logarithm
+        int exp = 0;
+        Word temp = static_cast<Word> (xmax >> 9);
+        bool itest = false;
+
+        for (int i = 0; i <= 5; ++i)
+        {
+            itest = itest || temp <= 0;
+            temp = static_cast<Word> (temp >> 1);
+
+            if (! itest)
+                ++exp;
+        }
+
+        const Word xmaxc = add (xmax >> (exp + 5), exp << 3);
+
+        int mant = 0;
+        xmaxcToExpMant (xmaxc, exp, mant);
+
+        // Pulses to 3 bits, dividing by the decoded xmax through its inverse mantissa
+        const int temp1 = 6 - exp;
+        const Word temp2 = NRFAC[mant];
+
+        for (int i = 0; i <= 12; ++i)
+        {
+            Word pulse = static_cast<Word> (xM[i] << temp1);
+            pulse = mult (pulse, temp2);
+            pulse = static_cast<Word> (pulse >> 12);
+            xMc[i] = static_cast<Word> (pulse + 4);
+        }
+
+        mantOut = mant;
+        expOut = exp;
+        xmaxcOut = xmaxc;
+    }
+
+    static void xmaxcToExpMant (Word xmaxc, int& expOut, int& mantOut) noexcept
+    {
+        int exp = xmaxc > 15 ? (xmaxc >> 3) - 1 : 0;
+        int mant = xmaxc - (exp << 3);
+
+        if (mant == 0)
+        {
+            exp = -4;
+            mant = 7;
+        }
+        else
+        {
+            while (mant <= 7)
+            {
+                mant = mant << 1 | 1;
+                --exp;
+            }
+
+            mant -= 8;
+        }
+
+        expOut = exp;
+        mantOut = mant;
+    }
+
+    static void inverseQuantiseAPCM (const Word* xMc, int mant, int exp, Word* xMp) noexcept
+    {
+        const Word temp1 = FAC[mant];
+        const Word temp2 = sub (6, exp);
+        const Word temp3 = asl (1, sub (temp2, 1));
+
+        for (int i = 0; i <= 12; ++i)
+        {
+            Word temp = static_cast<Word> (((xMc[i] << 1) - 7) << 12);    // Restore the sign, to 16 bits
+            temp = multR (temp1, temp);
+            temp = add (temp, temp3);
+            xMp[i] = asr (temp, temp2);
+        }
+    }
+
+    static void positionRPEGrid (Word Mc, const Word* xMp, Word* ep) noexcept
+    {
+        std::fill (ep, ep + subframeSize, Word (0));
+
+        for (int i = 0; i <= 12; ++i)
+            ep[Mc + 3 * i] = xMp[i];
+    }
+
+    //==============================================================================
+    // 4.3.1 - 4.3.5: decoder
+    static void rpeDecoding (Word xmaxcr, Word Mcr, const Word* xMcr, Word* erp) noexcept
+    {
+        int exp = 0, mant = 0;
+        Word xMp[13];
+
+        xmaxcToExpMant (xmaxcr, exp, mant);
+        inverseQuantiseAPCM (xMcr, mant, exp, xMp);
+        positionRPEGrid (Mcr, xMp, erp);
+    }
+
+    void longTermSynthesisFilter (Word Ncr, Word bcr, const Word* erp, Word* drp) noexcept
+    {
+        const Word Nr = (Ncr < 40 || Ncr > 120) ? decoder.nrp : Ncr;
+        decoder.nrp = Nr;
+
+        const Word brp = QLB[bcr & 3];
+
+        for (int k = 0; k < subframeSize; ++k)
+            drp[k] = add (erp[k], multR (brp, drp[k - Nr]));
+
+        for (int k = 0; k < 120; ++k)
+            drp[k - 120] = drp[k - 80];
+    }
+
+    // Deemphasis, then truncation to 13 bits and upscaling back to 16
+    void postprocess (Word* s) noexcept
+    {
+        Word msr = decoder.msr;
+
+        for (int k = 0; k < frameSize; ++k)
+        {
+            msr = add (s[k], multR (msr, 28180));
+            s[k] = static_cast<Word> (add (msr, msr) & 0xFFF8);
+        }
+
+        decoder.msr = msr;
+    }
+
+    //==============================================================================
+    EncoderState encoder;
+    DecoderState decoder;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (GSMFullRateCodec)
+};
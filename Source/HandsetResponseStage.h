@@ -0,0 +1,320 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "SharedAssetCache.h"
+
+//==============================================================================
+/**
+    The frequency response of each phone's microphone and earpiece speaker,
+    applied by convolution with their impulse responses. Runs in the
+    processor's telephone band (8kHz): the microphone at the caller's end,
+    before the codec, and the speaker at the listener's, last of all.
+
+    Measured responses are WAV or AIFF files in getImpulseResponseFolder(),
+    named after the phone and transducer (getImpulseResponseFileName()).
+    Where a phone has no measurement installed, a response modelled on its
+    transducer is used instead: the small driver's resonance, a presence
+    peak and the roll-off above it, built from biquads and normalised to
+    unity gain at 1kHz.
+
+    The convolution is juce::dsp::Convolution with non-uniform partitioning,
+    which adds no latency: the first headSize samples of the response are a
+    short FFT partition, the tail longer ones. All of it is FFT convolution,
+    the head included - nothing is direct-form - so every process() call
+    pays for at least a head-partition FFT, however few samples it brings.
+
+    Loading a response - reading or modelling it, and partitioning it -
+    happens on background threads shared by every stage in the process,
+    never on the audio thread; the responses themselves are shared through
+    SharedAssetCache. When the phone changes, the new responses are loaded
+    in the background and the convolution crossfades to them once they are
+    ready.
+
+    prepare() loads the current phone's responses before it returns, so
+    playback (and any offline render) starts with them in place.
+*/
+class HandsetResponseStage  : private juce::TimeSliceClient
+{
+public:
+    enum Transducer
+    {
+        microphone = 0,
+        speaker = 1
+    };
+
+    static constexpr double sampleRate = 8000.0;
+    static constexpr int numPhones = 3;             // Nokia, iPhone, Sony Ericsson (as TestAudioProcessor::PhoneType)
+
+    HandsetResponseStage() = default;
+
+    ~HandsetResponseStage() override
+    {
+        loader->removeTimeSliceClient (this);
+    }
+
+    //==============================================================================
+    // Where measured responses are installed
+    static juce::File getImpulseResponseFolder()
+    {
+       #if JUCE_MAC
+        return juce::File::getSpecialLocation (juce::File::userApplicationDataDirectory).getChildFile ("Application Support/Cellyz/Impulse Responses");
+       #else
+        return juce::File::getSpecialLocation (juce::File::userApplicationDataDirectory).getChildFile ("Cellyz/Impulse Responses");
+       #endif
+    }
+
+    // File name of a response, without its extension (.wav, .aif or .aiff), e.g. "Nokia Speaker"
+    static juce::String getImpulseResponseFileName (int phone, Transducer transducer)
+    {
+        static const char* const phoneNames[numPhones] = { "Nokia", "iPhone", "Sony Ericsson" };
+
+        if (! juce::isPositiveAndBelow (phone, numPhones))
+            return {};
+
+        return juce::String (phoneNames[phone]) + (transducer == microphone ? " Microphone" : " Speaker");
+    }
+
+    //==============================================================================
+    // maximumBlockSize is in 8kHz samples. Loads the phone's responses before returning.
+    void prepare (int newNumChannels, int maximumBlockSize, int phone)
+    {
+        // Stops the loader (waiting for a slice in progress) while the convolutions are prepared
+        loader->removeTimeSliceClient (this);
+
+        const juce::dsp::ProcessSpec spec { sampleRate, (juce::uint32) juce::jmax (1, maximumBlockSize),
+                                            (juce::uint32) juce::jlimit (1, 2, newNumChannels) };
+        numChannels = (int) spec.numChannels;
+
+        phone = juce::jlimit (0, numPhones - 1, phone);
+        requestedPhone.store (phone);
+        loadPhone (phone);
+
+        // Runs the loads just queued, so the responses are in place without a crossfade
+        microphoneConvolution.prepare (spec);
+        speakerConvolution.prepare (spec);
+
+        loader->addTimeSliceClient (this);
+    }
+
+    void release()
+    {
+        loader->removeTimeSliceClient (this);
+        loadedResponses = {};
+        loadedPhone = -1;
+    }
+
+    //==============================================================================
+    // Audio thread: the phone whose responses to play. A change is picked up by the loader.
+    void setPhone (int phone) noexcept
+    {
+        requestedPhone.store (juce::jlimit (0, numPhones - 1, phone), std::memory_order_relaxed);
+    }
+
+    // Runs numSamples of every channel (at 8kHz) through the transducer's response in place
+    void process (Transducer transducer, float* const* channels, int numChannelsToProcess, int numSamples) noexcept
+    {
+        jassert (numChannelsToProcess <= numChannels);
+
+        juce::dsp::AudioBlock<float> block (channels, (size_t) juce::jmin (numChannelsToProcess, numChannels), (size_t) numSamples);
+        juce::dsp::ProcessContextReplacing<float> context (block);
+
+        (transducer == microphone ? microphoneConvolution : speakerConvolution).process (context);
+    }
+
+    // How long the loaded microphone and speaker responses ring on between them, in seconds
+    double getTailLengthSeconds() const noexcept                { return tailSeconds.load (std::memory_order_relaxed); }
+
+private:
+    //==============================================================================
+    static constexpr int headSize = 64;                 // The first, shortest FFT partition (no latency)
+    static constexpr double maxResponseSeconds = 0.5;   // Measured responses are cut to this
+    static constexpr int modelLength = 256;             // 32ms
+    static constexpr int modelFadeLength = 64;
+
+    // One loader thread and convolution message queue for every stage in the process. Loads for
+    // the convolutions are queued from more than one thread (prepare() and the loader), one at a time.
+    struct Loader  : public juce::TimeSliceThread
+    {
+        Loader()  : juce::TimeSliceThread ("Cellyz impulse response loader")    { startThread (juce::Thread::Priority::low); }
+        ~Loader() override                                                      { stopThread (2000); }
+
+        juce::dsp::ConvolutionMessageQueue convolutionQueue;
+        juce::CriticalSection queueLock;
+    };
+
+    struct ImpulseResponse
+    {
+        juce::AudioBuffer<float> samples;               // Mono
+        double sampleRate = 0.0;
+    };
+
+    // The transducer models: a highpass at the driver's resonance, a presence peak and a lowpass
+    struct TransducerModel
+    {
+        float resonance, resonanceQ;
+        float presence, presenceQ, presenceGainDb;
+        float rollOff, rollOffQ;
+    };
+
+    //==============================================================================
+    // Loader thread: follows the selected phone
+    int useTimeSlice() override
+    {
+        const int phone = requestedPhone.load (std::memory_order_relaxed);
+
+        if (phone != loadedPhone)
+            loadPhone (phone);
+
+        return 50;
+    }
+
+    // Fetches both of the phone's responses and queues them for the convolutions
+    void loadPhone (int phone)
+    {
+        std::array<SharedAssetCache::Handle<ImpulseResponse>, 2> responses;
+        double responseSeconds = 0.0;
+
+        for (auto transducer : { microphone, speaker })
+        {
+            auto& response = responses[(size_t) transducer];
+            response = acquireMeasuredResponse (phone, transducer);
+
+            if (response == nullptr)
+                response = acquireModelledResponse (phone, transducer);
+
+            // The two run one after the other, so their tails add up
+            responseSeconds += response->samples.getNumSamples() / response->sampleRate;
+
+            // The convolution takes its own copy, and partitions it on the message queue's thread
+            juce::AudioBuffer<float> copy (response->samples);
+
+            const juce::ScopedLock sl (loader->queueLock);
+            (transducer == microphone ? microphoneConvolution : speakerConvolution)
+                .loadImpulseResponse (std::move (copy), response->sampleRate, juce::dsp::Convolution::Stereo::no,
+                                      juce::dsp::Convolution::Trim::no, juce::dsp::Convolution::Normalise::no);
+        }
+
+        // Holding on to the responses keeps them cached while this stage plays them
+        loadedResponses = responses;
+        loadedPhone = phone;
+        tailSeconds.store (responseSeconds, std::memory_order_relaxed);
+    }
+
+    static SharedAssetCache::Handle<ImpulseResponse> acquireMeasuredResponse (int phone, Transducer transducer)
+    {
+        for (auto* extension : { ".wav", ".aif", ".aiff" })
+        {
+            const auto file = getImpulseResponseFolder().getChildFile (getImpulseResponseFileName (phone, transducer) + extension);
+
+            if (! file.existsAsFile())
+                continue;
+
+            if (auto response = SharedAssetCache::acquire<ImpulseResponse> ("ir:" + file.getFullPathName(), [&file] { return readResponse (file); }))
+                return response;
+        }
+
+        return {};
+    }
+
+    static SharedAssetCache::Handle<ImpulseResponse> acquireModelledResponse (int phone, Transducer transducer)
+    {
+        return SharedAssetCache::acquire<ImpulseResponse> ("ir:model:" + getImpulseResponseFileName (phone, transducer),
+                                                           [=] { return modelResponse (phone, transducer); });
+    }
+
+    // Reads a measured response, mixed to mono
+    static std::unique_ptr<ImpulseResponse> readResponse (const juce::File& file)
+    {
+        juce::AudioFormatManager formats;
+        formats.registerBasicFormats();
+
+        std::unique_ptr<juce::AudioFormatReader> reader (formats.createReaderFor (file));
+
+        if (reader == nullptr || reader->lengthInSamples <= 0 || reader->sampleRate <= 0.0)
+            return {};
+
+        const int length = (int) juce::jmin (reader->lengthInSamples, (juce::int64) (reader->sampleRate * maxResponseSeconds));
+        const int numFileChannels = (int) juce::jmax (1u, reader->numChannels);
+
+        juce::AudioBuffer<float> fileSamples (numFileChannels, length);
+
+        if (! reader->read (&fileSamples, 0, length, 0, true, true))
+            return {};
+
+        auto response = std::make_unique<ImpulseResponse>();
+        response->sampleRate = reader->sampleRate;
+        response->samples.setSize (1, length);
+        response->samples.copyFrom (0, 0, fileSamples, 0, 0, length);
+
+        for (int channel = 1; channel < numFileChannels; ++channel)
+            response->samples.addFrom (0, 0, fileSamples, channel, 0, length);
+
+        response->samples.applyGain (1.0f / (float) numFileChannels);
+        return response;
+    }
+
+    // Rings an impulse through the transducer model
+    static std::unique_ptr<ImpulseResponse> modelResponse (int phone, Transducer transducer)
+    {
+        static constexpr TransducerModel models[numPhones][2] =
+        {
+            // Microphone                                                Speaker
+            { { 200.0f, 0.7f, 2500.0f, 1.2f, 3.0f, 3600.0f, 0.7f },     { 600.0f, 1.2f, 1800.0f, 1.5f, 6.0f, 3400.0f, 0.8f } },    // Nokia
+            { { 100.0f, 0.7f, 3000.0f, 1.0f, 2.0f, 3800.0f, 0.7f },     { 350.0f, 0.9f, 2200.0f, 1.2f, 3.0f, 3800.0f, 0.7f } },    // iPhone
+            { { 250.0f, 0.8f, 1500.0f, 1.0f, 2.0f, 3300.0f, 0.7f },     { 500.0f, 1.4f, 1200.0f, 1.4f, 5.0f, 3000.0f, 0.9f } }     // Sony Ericsson
+        };
+
+        const auto& model = models[phone][transducer];
+        using Coefficients = juce::dsp::IIR::Coefficients<float>;
+
+        const Coefficients::Ptr sections[] =
+        {
+            Coefficients::makeHighPass (sampleRate, model.resonance, model.resonanceQ),
+            Coefficients::makePeakFilter (sampleRate, model.presence, model.presenceQ, juce::Decibels::decibelsToGain (model.presenceGainDb)),
+            Coefficients::makeLowPass (sampleRate, model.rollOff, model.rollOffQ)
+        };
+
+        auto response = std::make_unique<ImpulseResponse>();
+        response->sampleRate = sampleRate;
+        response->samples.setSize (1, modelLength);
+        response->samples.clear();
+
+        auto* samples = response->samples.getWritePointer (0);
+        samples[0] = 1.0f;
+
+        double gainAt1kHz = 1.0;
+
+        for (auto& section : sections)
+        {
+            juce::dsp::IIR::Filter<float> filter (section);
+
+            for (int i = 0; i < modelLength; ++i)
+                samples[i] = filter.processSample (samples[i]);
+
+            gainAt1kHz *= section->getMagnitudeForFrequency (1000.0, sampleRate);
+        }
+
+        // The sections have rung down by the end; fade what's left so the cut is clean
+        for (int i = 0; i < modelFadeLength; ++i)
+            samples[modelLength - 1 - i] *= 0.5f - 0.5f * std::cos (juce::MathConstants<float>::pi * (float) i / (float) modelFadeLength);
+
+        response->samples.applyGain ((float) (1.0 / gainAt1kHz));
+        return response;
+    }
+
+    //==============================================================================
+    juce::SharedResourcePointer<Loader> loader;
+    int numChannels = 1;
+
+    juce::dsp::Convolution microphoneConvolution { juce::dsp::Convolution::NonUniform { headSize }, loader->convolutionQueue };
+    juce::dsp::Convolution speakerConvolution { juce::dsp::Convolution::NonUniform { headSize }, loader->convolutionQueue };
+
+    std::atomic<int> requestedPhone { 0 };      // Audio thread -> loader
+    std::atomic<double> tailSeconds { 0.0 };    // Loader -> any thread
+
+    // Loader thread only (and prepare(), while the loader is stopped)
+    int loadedPhone = -1;
+    std::array<SharedAssetCache::Handle<ImpulseResponse>, 2> loadedResponses;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (HandsetResponseStage)
+};
@@ -0,0 +1,423 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "NoiseEngine.h"
+
+//==============================================================================
+/**
+    Network jitter, and the adaptive jitter buffer a receiver uses to ride it
+    out. Runs in the processor's telephone band (8kHz), after the codec.
+
+    The incoming audio is cut into 20ms packets, and each is given a network
+    delay before it "arrives": a queue that fills with exponentially
+    distributed bursts of cross traffic and drains between them, plus the
+    occasional spike of a re-route. Packets arrive late, in clumps and now
+    and then out of order.
+
+    Arrived packets wait in the receiver's playout buffer, a fixed-capacity
+    lock-free ring (juce::AbstractFifo) that is played out a frame at a time.
+    The receiver tracks the delay packets arrive with and sets its playout
+    delay to cover nearly all of them (mean plus four times the mean
+    deviation). It moves toward that target on frame boundaries by time
+    scaling the frame about to play, WSOLA style: the pitch-period lag at
+    which the audio best matches itself is found by normalised correlation,
+    and one period is crossfaded out (accelerate) or repeated (expand). When
+    a frame isn't there at its playout time the receiver waits, and if a
+    later packet has already arrived it gives the missing one up; either
+    way that frame is reported late (getFramesLate()) for the packet loss
+    stage to conceal.
+
+    Packetising the audio delays it by one frame, which is the stage's fixed
+    delay (getLatencySamples()); the playout delay comes on top of that and
+    wanders with the jitter, as it does on a real call. It never passes
+    getMaxPlayoutDelaySamples(), which is therefore the stage's tail.
+
+    All buffers are sized by prepare(); process() never allocates.
+*/
+class JitterBufferStage
+{
+public:
+    static constexpr double sampleRate = 8000.0;
+    static constexpr int frameSize = 160;                   // 20ms
+
+    JitterBufferStage() = default;
+
+    //==============================================================================
+    // maximumBlockSize is in 8kHz samples
+    void prepare (int newNumChannels, int maximumBlockSize)
+    {
+        numChannels = juce::jmax (1, newNumChannels);
+
+        outgoingFrames.setSize (numChannels, frameSize);
+        packets.setSize (numChannels, numPacketSlots * frameSize);
+        playoutBuffer.setSize (numChannels, playoutCapacity);
+        playoutFifo.setTotalSize (playoutCapacity);
+        window.setSize (numChannels, frameSize + maxPitch);
+        playoutFrames.setSize (numChannels, frameSize);
+
+        maxFramesPerBlock = juce::jmax (1, maximumBlockSize) / frameSize + 2;
+        framesLate.allocate ((size_t) maxFramesPerBlock, true);
+
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        outgoingFrames.clear();
+        packets.clear();
+        playoutBuffer.clear();
+        playoutFrames.clear();
+        playoutFifo.reset();
+
+        for (auto& slot : slots)
+            slot = {};
+
+        // The call starts with a frame of silence already buffered, so playout never waits for the first packet
+        playoutFifo.finishedWrite (frameSize);
+
+        now = 0;
+        framePosition = 0;
+        nextSequence = 0;
+        nextPlayoutSequence = 0;
+        playoutDelay = 0;
+        networkQueue = 0.0f;
+        meanDelay = delayDeviation = 0.0f;
+        numFramesStarted = 0;
+    }
+
+    // Fixed delay of the stage (packetising one frame), in 8kHz samples
+    int getLatencySamples() const noexcept                      { return frameSize; }
+
+    // Mean extra network delay per packet, in milliseconds
+    void setJitter (float newJitterMs) noexcept                 { meanJitter = juce::jmax (0.0f, newJitterMs) * (float) sampleRate * 0.001f; }
+
+    // How far playout currently runs behind the fixed delay, in 8kHz samples
+    int getPlayoutDelaySamples() const noexcept                 { return playoutDelay; }
+
+    // The furthest the playout delay goes, in 8kHz samples: how long the stage can ring on after its input stops
+    static constexpr int getMaxPlayoutDelaySamples() noexcept   { return maxPlayoutDelay; }
+
+    // One flag per frame started by the last process() call, in order: true if that frame's
+    // audio wasn't there in time (the frame played out silent)
+    const bool* getFramesLate() const noexcept                  { return framesLate.get(); }
+    int getNumFramesStarted() const noexcept                    { return numFramesStarted; }
+
+    //==============================================================================
+    // Runs numSamples of every channel (at 8kHz) through the network and jitter buffer in place
+    void process (float* const* channels, int numChannelsToProcess, int numSamples, NoiseGenerator& noise) noexcept
+    {
+        jassert (numChannelsToProcess <= numChannels);
+        numChannelsToProcess = juce::jmin (numChannelsToProcess, numChannels);
+        numFramesStarted = 0;
+
+        for (int start = 0; start < numSamples;)
+        {
+            if (framePosition == 0)
+                startPlayoutFrame (numChannelsToProcess);
+
+            const int numThisTime = juce::jmin (numSamples - start, frameSize - framePosition);
+
+            for (int channel = 0; channel < numChannelsToProcess; ++channel)
+            {
+                auto* data = channels[channel] + start;
+
+                juce::FloatVectorOperations::copy (outgoingFrames.getWritePointer (channel, framePosition), data, numThisTime);
+                juce::FloatVectorOperations::copy (data, playoutFrames.getReadPointer (channel, framePosition), numThisTime);
+            }
+
+            start += numThisTime;
+            framePosition += numThisTime;
+            now += numThisTime;
+
+            if (framePosition == frameSize)
+            {
+                sendPacket (numChannelsToProcess, noise);
+                framePosition = 0;
+            }
+        }
+    }
+
+private:
+    //==============================================================================
+    static constexpr int minPitch = 40;                             // 200Hz
+    static constexpr int maxPitch = 120;                            // 66Hz
+    static constexpr int maxExpandPitch = frameSize / 2;            // A repeated period must fit in the frame
+    static constexpr int maxNetworkDelay = 250 * 8;                 // 250ms
+    static constexpr int maxPlayoutDelay = 250 * 8;
+    static constexpr int numPacketSlots = maxNetworkDelay / frameSize + 4;
+    static constexpr int playoutCapacity = maxPlayoutDelay + (numPacketSlots + 2) * frameSize;
+    static constexpr float delayAveraging = 0.95f;                  // Per packet
+
+    struct PacketSlot
+    {
+        int sequence = -1;                  // -1 while the slot is free
+        juce::int64 arrivalTime = 0;        // In samples since the last reset
+        bool arrived = false;               // Seen by the receiver (its delay has been measured)
+    };
+
+    enum Playout
+    {
+        normal,
+        accelerate,                         // One pitch period shorter
+        expand                              // One pitch period longer
+    };
+
+    //==============================================================================
+    // A frame of input leaves as a packet, and is given the delay it will arrive with
+    void sendPacket (int numChannelsToProcess, NoiseGenerator& noise) noexcept
+    {
+        int delay = 0;
+
+        if (meanJitter > 0.0f)
+        {
+            // Cross traffic joins the queue in exponentially distributed bursts and drains between them
+            const float burst = -meanJitter * std::log (1.0f - noise.nextFloat() * 0.999f);
+            networkQueue = 0.6f * networkQueue + 0.4f * burst;
+
+            if (noise.nextFloat() < 0.02f)
+                networkQueue += 4.0f * meanJitter;      // Re-routed
+
+            networkQueue = juce::jmin (networkQueue, (float) maxNetworkDelay);
+            delay = static_cast<int> (networkQueue);
+        }
+        else
+        {
+            networkQueue = 0.0f;
+        }
+
+        const int slotIndex = nextSequence % numPacketSlots;
+        auto& slot = slots[(size_t) slotIndex];
+        slot.sequence = nextSequence++;
+        slot.arrivalTime = now + delay;
+        slot.arrived = false;
+
+        for (int channel = 0; channel < numChannelsToProcess; ++channel)
+            juce::FloatVectorOperations::copy (packets.getWritePointer (channel, slotIndex * frameSize),
+                                               outgoingFrames.getReadPointer (channel), frameSize);
+    }
+
+    // Measures every packet that has arrived, and moves the ones next in line into the playout buffer
+    void receivePackets (int numChannelsToProcess) noexcept
+    {
+        for (auto& slot : slots)
+        {
+            if (slot.sequence < 0 || slot.arrived || slot.arrivalTime > now)
+                continue;
+
+            slot.arrived = true;
+
+            const float delay = (float) networkDelayOf (slot);
+            delayDeviation = delayAveraging * delayDeviation + (1.0f - delayAveraging) * std::abs (delay - meanDelay);
+            meanDelay = delayAveraging * meanDelay + (1.0f - delayAveraging) * delay;
+
+            // Too late: its frame has already been given up
+            if (slot.sequence < nextPlayoutSequence)
+                slot.sequence = -1;
+        }
+
+        for (;;)
+        {
+            const int slotIndex = nextPlayoutSequence % numPacketSlots;
+            auto& slot = slots[(size_t) slotIndex];
+
+            if (slot.sequence != nextPlayoutSequence || ! slot.arrived || playoutFifo.getFreeSpace() < frameSize)
+                break;
+
+            int start1, size1, start2, size2;
+            playoutFifo.prepareToWrite (frameSize, start1, size1, start2, size2);
+
+            for (int channel = 0; channel < numChannelsToProcess; ++channel)
+            {
+                const auto* packet = packets.getReadPointer (channel, slotIndex * frameSize);
+                juce::FloatVectorOperations::copy (playoutBuffer.getWritePointer (channel, start1), packet, size1);
+                juce::FloatVectorOperations::copy (playoutBuffer.getWritePointer (channel, start2), packet + size1, size2);
+            }
+
+            playoutFifo.finishedWrite (size1 + size2);
+            slot.sequence = -1;
+            ++nextPlayoutSequence;
+        }
+    }
+
+    // Network delay of a packet: how long after its frame was complete it arrived
+    int networkDelayOf (const PacketSlot& slot) const noexcept
+    {
+        return static_cast<int> (slot.arrivalTime - (juce::int64) (slot.sequence + 1) * frameSize);
+    }
+
+    bool isLaterPacketWaiting() const noexcept
+    {
+        for (const auto& slot : slots)
+            if (slot.sequence > nextPlayoutSequence && slot.arrived)
+                return true;
+
+        return false;
+    }
+
+    //==============================================================================
+    // Decides how the next frame plays out, and renders it into playoutFrames
+    void startPlayoutFrame (int numChannelsToProcess) noexcept
+    {
+        receivePackets (numChannelsToProcess);
+
+        const int numReady = playoutFifo.getNumReady();
+        bool late = false;
+
+        if (numReady < frameSize)
+        {
+            late = true;
+
+            if (isLaterPacketWaiting() || playoutDelay >= maxPlayoutDelay)
+            {
+                // Give the missing packet up, and the part of a frame before it that
+                // would otherwise be spliced straight onto the frame after it. Playout
+                // stays on schedule.
+                playoutFifo.finishedRead (numReady);
+                playoutDelay -= numReady;
+                ++nextPlayoutSequence;
+                receivePackets (numChannelsToProcess);
+            }
+            else
+            {
+                // Wait for it; playout slips a frame behind
+                playoutDelay += frameSize;
+            }
+
+            playoutFrames.clear();
+        }
+        else
+        {
+            const int target = juce::jlimit (0, maxPlayoutDelay, juce::roundToInt (meanDelay + 4.0f * delayDeviation));
+
+            if (playoutDelay > target + frameSize / 2 && numReady >= frameSize + maxPitch)
+                playoutDelay -= renderPlayoutFrame (numChannelsToProcess, accelerate);
+            else if (playoutDelay + frameSize / 2 < target && numReady >= 2 * maxExpandPitch)
+                playoutDelay += renderPlayoutFrame (numChannelsToProcess, expand);
+            else
+                renderPlayoutFrame (numChannelsToProcess, normal);
+        }
+
+        if (numFramesStarted < maxFramesPerBlock)
+            framesLate[numFramesStarted++] = late;
+    }
+
+    // Reads the next frame's worth of buffered audio, time scaled by one pitch period if asked,
+    // and returns by how many samples playout moved (the lag, or 0)
+    int renderPlayoutFrame (int numChannelsToProcess, Playout playout) noexcept
+    {
+        const int numToRead = juce::jmin (playoutFifo.getNumReady(), window.getNumSamples());
+        int start1, size1, start2, size2;
+        playoutFifo.prepareToRead (numToRead, start1, size1, start2, size2);
+
+        for (int channel = 0; channel < numChannelsToProcess; ++channel)
+        {
+            auto* samples = window.getWritePointer (channel);
+            juce::FloatVectorOperations::copy (samples, playoutBuffer.getReadPointer (channel, start1), size1);
+            juce::FloatVectorOperations::copy (samples + size1, playoutBuffer.getReadPointer (channel, start2), size2);
+        }
+
+        int lag = 0, numConsumed = frameSize;
+
+        if (playout == accelerate)
+        {
+            lag = findSimilarityLag (window.getReadPointer (0), maxPitch);
+            numConsumed = frameSize + lag;
+        }
+        else if (playout == expand)
+        {
+            lag = findSimilarityLag (window.getReadPointer (0), maxExpandPitch);
+            numConsumed = frameSize - lag;
+        }
+
+        for (int channel = 0; channel < numChannelsToProcess; ++channel)
+        {
+            const auto* x = window.getReadPointer (channel);
+            auto* y = playoutFrames.getWritePointer (channel);
+
+            if (playout == accelerate)
+            {
+                // Crossfade from the frame's start into the same point one period on, skipping that period
+                for (int i = 0; i < lag; ++i)
+                    y[i] = x[i] + (i + 1) / (float) (lag + 1) * (x[i + lag] - x[i]);
+
+                juce::FloatVectorOperations::copy (y + lag, x + 2 * lag, frameSize - lag);
+            }
+            else if (playout == expand)
+            {
+                // Play the first period, crossfade back to its start, and carry on from there
+                juce::FloatVectorOperations::copy (y, x, lag);
+
+                for (int i = 0; i < lag; ++i)
+                    y[lag + i] = x[lag + i] + (i + 1) / (float) (lag + 1) * (x[i] - x[lag + i]);
+
+                juce::FloatVectorOperations::copy (y + 2 * lag, x + lag, frameSize - 2 * lag);
+            }
+            else
+            {
+                juce::FloatVectorOperations::copy (y, x, frameSize);
+            }
+        }
+
+        playoutFifo.finishedRead (numConsumed);
+        return lag;
+    }
+
+    // The lag at which the audio best resembles itself one lag later (normalised
+    // cross-correlation of the first lag samples). The first channel picks it for all.
+    static int findSimilarityLag (const float* samples, int longestLag) noexcept
+    {
+        int bestLag = minPitch;
+        float bestScore = -1.0f;
+
+        for (int lag = minPitch; lag <= longestLag; ++lag)
+        {
+            float correlation = 0.0f, energy1 = 0.0f, energy2 = 0.0f;
+
+            for (int i = 0; i < lag; ++i)
+            {
+                correlation += samples[i] * samples[i + lag];
+                energy1 += samples[i] * samples[i];
+                energy2 += samples[i + lag] * samples[i + lag];
+            }
+
+            const float score = correlation / std::sqrt (energy1 * energy2 + 1.0e-12f);
+
+            if (score > bestScore)
+            {
+                bestScore = score;
+                bestLag = lag;
+            }
+        }
+
+        return bestLag;
+    }
+
+    //==============================================================================
+    int numChannels = 1;
+    float meanJitter = 0.0f;                    // In samples
+
+    // Sender and network
+    juce::AudioBuffer<float> outgoingFrames;    // The frame being packetised, per channel
+    juce::AudioBuffer<float> packets;           // Packet audio in flight, numPacketSlots frames per channel
+    std::array<PacketSlot, numPacketSlots> slots;
+    float networkQueue = 0.0f;                  // In samples
+    int nextSequence = 0;
+
+    // Receiver
+    juce::AbstractFifo playoutFifo { playoutCapacity };
+    juce::AudioBuffer<float> playoutBuffer;     // Storage behind playoutFifo
+    juce::AudioBuffer<float> window;            // The buffered audio the next frame is rendered from
+    juce::AudioBuffer<float> playoutFrames;     // The frame playing out
+    int nextPlayoutSequence = 0;
+    int playoutDelay = 0;                       // In samples
+    float meanDelay = 0.0f, delayDeviation = 0.0f;
+
+    juce::int64 now = 0;
+    int framePosition = 0;
+
+    juce::HeapBlock<bool> framesLate;
+    int maxFramesPerBlock = 0;
+    int numFramesStarted = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (JitterBufferStage)
+};
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Per-channel peak and RMS levels of a signal, with meter ballistics, for
+    the GUI's meters.
+
+    Each measure() call takes the block's peak and mean square per channel:
+    the peak with FloatVectorOperations::findMinAndMax, the sum of squares
+    on juce::dsp::SIMDRegister lanes. The block values then go through the
+    ballistics, which are time based, so the readings don't depend on the
+    block size:
+
+    - the peak rises instantly and falls back 20dB in 1.7s, like a PPM;
+    - the RMS integrates the mean square with a 300ms time constant, like
+      a VU meter.
+
+    Levels are linear gains (1.0 = full scale). Audio thread only; the
+    readings are handed to the GUI as a plain Levels value.
+*/
+class LevelMeter
+{
+public:
+    static constexpr int maxChannels = 2;
+
+    struct Levels
+    {
+        std::array<float, maxChannels> peak {};
+        std::array<float, maxChannels> rms {};
+
+        float getPeak() const noexcept      { return juce::jmax (peak[0], peak[1]); }
+        float getRMS() const noexcept       { return juce::jmax (rms[0], rms[1]); }
+    };
+
+    LevelMeter() = default;
+
+    //==============================================================================
+    void prepare (double sampleRate) noexcept
+    {
+        peakFallPerSample = (float) (std::log (juce::Decibels::decibelsToGain (-peakFallDb)) / (peakFallSeconds * sampleRate));
+        rmsSamplesPerTimeConstant = (float) (rmsTimeConstant * sampleRate);
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        levels = {};
+        meanSquare = {};
+    }
+
+    //==============================================================================
+    // Measures numSamples of each channel (channels past maxChannels are ignored)
+    void measure (const float* const* channels, int numChannels, int numSamples) noexcept
+    {
+        if (numSamples <= 0)
+            return;
+
+        const float peakFall = std::exp (peakFallPerSample * (float) numSamples);
+        const float rmsSmoothing = 1.0f - std::exp (-(float) numSamples / rmsSamplesPerTimeConstant);
+
+        for (int channel = 0; channel < juce::jmin (numChannels, maxChannels); ++channel)
+        {
+            const auto* data = channels[channel];
+            const auto range = juce::FloatVectorOperations::findMinAndMax (data, numSamples);
+            const float blockPeak = juce::jmax (-range.getStart(), range.getEnd());
+            const float blockMeanSquare = getSumOfSquares (data, numSamples) / (float) numSamples;
+
+            auto& peak = levels.peak[(size_t) channel];
+            peak = juce::jmax (blockPeak, peak * peakFall);
+
+            auto& smoothed = meanSquare[(size_t) channel];
+            smoothed += (blockMeanSquare - smoothed) * rmsSmoothing;
+            levels.rms[(size_t) channel] = std::sqrt (smoothed);
+        }
+    }
+
+    const Levels& getLevels() const noexcept    { return levels; }
+
+private:
+    //==============================================================================
+    using Vec = juce::dsp::SIMDRegister<float>;
+    static constexpr int vecSize = (int) Vec::SIMDNumElements;
+
+    static constexpr double peakFallDb = 20.0;
+    static constexpr double peakFallSeconds = 1.7;
+    static constexpr double rmsTimeConstant = 0.3;
+
+    static float getSumOfSquares (const float* data, int numSamples) noexcept
+    {
+        auto sums = Vec::expand (0.0f);
+        int i = 0;
+
+        for (; i + vecSize <= numSamples; i += vecSize)
+        {
+            alignas (Vec::SIMDRegisterSize) float lanes[vecSize];
+            std::memcpy (lanes, data + i, sizeof (lanes));
+            const auto x = Vec::fromRawArray (lanes);
+            sums += x * x;
+        }
+
+        float sum = sums.sum();
+
+        for (; i < numSamples; ++i)
+            sum += data[i] * data[i];
+
+        return sum;
+    }
+
+    //==============================================================================
+    float peakFallPerSample = 0.0f;
+    float rmsSamplesPerTimeConstant = 1.0f;
+
+    Levels levels;
+    std::array<float, maxChannels> meanSquare {};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LevelMeter)
+};
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "PolyphaseResampler.h"
+
+//==============================================================================
+/**
+    Takes host-rate audio down to the telephone rate and back, so the stages
+    between can run at the rate a phone line actually has - band limited the
+    way the network band limits it, and doing a fraction of the work per host
+    sample. The processor always runs it at 8kHz (CodecStage::sampleRate),
+    the only rate the codec, jitter and packet loss stages are written for.
+
+    downsample() decimates a host block through a polyphase anti-aliasing
+    filter per channel and returns how many telephone-rate samples came out
+    (it varies by a sample from block to block unless the rates divide).
+    upsample() interpolates them back onto a host-rate queue and reads
+    exactly one host block off it. The queue starts a little ahead, so it
+    never runs dry whatever the block size; that, the two filters and any
+    fixed delay of the telephone-rate stages (given to prepare()) make up
+    getLatencySamples(). downsample() also hands back the input delayed by
+    that same amount, for a wet/dry mix that stays lined up.
+
+    All buffers are sized by prepare(); neither call allocates.
+*/
+class NarrowbandResampler
+{
+public:
+    NarrowbandResampler() = default;
+
+    //==============================================================================
+    // narrowbandLatency is the fixed delay, in telephone-rate samples, of whatever
+    // runs between downsample() and upsample()
+    void prepare (double newHostRate, double newNarrowbandRate, int newNumChannels, int maximumBlockSize, int narrowbandLatency)
+    {
+        hostRate = newHostRate;
+        narrowbandRate = newNarrowbandRate;
+        numChannels = juce::jmax (1, newNumChannels);
+        maximumBlockSize = juce::jmax (1, maximumBlockSize);
+
+        downsamplers.clear();
+        upsamplers.clear();
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            downsamplers.add (new PolyphaseResampler())->prepare (hostRate, narrowbandRate);
+            upsamplers.add (new PolyphaseResampler())->prepare (narrowbandRate, hostRate);
+        }
+
+        const double hostSamplesPerNarrowband = hostRate / narrowbandRate;
+
+        // Interpolated samples arrive up to one telephone-rate sample (plus rounding) after
+        // the host samples they stand for, so the queue starts that far ahead
+        primingSamples = static_cast<int> (std::ceil (hostSamplesPerNarrowband)) + 2;
+
+        latencySamples = juce::roundToInt (primingSamples + downsamplers[0]->getGroupDelay()
+                                           + (upsamplers[0]->getGroupDelay() + narrowbandLatency) * hostSamplesPerNarrowband);
+
+        maxNarrowbandSamples = downsamplers[0]->getMaxOutputSamples (maximumBlockSize);
+        hostQueue.setSize (numChannels, primingSamples + maximumBlockSize + upsamplers[0]->getMaxOutputSamples (maxNarrowbandSamples));
+        dryDelay.setSize (numChannels, juce::jmax (1, latencySamples));
+
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        for (int channel = 0; channel < downsamplers.size(); ++channel)
+        {
+            downsamplers[channel]->reset();
+            upsamplers[channel]->reset();
+        }
+
+        hostQueue.clear();
+        dryDelay.clear();
+
+        numQueued = primingSamples;
+        dryPosition = 0;
+    }
+
+    // Fixed delay from downsample() input to upsample() output, in host samples
+    int getLatencySamples() const noexcept          { return latencySamples; }
+
+    // Most telephone-rate samples one host block can turn into
+    int getMaxNarrowbandSamples() const noexcept    { return maxNarrowbandSamples; }
+
+    //==============================================================================
+    // Decimates numSamples of every channel into narrowband and returns how many samples
+    // each channel received. If delayedInput is given, each of its channels receives the
+    // input delayed by getLatencySamples().
+    int downsample (const float* const* input, float* const* delayedInput, int numChannelsToProcess, int numSamples,
+                    float* const* narrowband) noexcept
+    {
+        jassert (numChannelsToProcess <= numChannels);
+        numChannelsToProcess = juce::jmin (numChannelsToProcess, numChannels);
+
+        if (delayedInput != nullptr)
+            delayInput (input, delayedInput, numChannelsToProcess, numSamples);
+
+        // Every channel's resampler is in the same state, so they agree on the count
+        int numNarrowband = 0;
+
+        for (int channel = 0; channel < numChannelsToProcess; ++channel)
+            numNarrowband = downsamplers[channel]->process (input[channel], numSamples, narrowband[channel]);
+
+        return numNarrowband;
+    }
+
+    // Interpolates numNarrowband samples of every channel and writes the next numSamples
+    // host-rate samples to output
+    void upsample (const float* const* narrowband, int numNarrowband, float* const* output, int numChannelsToProcess,
+                   int numSamples) noexcept
+    {
+        jassert (numChannelsToProcess <= numChannels);
+        numChannelsToProcess = juce::jmin (numChannelsToProcess, numChannels);
+
+        int numInterpolated = 0;
+
+        for (int channel = 0; channel < numChannelsToProcess; ++channel)
+            numInterpolated = upsamplers[channel]->process (narrowband[channel], numNarrowband,
+                                                            hostQueue.getWritePointer (channel, numQueued));
+
+        numQueued += numInterpolated;
+        jassert (numQueued <= hostQueue.getNumSamples());
+        jassert (numQueued >= numSamples);
+
+        const int numReady = juce::jmin (numQueued, numSamples);
+
+        for (int channel = 0; channel < numChannelsToProcess; ++channel)
+        {
+            auto* queue = hostQueue.getWritePointer (channel);
+
+            juce::FloatVectorOperations::copy (output[channel], queue, numReady);
+            juce::FloatVectorOperations::clear (output[channel] + numReady, numSamples - numReady);
+            std::memmove (queue, queue + numReady, sizeof (float) * (size_t) (numQueued - numReady));
+        }
+
+        numQueued -= numReady;
+    }
+
+private:
+    //==============================================================================
+    // The dry signal through a delay line as long as the total latency
+    void delayInput (const float* const* input, float* const* output, int numChannelsToProcess, int numSamples) noexcept
+    {
+        const int delayLength = dryDelay.getNumSamples();
+
+        for (int start = 0; start < numSamples;)
+        {
+            const int numThisTime = juce::jmin (numSamples - start, delayLength - dryPosition);
+
+            for (int channel = 0; channel < numChannelsToProcess; ++channel)
+            {
+                auto* line = dryDelay.getWritePointer (channel, dryPosition);
+                juce::FloatVectorOperations::copy (output[channel] + start, line, numThisTime);
+                juce::FloatVectorOperations::copy (line, input[channel] + start, numThisTime);
+            }
+
+            start += numThisTime;
+            dryPosition = (dryPosition + numThisTime) % delayLength;
+        }
+    }
+
+    //==============================================================================
+    double hostRate = 44100.0, narrowbandRate = 8000.0;
+    int numChannels = 1;
+    int primingSamples = 0;
+    int latencySamples = 0;
+    int maxNarrowbandSamples = 0;
+
+    juce::OwnedArray<PolyphaseResampler> downsamplers, upsamplers;
+
+    juce::AudioBuffer<float> hostQueue;     // Interpolated audio waiting to be output
+    int numQueued = 0;
+
+    juce::AudioBuffer<float> dryDelay;
+    int dryPosition = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (NarrowbandResampler)
+};
@@ -0,0 +1,224 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Fast block noise generator: eight xoshiro128+ generators run side by side.
+
+    Each step advances all eight lanes at once with SSE2/NEON integer ops (two
+    4-lane registers, a plain loop elsewhere) and turns the top 24 bits of each
+    lane into a float, so whole blocks of uniform or Gaussian noise come out
+    with no division and no per-sample call, unlike juce::Random.
+    nextFloat() serves single values for the scalar code paths from a cached
+    step.
+
+    Streams are fully determined by their seed.
+*/
+class NoiseGenerator
+{
+public:
+    static constexpr int numLanes = 8;
+
+    NoiseGenerator() { seed (0); }
+
+    //==============================================================================
+    // Expands a 64-bit seed into all lane states with splitmix64 (never all-zero)
+    void seed (juce::uint64 seedValue) noexcept
+    {
+        auto splitMix = seedValue;
+
+        for (int lane = 0; lane < numLanes; ++lane)
+        {
+            const auto a = splitMix64 (splitMix);
+            const auto b = splitMix64 (splitMix);
+
+            s0[lane] = static_cast<juce::uint32> (a);
+            s1[lane] = static_cast<juce::uint32> (a >> 32);
+            s2[lane] = static_cast<juce::uint32> (b);
+            s3[lane] = static_cast<juce::uint32> (b >> 32) | 1u;
+        }
+
+        cachePosition = numLanes;
+    }
+
+    //==============================================================================
+    // Uniform in [0, 1)
+    void fillUniform (float* destination, int numSamples) noexcept
+    {
+        int start = 0;
+
+        for (; start + numLanes <= numSamples; start += numLanes)
+            step (destination + start);
+
+        if (start < numSamples)
+        {
+            float chunk[numLanes];
+            step (chunk);
+            std::memcpy (destination + start, chunk, sizeof (float) * (size_t) (numSamples - start));
+        }
+    }
+
+    // Uniform in [-amplitude, amplitude)
+    void fillBipolar (float* destination, int numSamples, float amplitude = 1.0f) noexcept
+    {
+        fillUniform (destination, numSamples);
+
+        const float scale = 2.0f * amplitude;
+
+        for (int i = 0; i < numSamples; ++i)
+            destination[i] = destination[i] * scale - amplitude;
+    }
+
+    // Approximately Gaussian (Irwin-Hall sum of four uniforms), zero mean, bounded at +/-3.46 sigma
+    void fillGaussian (float* destination, int numSamples, float standardDeviation = 1.0f) noexcept
+    {
+        constexpr int chunkSize = 64;
+        float u1[chunkSize], u2[chunkSize], u3[chunkSize], u4[chunkSize];
+        const float scale = standardDeviation * 1.7320508f; // sqrt (12 / 4)
+
+        for (int start = 0; start < numSamples; start += chunkSize)
+        {
+            const int numThisTime = juce::jmin (chunkSize, numSamples - start);
+            fillUniform (u1, numThisTime);
+            fillUniform (u2, numThisTime);
+            fillUniform (u3, numThisTime);
+            fillUniform (u4, numThisTime);
+
+            for (int i = 0; i < numThisTime; ++i)
+                destination[start + i] = ((u1[i] + u2[i]) + (u3[i] + u4[i]) - 2.0f) * scale;
+        }
+    }
+
+    // Single value in [0, 1) for per-sample code; a drop-in for juce::Random::nextFloat
+    float nextFloat() noexcept
+    {
+        if (cachePosition == numLanes)
+        {
+            step (cache);
+            cachePosition = 0;
+        }
+
+        return cache[cachePosition++];
+    }
+
+private:
+    //==============================================================================
+    static juce::uint64 splitMix64 (juce::uint64& state) noexcept
+    {
+        auto z = (state += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+
+    // One xoshiro128+ step of all lanes; the top 24 bits of each result become a float in [0, 1).
+    // The compiler can't vectorise this on its own (the lane state is a loop-carried recurrence),
+    // hence the explicit 4-lane registers.
+    void step (float* output) noexcept
+    {
+        constexpr float toUnit = 1.0f / 16777216.0f;
+
+       #if JUCE_USE_SIMD && (defined (__i386__) || defined (__amd64__) || defined (_M_X64) || defined (_X86_) || defined (_M_IX86))
+        for (int half = 0; half < numLanes; half += 4)
+        {
+            auto a = _mm_load_si128 (reinterpret_cast<const __m128i*> (s0 + half));
+            auto b = _mm_load_si128 (reinterpret_cast<const __m128i*> (s1 + half));
+            auto c = _mm_load_si128 (reinterpret_cast<const __m128i*> (s2 + half));
+            auto d = _mm_load_si128 (reinterpret_cast<const __m128i*> (s3 + half));
+
+            const auto result = _mm_add_epi32 (a, d);
+            const auto t = _mm_slli_epi32 (b, 9);
+            c = _mm_xor_si128 (c, a);
+            d = _mm_xor_si128 (d, b);
+            b = _mm_xor_si128 (b, c);
+            a = _mm_xor_si128 (a, d);
+            c = _mm_xor_si128 (c, t);
+            d = _mm_or_si128 (_mm_slli_epi32 (d, 11), _mm_srli_epi32 (d, 21));
+
+            _mm_store_si128 (reinterpret_cast<__m128i*> (s0 + half), a);
+            _mm_store_si128 (reinterpret_cast<__m128i*> (s1 + half), b);
+            _mm_store_si128 (reinterpret_cast<__m128i*> (s2 + half), c);
+            _mm_store_si128 (reinterpret_cast<__m128i*> (s3 + half), d);
+
+            _mm_storeu_ps (output + half, _mm_mul_ps (_mm_cvtepi32_ps (_mm_srli_epi32 (result, 8)), _mm_set1_ps (toUnit)));
+        }
+       #elif JUCE_USE_SIMD && (defined (__ARM_NEON__) || defined (__ARM_NEON) || defined (__arm64__) || defined (__aarch64__))
+        for (int half = 0; half < numLanes; half += 4)
+        {
+            auto a = vld1q_u32 (s0 + half);
+            auto b = vld1q_u32 (s1 + half);
+            auto c = vld1q_u32 (s2 + half);
+            auto d = vld1q_u32 (s3 + half);
+
+            const auto result = vaddq_u32 (a, d);
+            const auto t = vshlq_n_u32 (b, 9);
+            c = veorq_u32 (c, a);
+            d = veorq_u32 (d, b);
+            b = veorq_u32 (b, c);
+            a = veorq_u32 (a, d);
+            c = veorq_u32 (c, t);
+            d = vorrq_u32 (vshlq_n_u32 (d, 11), vshrq_n_u32 (d, 21));
+
+            vst1q_u32 (s0 + half, a);
+            vst1q_u32 (s1 + half, b);
+            vst1q_u32 (s2 + half, c);
+            vst1q_u32 (s3 + half, d);
+
+            vst1q_f32 (output + half, vmulq_n_f32 (vcvtq_f32_u32 (vshrq_n_u32 (result, 8)), toUnit));
+        }
+       #else
+        for (int lane = 0; lane < numLanes; ++lane)
+        {
+            const juce::uint32 result = s0[lane] + s3[lane];
+            const juce::uint32 t = s1[lane] << 9;
+
+            s2[lane] ^= s0[lane];
+            s3[lane] ^= s1[lane];
+            s1[lane] ^= s2[lane];
+            s0[lane] ^= s3[lane];
+            s2[lane] ^= t;
+            s3[lane] = (s3[lane] << 11) | (s3[lane] >> 21);
+
+            output[lane] = static_cast<float> (result >> 8) * toUnit;
+        }
+       #endif
+    }
+
+    //==============================================================================
+    alignas (16) juce::uint32 s0[numLanes], s1[numLanes], s2[numLanes], s3[numLanes];
+    float cache[numLanes];
+    int cachePosition = numLanes;
+};
+
+//==============================================================================
+/**
+    One independent NoiseGenerator stream per processing stage.
+
+    Giving every stage its own stream means that switching one stage on or off
+    doesn't shift the noise any other stage hears, and a render with a fixed
+    seed comes out identical each time. All streams derive from one 64-bit
+    seed through splitmix64.
+*/
+struct NoiseEngine
+{
+    void seed (juce::uint64 masterSeed) noexcept
+    {
+        juce::uint64 streamSeed = masterSeed;
+
+        for (auto* stream : { &distortion, &tonalColor, &interference, &tv, &codec, &network, &signalQuality, &ambience })
+        {
+            streamSeed = streamSeed * 6364136223846793005ull + 1442695040888963407ull;
+            stream->seed (streamSeed);
+        }
+    }
+
+    NoiseGenerator distortion;      // Nokia quantization noise
+    NoiseGenerator tonalColor;      // Analog flutter
+    NoiseGenerator interference;    // Interference knob: quantization noise
+    NoiseGenerator tv;              // TV static and pops
+    NoiseGenerator codec;           // Codec artifacts
+    NoiseGenerator network;         // Packet loss / jitter decisions
+    NoiseGenerator signalQuality;   // Signal strength and dropout dynamics
+    NoiseGenerator ambience;        // Background ambience
+};
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    A handful of sine oscillators with phase that carries over between blocks.
+
+    Each oscillator keeps its phase in cycles as a wrapped double, so it never
+    loses precision however long the session runs, and picks up exactly where
+    the previous block stopped. A block is rendered by recursive quadrature
+    rotation: the (cos, sin) pair is seeded from the phase once per block and
+    then rotated by the per-sample angle, which costs a few multiplies per
+    sample instead of a std::sin call. Four rotators run interleaved (each
+    stepping four samples) so the loop has no dependency between neighbouring
+    samples and vectorises.
+
+    A sine is band-limited by construction, so no wavetable is needed.
+*/
+class OscillatorBank
+{
+public:
+    static constexpr int maxOscillators = 8;
+
+    OscillatorBank() = default;
+
+    //==============================================================================
+    void prepare (double newSampleRate) noexcept
+    {
+        sampleRate = newSampleRate;
+
+        for (auto& oscillator : oscillators)
+            setIncrement (oscillator, oscillator.frequency / sampleRate);
+
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        for (auto& oscillator : oscillators)
+            oscillator.phase = 0.0;
+    }
+
+    void setFrequency (int index, double frequencyHz) noexcept
+    {
+        auto& oscillator = oscillators[(size_t) index];
+
+        if (oscillator.frequency != frequencyHz)
+        {
+            oscillator.frequency = frequencyHz;
+            setIncrement (oscillator, frequencyHz / sampleRate);
+        }
+    }
+
+    // Current phase in cycles, [0, 1)
+    double getPhase (int index) const noexcept      { return oscillators[(size_t) index].phase; }
+
+    //==============================================================================
+    // Writes the next numSamples of sin (2 pi phase) and advances the oscillator
+    void render (int index, float* destination, int numSamples) noexcept
+    {
+        renderBlock<false> (oscillators[(size_t) index], destination, numSamples, 1.0f);
+    }
+
+    // Same, but adds gain * sine on top of what is already in destination
+    void renderAdd (int index, float* destination, int numSamples, float gain) noexcept
+    {
+        renderBlock<true> (oscillators[(size_t) index], destination, numSamples, gain);
+    }
+
+private:
+    //==============================================================================
+    static constexpr int numRotators = 4;
+
+    struct Oscillator
+    {
+        double frequency = 0.0;
+        double phase = 0.0;          // Cycles, wrapped to [0, 1)
+        double increment = 0.0;      // Cycles per sample
+        double stepCos = 1.0, stepSin = 0.0;    // Rotation by numRotators samples
+    };
+
+    static void setIncrement (Oscillator& oscillator, double increment) noexcept
+    {
+        const double stepAngle = juce::MathConstants<double>::twoPi * increment * numRotators;
+
+        oscillator.increment = increment;
+        oscillator.stepCos = std::cos (stepAngle);
+        oscillator.stepSin = std::sin (stepAngle);
+    }
+
+    template <bool addToDestination>
+    static void renderBlock (Oscillator& oscillator, float* destination, int numSamples, float gain) noexcept
+    {
+        if (numSamples <= 0)
+            return;
+
+        // Seed rotator k at phase + k * increment; all of them then step numRotators samples at a time
+        double c[numRotators], s[numRotators];
+
+        for (int k = 0; k < numRotators; ++k)
+        {
+            const double angle = juce::MathConstants<double>::twoPi * (oscillator.phase + oscillator.increment * k);
+            c[k] = std::cos (angle);
+            s[k] = std::sin (angle);
+        }
+
+        const double stepCos = oscillator.stepCos;
+        const double stepSin = oscillator.stepSin;
+        int i = 0;
+
+        for (; i + numRotators <= numSamples; i += numRotators)
+        {
+            for (int k = 0; k < numRotators; ++k)
+            {
+                const float value = static_cast<float> (s[k]);
+
+                if constexpr (addToDestination)
+                    destination[i + k] += value * gain;
+                else
+                    destination[i + k] = value;
+
+                const double nextCos = c[k] * stepCos - s[k] * stepSin;
+                s[k] = s[k] * stepCos + c[k] * stepSin;
+                c[k] = nextCos;
+            }
+        }
+
+        for (int k = 0; k < numRotators && i + k < numSamples; ++k)
+        {
+            if constexpr (addToDestination)
+                destination[i + k] += static_cast<float> (s[k]) * gain;
+            else
+                destination[i + k] = static_cast<float> (s[k]);
+        }
+
+        // The rotation only lives for one block; the phase itself is tracked exactly
+        oscillator.phase += oscillator.increment * numSamples;
+        oscillator.phase -= std::floor (oscillator.phase);
+    }
+
+    //==============================================================================
+    double sampleRate = 44100.0;
+    std::array<Oscillator, maxOscillators> oscillators;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OscillatorBank)
+};
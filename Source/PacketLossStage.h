@@ -0,0 +1,353 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "NoiseEngine.h"
+
+//==============================================================================
+/**
+    Packet loss on a voice call, and the concealment a receiver plays in its
+    place. Runs in the processor's telephone band (8kHz), after the codec.
+
+    Voice travels in 20ms frames, and a lost packet takes a whole frame with
+    it, so the stage decides loss once per frame - on the same frame grid
+    as CodecStage and JitterBufferStage, since they all count from their
+    last reset. Frames the jitter buffer couldn't play in time are lost too. Losses on a real
+    network come in bursts rather than as independent coin flips, so besides
+    plain random loss the stage can draw them from a two-state Markov chain:
+    the Gilbert model (a good state that loses nothing and a bad state that
+    loses everything) or the Gilbert-Elliott model (each state loses with its
+    own probability). The chain's transition probabilities are solved from
+    the requested average loss rate and a typical burst length.
+
+    A lost frame is replaced by pitch-period repetition of the last audio
+    received, after ITU-T G.711 Appendix I: the pitch is estimated over the
+    history, the last quarter period is overlap-added with the period before
+    it so the repeated cycle joins smoothly, and the repetition widens to two
+    and then three periods as a burst goes on (so it doesn't buzz), fading
+    to silence after about 70ms. The first frame received after a loss is
+    crossfaded in from the concealment. Rewriting the last quarter period
+    means holding that much back, which is the stage's fixed delay
+    (getLatencySamples()).
+
+    All buffers are sized by prepare(); process() never allocates.
+*/
+class PacketLossStage
+{
+public:
+    enum Model
+    {
+        randomLoss = 0,         // Every frame lost independently
+        gilbert = 1,            // Bursts: everything in the bad state is lost
+        gilbertElliott = 2      // Bursts: both states lose, the bad one mostly
+    };
+
+    static constexpr double sampleRate = 8000.0;
+    static constexpr int frameSize = 160;                   // 20ms
+
+    PacketLossStage() = default;
+
+    //==============================================================================
+    void prepare (int newNumChannels)
+    {
+        numChannels = juce::jmax (1, newNumChannels);
+
+        signal.setSize (numChannels, historyLength + frameSize);
+        pitchBuffers.setSize (numChannels, maxPeriods * maxPitch);
+
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        signal.clear();
+        pitchBuffers.clear();
+
+        framePosition = 0;
+        inBadState = false;
+        frameLost = false;
+        numLostFrames = 0;
+        recoveryPosition = recoveryLength = 0;
+        pitchPeriod = maxPitch;
+        numPeriods = 1;
+        cursor = { 0, 0, 0 };
+    }
+
+    // Fixed delay of the stage (the longest overlap-add at the start of a loss), in 8kHz samples
+    int getLatencySamples() const noexcept                      { return maxOverlap; }
+
+    // Loss pattern and average fraction of frames lost (0 - 1)
+    void setLossModel (Model newModel, float newLossRate) noexcept
+    {
+        if (newModel == model && newLossRate == lossRate)
+            return;
+
+        model = newModel;
+        lossRate = juce::jlimit (0.0f, 1.0f, newLossRate);
+        updateTransitions();
+    }
+
+    // True while the frame being played out is a concealed one
+    bool isConcealing() const noexcept                          { return frameLost; }
+
+    //==============================================================================
+    // Runs numSamples of every channel (at 8kHz) through the network in place. framesLate can
+    // flag frames starting during this call, in order, that arrived too late to play (see
+    // JitterBufferStage); those are concealed whatever the loss model draws.
+    void process (float* const* channels, int numChannelsToProcess, int numSamples, NoiseGenerator& noise,
+                  const bool* framesLate = nullptr, int numFramesLate = 0) noexcept
+    {
+        jassert (numChannelsToProcess <= numChannels);
+        numChannelsToProcess = juce::jmin (numChannelsToProcess, numChannels);
+
+        for (int start = 0, frame = 0; start < numSamples;)
+        {
+            if (framePosition == 0)
+            {
+                const bool late = framesLate != nullptr && frame < numFramesLate && framesLate[frame];
+                startFrame (numChannelsToProcess, late, noise);
+                ++frame;
+            }
+
+            const int numThisTime = juce::jmin (numSamples - start, frameSize - framePosition);
+            auto nextCursor = cursor;
+
+            for (int channel = 0; channel < numChannelsToProcess; ++channel)
+            {
+                auto* line = signal.getWritePointer (channel);
+                auto* data = channels[channel] + start;
+                auto* incoming = line + historyLength;
+
+                if (frameLost)
+                {
+                    nextCursor = conceal (channel, incoming, numThisTime);
+                }
+                else
+                {
+                    juce::FloatVectorOperations::copy (incoming, data, numThisTime);
+
+                    if (recoveryPosition < recoveryLength)
+                        nextCursor = recover (channel, incoming, numThisTime);
+                }
+
+                // Out goes the oldest held-back audio, then the line moves on
+                juce::FloatVectorOperations::copy (data, line + historyLength - maxOverlap, numThisTime);
+                std::memmove (line, line + numThisTime, sizeof (float) * (size_t) historyLength);
+            }
+
+            cursor = nextCursor;
+
+            if (! frameLost)
+                recoveryPosition = juce::jmin (recoveryLength, recoveryPosition + numThisTime);
+
+            start += numThisTime;
+            framePosition = (framePosition + numThisTime) % frameSize;
+        }
+    }
+
+private:
+    //==============================================================================
+    static constexpr int minPitch = 40;                     // 200Hz
+    static constexpr int maxPitch = 120;                    // 66Hz
+    static constexpr int maxPeriods = 3;
+    static constexpr int maxOverlap = maxPitch / 4;
+    static constexpr int correlationLength = frameSize;
+    static constexpr int historyLength = maxPeriods * maxPitch + maxOverlap;
+
+    static constexpr int fadeStart = frameSize;             // Concealment fades after the first lost frame...
+    static constexpr int fadeLength = 5 * frameSize / 2;    // ...reaching silence 50ms later
+    static constexpr int maxRecoveryLength = frameSize / 2;
+
+    //==============================================================================
+    // Solves the Markov chain for the requested average loss: the bad state lasts
+    // meanBurstFrames on average, and its share of the time sets the loss rate
+    void updateTransitions() noexcept
+    {
+        if (model == randomLoss)
+        {
+            goodLoss = badLoss = lossRate;
+            toBad = 0.0f;
+            toGood = 1.0f;
+            return;
+        }
+
+        const float meanBurstFrames = model == gilbert ? 3.0f : 5.0f;
+        badLoss = model == gilbert ? 1.0f : 0.7f;
+        goodLoss = model == gilbert ? 0.0f : 0.1f * lossRate;
+
+        const float badShare = juce::jlimit (0.0f, 0.95f, (lossRate - goodLoss) / juce::jmax (1.0e-6f, badLoss - goodLoss));
+
+        toGood = 1.0f / meanBurstFrames;
+        toBad = juce::jmin (1.0f, toGood * badShare / (1.0f - badShare));
+    }
+
+    // One loss decision for every channel of the coming frame
+    void startFrame (int numChannelsToProcess, bool late, NoiseGenerator& noise) noexcept
+    {
+        inBadState = inBadState ? noise.nextFloat() >= toGood
+                                : noise.nextFloat() < toBad;
+
+        const bool wasLost = frameLost;
+        frameLost = (lossRate > 0.0f && noise.nextFloat() < (inBadState ? badLoss : goodLoss)) || late;
+
+        if (frameLost)
+        {
+            if (! wasLost)
+                startConcealment (numChannelsToProcess);
+
+            // Widen the repeated cycle as the burst goes on
+            numPeriods = juce::jmin (maxPeriods, ++numLostFrames);
+        }
+        else if (wasLost)
+        {
+            // The longer the gap, the longer the crossfade back to real audio
+            recoveryLength = juce::jmin (maxRecoveryLength, frameSize / 5 + (numLostFrames - 1) * frameSize / 2);
+            recoveryPosition = 0;
+            numLostFrames = 0;
+        }
+    }
+
+    // At the first lost frame: find the pitch, smooth the join and copy the cycles to repeat
+    void startConcealment (int numChannelsToProcess) noexcept
+    {
+        pitchPeriod = estimatePitch (signal.getReadPointer (0) + historyLength);
+        const int overlap = pitchPeriod / 4;
+        const int cycleLength = maxPeriods * pitchPeriod;
+
+        for (int channel = 0; channel < numChannelsToProcess; ++channel)
+        {
+            auto* historyEnd = signal.getWritePointer (channel) + historyLength;
+
+            // The held-back tail turns into the period before it, so repeating the last
+            // period carries on from it without a click
+            for (int i = -overlap; i < 0; ++i)
+            {
+                const float weight = (i + overlap + 1) / (float) overlap;
+                historyEnd[i] += weight * (historyEnd[i - pitchPeriod] - historyEnd[i]);
+            }
+
+            juce::FloatVectorOperations::copy (pitchBuffers.getWritePointer (channel), historyEnd - cycleLength, cycleLength);
+        }
+
+        cursor = { cycleLength - pitchPeriod, overlap, 0 };
+    }
+
+    // Normalised cross-correlation of the newest audio with itself one lag earlier.
+    // The first channel picks the pitch for all of them.
+    static int estimatePitch (const float* historyEnd) noexcept
+    {
+        const float* recent = historyEnd - correlationLength;
+        int bestLag = maxPitch;
+        float bestScore = 0.0f;
+
+        for (int lag = minPitch; lag <= maxPitch; ++lag)
+        {
+            const float* earlier = recent - lag;
+            float correlation = 0.0f, energy = 0.0f;
+
+            for (int i = 0; i < correlationLength; ++i)
+            {
+                correlation += recent[i] * earlier[i];
+                energy += earlier[i] * earlier[i];
+            }
+
+            if (correlation > 0.0f && correlation * correlation > bestScore * energy)
+            {
+                bestScore = correlation * correlation / energy;
+                bestLag = lag;
+            }
+        }
+
+        return bestLag;
+    }
+
+    // Where one channel's concealment has got to; every channel starts a chunk from the same one
+    struct Cursor
+    {
+        int readPosition;       // Into the pitch buffer
+        int sinceWrap;          // Samples since the read position last wrapped
+        int numConcealed;       // Since the loss began, for the fade
+    };
+
+    // The next concealment sample of one channel. The cycle repeats the last numPeriods
+    // periods; just after each wrap, its start fades in over the old cycle carried on
+    // by one period.
+    float nextConcealed (const float* cycle, Cursor& position) const noexcept
+    {
+        const int cycleEnd = maxPeriods * pitchPeriod;
+        const int overlap = pitchPeriod / 4;
+
+        if (position.readPosition >= cycleEnd)
+        {
+            position.readPosition = cycleEnd - numPeriods * pitchPeriod;
+            position.sinceWrap = 0;
+        }
+
+        float sample = cycle[position.readPosition];
+
+        if (position.sinceWrap < overlap)
+        {
+            const float weight = (position.sinceWrap + 1) / (float) overlap;
+            sample = cycle[cycleEnd - pitchPeriod + position.sinceWrap] + weight * (sample - cycle[cycleEnd - pitchPeriod + position.sinceWrap]);
+            ++position.sinceWrap;
+        }
+
+        const float gain = position.numConcealed < fadeStart
+                         ? 1.0f
+                         : juce::jmax (0.0f, 1.0f - (position.numConcealed - fadeStart) / (float) fadeLength);
+
+        ++position.readPosition;
+        ++position.numConcealed;
+        return sample * gain;
+    }
+
+    Cursor conceal (int channel, float* destination, int numSamples) const noexcept
+    {
+        const auto* cycle = pitchBuffers.getReadPointer (channel);
+        auto position = cursor;
+
+        for (int i = 0; i < numSamples; ++i)
+            destination[i] = nextConcealed (cycle, position);
+
+        return position;
+    }
+
+    // The first good frame after a loss fades in over the concealment carried on
+    Cursor recover (int channel, float* destination, int numSamples) const noexcept
+    {
+        const auto* cycle = pitchBuffers.getReadPointer (channel);
+        const int numToFade = juce::jmin (numSamples, recoveryLength - recoveryPosition);
+        auto position = cursor;
+
+        for (int i = 0; i < numToFade; ++i)
+        {
+            const float concealed = nextConcealed (cycle, position);
+            const float weight = (recoveryPosition + i + 1) / (float) recoveryLength;
+            destination[i] = concealed + weight * (destination[i] - concealed);
+        }
+
+        return position;
+    }
+
+    //==============================================================================
+    int numChannels = 1;
+
+    Model model = gilbertElliott;
+    float lossRate = 0.0f;
+    float goodLoss = 0.0f, badLoss = 0.0f;      // Chance of losing a frame in each state
+    float toBad = 0.0f, toGood = 1.0f;          // Chance per frame of changing state
+
+    juce::AudioBuffer<float> signal;            // Per channel: history, the held-back tail at its end, then room for one frame
+    juce::AudioBuffer<float> pitchBuffers;      // Per channel: the last maxPeriods pitch periods at the start of a loss
+
+    int framePosition = 0;
+    bool inBadState = false;
+    bool frameLost = false;
+    int numLostFrames = 0;                      // In the current burst
+    int recoveryPosition = 0, recoveryLength = 0;
+
+    int pitchPeriod = maxPitch;
+    int numPeriods = 1;
+    Cursor cursor { 0, 0, 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PacketLossStage)
+};
@@ -0,0 +1,243 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Block-level SIMD versions of the phone distortion curves.
+
+    TestAudioProcessor::applyPhoneDistortion switches on the phone type and
+    calls std::sin/tanh/atan for every sample. The phone type is constant for
+    a block, so the caller picks one of the kernels below per block and the
+    kernel runs on juce::dsp::SIMDRegister lanes, finishing the last few
+    samples with the scalar form of the same maths.
+
+    The transcendentals are polynomial/rational approximations with a bounded
+    error against the std:: functions (checked by CellyzBenchmark --verify):
+
+        fastSin    |error| < 4e-6   for |x| <= 64
+        fastTanh   |error| < 1e-6
+        fastAtan   |error| < 4e-6
+
+    applyPhoneDistortion is kept unchanged as the scalar reference.
+*/
+class PhoneWaveshaper
+{
+public:
+    using Vec = juce::dsp::SIMDRegister<float>;
+    static constexpr int vecSize = static_cast<int> (Vec::SIMDNumElements);
+
+    //==============================================================================
+    // Nokia: hard clip plus digital bite. 'noise' holds the scaled quantisation
+    // noise for each sample, or nullptr when the amount is too low to add any.
+    static void processNokia (float* data, const float* noise, int numSamples, float amount) noexcept
+    {
+        const float gain = 1.0f + amount * 1.2f;
+        const float biteLevel = 0.02f * amount;
+
+        processBlock (data, noise, numSamples, [=] (auto x, auto quantisationNoise)
+        {
+            auto clipped = min (max (x * gain, -0.9f), 0.9f) + quantisationNoise;
+            return clipped + fastSin (clipped * 8.0f) * biteLevel;
+        });
+    }
+
+    // iPhone: smooth tanh saturation with a little digital warmth
+    static void processIPhone (float* data, int numSamples, float amount) noexcept
+    {
+        const float gain = 1.0f + amount * 1.8f;
+        const float warmthLevel = amount > 0.05f ? 0.02f * amount : 0.0f;
+        const float outputGain = 1.0f - amount * 0.1f;
+
+        processBlock (data, nullptr, numSamples, [=] (auto x, auto)
+        {
+            auto softClipped = fastTanh (x * gain) * 0.85f;
+            softClipped = softClipped + fastSin (softClipped * 8.0f) * warmthLevel;
+            return softClipped * outputGain;
+        });
+    }
+
+    // Sony Ericsson: asymmetric atan saturation with tube-like harmonics
+    static void processSonyEricsson (float* data, int numSamples, float amount) noexcept
+    {
+        const float gain = 1.0f + amount * 3.5f;
+        const float harmonicLevel = 0.12f * amount;
+        const float agingLevel = 0.05f * amount;
+
+        processBlock (data, nullptr, numSamples, [=] (auto x, auto)
+        {
+            using T = decltype (x);
+
+            auto amplified = x * gain;
+            auto drive = selectIfNegative (amplified, splat<T> (0.9f), splat<T> (1.2f));
+            auto outputScale = selectIfNegative (amplified, splat<T> (0.85f), splat<T> (0.8f));
+            auto analogSat = fastAtan (amplified * drive) * outputScale;
+
+            auto analogHarmonics = fastSin (analogSat * 6.0f) * harmonicLevel;
+            auto agingEffect = analogSat * (fastSin (analogSat * 25.0f) * agingLevel + 1.0f);
+
+            return agingEffect + analogHarmonics;
+        });
+    }
+
+    //==============================================================================
+    // Approximations, usable on float or Vec
+
+    // Reduce to [-pi/2, pi/2] around the nearest multiple of pi, then an odd degree-9 polynomial
+    template <typename T>
+    static T fastSin (T x) noexcept
+    {
+        auto y = x * 0.318309886f; // 1/pi
+        auto k = truncate (y + selectIfNegative (y, splat<T> (-0.5f), splat<T> (0.5f)));
+
+        // Two-part pi keeps the reduction exact enough for the arguments the curves produce
+        auto r = (x - k * 3.140625f) - k * 9.67653589793e-4f;
+        auto r2 = r * r;
+
+        auto poly = ((r2 * 2.7526e-6f - 1.98409e-4f) * r2 + 0.0083333310f) * r2 - 0.16666667f;
+        auto sinR = r + r * r2 * poly;
+
+        // Odd multiples of pi flip the sign
+        auto parity = k - truncate (k * 0.5f) * 2.0f;
+        return sinR * (abs (parity) * -2.0f + 1.0f);
+    }
+
+    // [13/6] rational, exact to float precision once clamped to where tanh reaches +/-1
+    template <typename T>
+    static T fastTanh (T x) noexcept
+    {
+        x = min (max (x, -7.90531110763549805f), 7.90531110763549805f);
+        auto x2 = x * x;
+
+        auto p = x2 * -2.76076847742355e-16f + 2.00018790482477e-13f;
+        p = p * x2 - 8.60467152213735e-11f;
+        p = p * x2 + 5.12229709037114e-08f;
+        p = p * x2 + 1.48572235717979e-05f;
+        p = p * x2 + 6.37261928875436e-04f;
+        p = p * x2 + 4.89352455891786e-03f;
+
+        auto q = x2 * 1.19825839466702e-06f + 1.18534705686654e-04f;
+        q = q * x2 + 2.26843463243900e-03f;
+        q = q * x2 + 4.89352518554385e-03f;
+
+        return divide (x * p, q);
+    }
+
+    // Fold |x| > 1 onto 1/|x|, minimax polynomial on [0, 1], then restore quadrant and sign
+    template <typename T>
+    static T fastAtan (T x) noexcept
+    {
+        auto a = abs (x);
+        auto t = divide (min (a, 1.0f), max (a, 1.0f));
+        auto t2 = t * t;
+
+        auto p = t2 * -0.01172120f + 0.05265332f;
+        p = p * t2 - 0.11643287f;
+        p = p * t2 + 0.19354346f;
+        p = p * t2 - 0.33262347f;
+        p = p * t2 + 0.99997726f;
+        p = p * t;
+
+        p = selectIfNegative (splat<T> (1.0f) - a, splat<T> (1.57079632679f) - p, p);
+        return selectIfNegative (x, splat<T> (0.0f) - p, p);
+    }
+
+private:
+    //==============================================================================
+    template <typename Shaper>
+    static void processBlock (float* data, const float* noise, int numSamples, Shaper&& shaper) noexcept
+    {
+        int i = 0;
+
+        for (; i + vecSize <= numSamples; i += vecSize)
+        {
+            const auto noiseLanes = noise != nullptr ? load (noise + i) : Vec::expand (0.0f);
+            store (data + i, shaper (load (data + i), noiseLanes));
+        }
+
+        for (; i < numSamples; ++i)
+            data[i] = shaper (data[i], noise != nullptr ? noise[i] : 0.0f);
+    }
+
+    // Host buffers carry no alignment guarantee; these compile down to unaligned loads/stores
+    static Vec load (const float* source) noexcept
+    {
+        alignas (Vec::SIMDRegisterSize) float lanes[vecSize];
+        std::memcpy (lanes, source, sizeof (lanes));
+        return Vec::fromRawArray (lanes);
+    }
+
+    static void store (float* destination, Vec value) noexcept
+    {
+        alignas (Vec::SIMDRegisterSize) float lanes[vecSize];
+        value.copyToRawArray (lanes);
+        std::memcpy (destination, lanes, sizeof (lanes));
+    }
+
+    //==============================================================================
+    // float / Vec overloads so every curve above is written once
+    template <typename T>
+    static T splat (float value) noexcept
+    {
+        if constexpr (std::is_same_v<T, float>)
+            return value;
+        else
+            return T::expand (value);
+    }
+
+    static float truncate (float x) noexcept                  { return std::trunc (x); }
+    static Vec truncate (Vec x) noexcept                      { return Vec::truncate (x); }
+
+    static float abs (float x) noexcept                       { return std::abs (x); }
+    static Vec abs (Vec x) noexcept                           { return Vec::abs (x); }
+
+    static float min (float a, float b) noexcept              { return juce::jmin (a, b); }
+    static Vec min (Vec a, float b) noexcept                  { return Vec::min (a, Vec::expand (b)); }
+
+    static float max (float a, float b) noexcept              { return juce::jmax (a, b); }
+    static Vec max (Vec a, float b) noexcept                  { return Vec::max (a, Vec::expand (b)); }
+
+    static float selectIfNegative (float x, float ifNegative, float otherwise) noexcept
+    {
+        return x < 0.0f ? ifNegative : otherwise;
+    }
+
+    static Vec selectIfNegative (Vec x, Vec ifNegative, Vec otherwise) noexcept
+    {
+        const auto mask = Vec::lessThan (x, Vec::expand (0.0f));
+        return (ifNegative & mask) + (otherwise & ~mask);
+    }
+
+    static float divide (float a, float b) noexcept           { return a / b; }
+
+    // SIMDRegister has no division, so go to the native instruction where there is one
+    static Vec divide (Vec a, Vec b) noexcept
+    {
+       #if JUCE_USE_SIMD && (defined (__i386__) || defined (__amd64__) || defined (_M_X64) || defined (_X86_) || defined (_M_IX86))
+        return Vec::fromNative (divideNative (a.value, b.value));
+       #elif JUCE_USE_SIMD && (defined (__arm64__) || defined (__aarch64__) || defined (_M_ARM64))
+        return Vec::fromNative (vdivq_f32 (a.value, b.value));
+       #elif JUCE_USE_SIMD && (defined (__arm__) || defined (_M_ARM))
+        // ARMv7 NEON: reciprocal estimate refined with two Newton-Raphson steps
+        auto reciprocal = vrecpeq_f32 (b.value);
+        reciprocal = vmulq_f32 (vrecpsq_f32 (b.value, reciprocal), reciprocal);
+        reciprocal = vmulq_f32 (vrecpsq_f32 (b.value, reciprocal), reciprocal);
+        return Vec::fromNative (vmulq_f32 (a.value, reciprocal));
+       #else
+        Vec result;
+
+        for (size_t i = 0; i < Vec::SIMDNumElements; ++i)
+            result.set (i, a.get (i) / b.get (i));
+
+        return result;
+       #endif
+    }
+
+   #if JUCE_USE_SIMD && (defined (__i386__) || defined (__amd64__) || defined (_M_X64) || defined (_X86_) || defined (_M_IX86))
+    // Overloaded on the register type JUCE picked (SSE, or AVX when it is enabled)
+    static __m128 divideNative (__m128 a, __m128 b) noexcept  { return _mm_div_ps (a, b); }
+    #if defined (__AVX__)
+    static __m256 divideNative (__m256 a, __m256 b) noexcept  { return _mm256_div_ps (a, b); }
+    #endif
+   #endif
+};
@@ -78,7 +78,7 @@ TestAudioProcessorEditor::TestAudioProcessorEditor (TestAudioProcessor& p)
     // High Cut slider - horizontal with Hz values  
     highCutSlider.setSliderStyle(juce::Slider::LinearHorizontal);
     highCutSlider.setTextBoxStyle(juce::Slider::TextBoxBelow, false, 100, 30);
-    highCutSlider.setRange(0.0, 4.0, 1.0); // 5 positions: 0=Off, 1=2.8kHz, 2=3.2kHz, 3=3.4kHz, 4=7kHz
+    highCutSlider.setRange(0.0, 4.0, 1.0); // 5 positions: 0=Off, 1=2.8kHz, 2=3.2kHz, 3=3.4kHz, 4=3.6kHz
     highCutSlider.setValue(0.0); // Start at "Off"
     // Configure for discrete snapping with good responsiveness
     highCutSlider.setVelocityBasedMode(false); // Disable smooth velocity dragging
@@ -251,7 +251,7 @@ TestAudioProcessorEditor::TestAudioProcessorEditor (TestAudioProcessor& p)
     audioProcessor.apvts.getParameter(TestAudioProcessor::COMPRESSION_ID)->setValueNotifyingHost(0.5f);   // 50% compression
     
     // Start animation timer for screen updates
-    startTimer(16); // ~60fps
+    startTimer(activeTimerIntervalMs);
     
     // Setup custom phone-themed LookAndFeel
     phoneLookAndFeel = std::make_unique<PhoneLookAndFeel>(0); // Start with Nokia
@@ -503,12 +503,24 @@ void TestAudioProcessorEditor::startDisplayAnimation(const PhoneDisplay& newDisp
     targetDisplay = newDisplay;
     animationProgress = 0.0f;
     isAnimating = true;
-    startTimer(16); // ~60fps
+    startTimer(activeTimerIntervalMs);
 }
 
 void TestAudioProcessorEditor::timerCallback()
 {
-    // Handle display morphing animation
+    // Everything the audio thread reports, read once per frame
+    telemetry = audioProcessor.getTelemetry();
+    
+    // The FFT runs here, on the message thread, never on the audio thread
+    const double nowMs = juce::Time::getMillisecondCounterHiRes();
+    if (nowMs - lastSpectrumUpdateMs >= 1000.0 / spectrumRefreshHz)
+    {
+        lastSpectrumUpdateMs = nowMs;
+        audioProcessor.getSpectrumAnalyser().computeSpectrum(spectrum);
+    }
+    
+    // Handle display morphing animation (resized() every tick, so the whole editor needs repainting)
+    const bool layoutChanged = isAnimating;
     if (isAnimating)
     {
         animationProgress += 0.15f; // Animation speed
@@ -539,15 +551,20 @@ void TestAudioProcessorEditor::timerCallback()
         }
     }
     
-    // Always update screen animations and audio monitoring
-    updateScreenAnimations();
+    // Always update screen animations and audio monitoring, one animation step per full-rate frame elapsed
+    const int framesElapsed = lastFrameMs > 0.0 ? juce::jlimit(1, maxFramesPerTick, juce::roundToInt((nowMs - lastFrameMs) / activeTimerIntervalMs)) : 1;
+    lastFrameMs = nowMs;
+    
+    for (int frame = 0; frame < framesElapsed; ++frame)
+        updateScreenAnimations();
+    
     updateAudioLevel();
     
     // GAME-CHANGING: Update Dynamic Signal Strength Display
-    float currentSignal = audioProcessor.getCurrentSignalStrength();
-    int signalBars = audioProcessor.getSignalBars();
-    bool isDropping = audioProcessor.isCallDropping();
-    float voiceActivity = audioProcessor.getVoiceActivity();
+    float currentSignal = telemetry.signalStrength;
+    int signalBars = telemetry.signalBars;
+    bool isDropping = telemetry.droppingOut;
+    float voiceActivity = telemetry.voiceActivity;
     
     // Update signal strength status label with real-time info
     juce::String signalStatusText;
@@ -579,9 +596,10 @@ void TestAudioProcessorEditor::timerCallback()
     screenState.audioLevel = voiceActivity;
     
     // Handle button press effects
+    auto* buttonToRepaint = pressedButton;
     if (pressedButton != nullptr)
     {
-        buttonPressTimer++;
+        buttonPressTimer += framesElapsed;
         if (buttonPressTimer > 30) // Effect duration
         {
             pressedButton = nullptr;
@@ -594,7 +612,55 @@ void TestAudioProcessorEditor::timerCallback()
         }
     }
     
-    repaint();
+    // Repaint only what changed: the whole editor while the phone morphs, otherwise just the
+    // screen (when anything on it moved) and the button under a fading press effect.
+    // Labels and controls repaint themselves when their own content changes.
+    const bool screenChanged = !drawsSameScreen(screenState, paintedScreenState) || spectrum != paintedSpectrum;
+    
+    if (layoutChanged)
+    {
+        repaint();
+    }
+    else
+    {
+        if (screenChanged)
+            repaint(screenBounds);
+        
+        if (buttonToRepaint != nullptr)
+            repaint(buttonToRepaint->getBounds());
+    }
+    
+    paintedScreenState = screenState;
+    paintedSpectrum = spectrum;
+    
+    // Drop to the idle rate once nothing drawn has changed for a while - a steady tone holds the
+    // meters and spectrum still just as silence does. The hold spans several spectrum refreshes,
+    // so the ticks between them don't flip the rate back and forth.
+    if (screenChanged || layoutChanged)
+        lastScreenChangeMs = nowMs;
+    
+    const bool animating = isAnimating || pressedButton != nullptr || nowMs - lastScreenChangeMs < idleHoldMs;
+    const int timerInterval = animating ? activeTimerIntervalMs : idleTimerIntervalMs;
+    
+    if (getTimerInterval() != timerInterval)
+        startTimer(timerInterval);
+}
+
+bool TestAudioProcessorEditor::drawsSameScreen(const AnimatedScreen& a, const AnimatedScreen& b)
+{
+    // Only what the draw*Screen methods show (animationFrame, audioLevel and the like aren't drawn)
+    return a.scrollingText == b.scrollingText
+        && a.textScrollPosition == b.textScrollPosition
+        && a.signalBars == b.signalBars
+        && a.batteryLevel == b.batteryLevel
+        && a.appName == b.appName
+        && a.volumeBarLevel == b.volumeBarLevel
+        && a.isRecording == b.isRecording
+        && a.notifications == b.notifications
+        && a.statusText == b.statusText
+        && a.analogMeterLevel == b.analogMeterLevel
+        && a.hasNewMessage == b.hasNewMessage
+        && a.timeDisplay == b.timeDisplay;
 }
 
 void TestAudioProcessorEditor::drawPhoneDisplay(juce::Graphics& g, const PhoneDisplay& display, juce::Rectangle<int> displayArea)
@@ -915,8 +981,8 @@ void TestAudioProcessorEditor::updateNokiaAnimations()
 
 void TestAudioProcessorEditor::updateIPhoneAnimations()
 {
-    // Volume bar responds to audio level
-    screenState.volumeBarLevel = audioLevelSmoothed;
+    // Volume bar shows the output's peak meter
+    screenState.volumeBarLevel = toMeterScale(telemetry.output.getPeak());
     
     // Recording indicator blinks
     if (screenState.isProcessingAudio)
@@ -935,8 +1001,8 @@ void TestAudioProcessorEditor::updateIPhoneAnimations()
 
 void TestAudioProcessorEditor::updateSonyEricssonAnimations()
 {
-    // Analog meter responds to audio
-    screenState.analogMeterLevel = audioLevelSmoothed * 0.8f + screenState.analogMeterLevel * 0.2f;
+    // Analog meter's needle shows the output's RMS (the processor's meter has VU ballistics)
+    screenState.analogMeterLevel = toMeterScale(telemetry.output.getRMS());
     
     // Status text changes
     if (screenState.isProcessingAudio)
@@ -957,29 +1023,24 @@ void TestAudioProcessorEditor::updateSonyEricssonAnimations()
 
 void TestAudioProcessorEditor::updateAudioLevel()
 {
-    // Get current audio level from processor (simplified)
+    // Get current audio level from processor (already smoothed by the meter's ballistics)
     currentAudioLevel = getCurrentAudioLevel();
     
-    // Smooth the audio level
-    audioLevelSmoothed = audioLevelSmoothed * 0.7f + currentAudioLevel * 0.3f;
-    
-    // Update processing state
-    screenState.isProcessingAudio = audioLevelSmoothed > 0.01f;
-    screenState.audioLevel = audioLevelSmoothed;
+    // Update processing state: anything above -40dB RMS
+    screenState.isProcessingAudio = telemetry.output.getRMS() > 0.01f;
+    screenState.audioLevel = currentAudioLevel;
 }
 
 float TestAudioProcessorEditor::getCurrentAudioLevel()
 {
-    // Simplified audio level detection
-    // In a real implementation, this would get the actual audio level from the processor
-    float level = 0.0f;
-    
-    // Simulate audio activity based on parameter changes
-    level += std::abs(distortionSlider.getValue()) * 0.3f;
-    level += std::abs(wetDrySlider.getValue()) * 0.1f;  // Wet/dry mix contributes to visual level
-    level += (signalQualityBox.getSelectedItemIndex() / 5.0f) * 0.2f;  // FIXED: Changed from interferenceSlider
-    
-    return juce::jmin(1.0f, level);
+    // The processed output's RMS meter, as the audio thread last published it
+    return toMeterScale(telemetry.output.getRMS());
+}
+
+float TestAudioProcessorEditor::toMeterScale(float gain)
+{
+    // Meters read in dB: -60dB and below at the bottom, full scale at the top
+    return juce::jmap(juce::jlimit(meterFloorDb, 0.0f, juce::Decibels::gainToDecibels(gain, meterFloorDb)), meterFloorDb, 0.0f, 0.0f, 1.0f);
 }
 
 void TestAudioProcessorEditor::showButtonPressEffect(juce::Button* button)
@@ -1079,6 +1140,23 @@ void TestAudioProcessorEditor::drawAnalogMeter(juce::Graphics& g, juce::Rectangl
     g.fillEllipse(center.x - 3, center.y - 3, 6, 6);
 }
 
+void TestAudioProcessorEditor::drawSpectrum(juce::Graphics& g, juce::Rectangle<int> area, juce::Colour colour)
+{
+    if (area.getWidth() < SpectrumAnalyser::numBands / 4 || area.getHeight() < 4)
+        return;
+    
+    // One bar per log-spaced band, 20Hz on the left to 20kHz on the right
+    const float barWidth = area.getWidth() / static_cast<float>(SpectrumAnalyser::numBands);
+    
+    g.setColour(colour);
+    for (int band = 0; band < SpectrumAnalyser::numBands; ++band)
+    {
+        const float barHeight = spectrum[static_cast<size_t>(band)] * area.getHeight();
+        g.fillRect(juce::Rectangle<float>(area.getX() + band * barWidth, area.getBottom() - barHeight,
+                                          juce::jmax(1.0f, barWidth - 1.0f), barHeight));
+    }
+}
+
 void TestAudioProcessorEditor::drawScrollingText(juce::Graphics& g, juce::Rectangle<int> area, const juce::String& text, float position)
 {
     g.setColour(juce::Colours::lightgreen);
@@ -1102,6 +1180,8 @@ void TestAudioProcessorEditor::drawScrollingText(juce::Graphics& g, juce::Rectan
 
 void TestAudioProcessorEditor::drawNokiaScreen(juce::Graphics& g, juce::Rectangle<int> screenArea)
 {
+    screenBounds = screenArea; // Where timerCallback repaints when the screen changes
+    
     // Nokia 3310 LCD screen with green backlight
     g.setColour(juce::Colour(0xff1a4d1a));
     g.fillRect(screenArea);
@@ -1138,10 +1218,15 @@ void TestAudioProcessorEditor::drawNokiaScreen(juce::Graphics& g, juce::Rectangl
     g.setFont(juce::Font(6.0f));
     g.drawText("Menu", contentArea.removeFromBottom(8), juce::Justification::centredLeft);
     g.drawText("Back", contentArea.removeFromBottom(8), juce::Justification::centredRight);
+    
+    // Spectrum of the output in what's left of the LCD
+    drawSpectrum(g, contentArea.reduced(1), juce::Colours::lightgreen);
 }
 
 void TestAudioProcessorEditor::drawIPhoneScreen(juce::Graphics& g, juce::Rectangle<int> screenArea)
 {
+    screenBounds = screenArea; // Where timerCallback repaints when the screen changes
+    
     // iPhone screen with black background
     g.setColour(juce::Colours::black);
     g.fillRect(screenArea);
@@ -1197,10 +1282,15 @@ void TestAudioProcessorEditor::drawIPhoneScreen(juce::Graphics& g, juce::Rectang
         g.setColour(juce::Colours::lightblue);
         g.drawText(screenState.notifications[i], notifArea, juce::Justification::centred);
     }
+    
+    // Spectrum of the output between the volume bar and the notifications
+    drawSpectrum(g, contentArea.reduced(4, 1), juce::Colours::cyan);
 }
 
 void TestAudioProcessorEditor::drawSonyEricssonScreen(juce::Graphics& g, juce::Rectangle<int> screenArea)
 {
+    screenBounds = screenArea; // Where timerCallback repaints when the screen changes
+    
     // Sony Ericsson monochrome LCD
     g.setColour(juce::Colour(0xff2a4a2a));
     g.fillRect(screenArea);
@@ -1236,14 +1326,17 @@ void TestAudioProcessorEditor::drawSonyEricssonScreen(juce::Graphics& g, juce::R
     meterArea = meterArea.reduced(6, 2);
     drawAnalogMeter(g, meterArea, screenState.analogMeterLevel);
     
-    // New message indicator
+    // New message indicator (its line is kept even while it's off, so the spectrum doesn't jump)
+    auto msgArea = contentArea.removeFromBottom(8);
     if (screenState.hasNewMessage)
     {
-        auto msgArea = contentArea.removeFromBottom(8);
         g.setColour(juce::Colours::yellow);
         g.setFont(juce::Font(6.0f));
         g.drawText("1 NEW MSG", msgArea, juce::Justification::centred);
     }
+    
+    // Spectrum of the output below the meter
+    drawSpectrum(g, contentArea.reduced(2, 1), juce::Colours::lightgreen);
 }
 
 //==============================================================================
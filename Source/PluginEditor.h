@@ -97,6 +97,7 @@ private:
     void drawBatteryIndicator(juce::Graphics& g, juce::Rectangle<int> area, int level);
     void drawVolumeBar(juce::Graphics& g, juce::Rectangle<int> area, float level);
     void drawAnalogMeter(juce::Graphics& g, juce::Rectangle<int> area, float level);
+    void drawSpectrum(juce::Graphics& g, juce::Rectangle<int> area, juce::Colour colour);
     void drawScrollingText(juce::Graphics& g, juce::Rectangle<int> area, const juce::String& text, float position);
     
     // GAME-CHANGING: Dynamic Signal Strength Display
@@ -111,6 +112,7 @@ private:
     void loadPhoneState(int phoneIndex);
     void updateAdaptiveTypography();  // NEW: Changes fonts based on selected phone
     float getCurrentAudioLevel();
+    static float toMeterScale(float gain);  // Linear level -> 0-1 meter position
     
     // Screen animation updates
     void updateScreenAnimations();
@@ -141,14 +143,35 @@ private:
     AnimatedScreen screenState;
     int screenAnimationTimer = 0;
     
+    // Invalidation tracking: what the screen showed when it was last repainted, and where it is
+    AnimatedScreen paintedScreenState {};
+    SpectrumAnalyser::Bands paintedSpectrum {};
+    juce::Rectangle<int> screenBounds;      // Recorded by the draw*Screen methods
+    static bool drawsSameScreen(const AnimatedScreen& a, const AnimatedScreen& b);
+    
+    // Timer rates: full rate while anything drawn changes, the idle rate once it has held still for idleHoldMs.
+    // The screen animations count full-rate frames, so they run at the same speed at either rate.
+    static constexpr int activeTimerIntervalMs = 16;    // ~60fps
+    static constexpr int idleTimerIntervalMs = 50;      // 20fps
+    static constexpr int maxFramesPerTick = 10;
+    static constexpr double idleHoldMs = 250.0;
+    double lastFrameMs = 0.0;
+    double lastScreenChangeMs = 0.0;
+    
     // Button press effect state
     juce::Button* pressedButton = nullptr;
     float buttonPressAlpha = 0.0f;
     int buttonPressTimer = 0;
     
-    // Audio level monitoring
+    // Audio level monitoring: the processor's latest telemetry, read at the top of every timerCallback
+    TestAudioProcessor::Telemetry telemetry;
     float currentAudioLevel = 0.0f;
-    float audioLevelSmoothed = 0.0f;
+    static constexpr float meterFloorDb = -60.0f;
+    
+    // The output's spectrum, recomputed from the processor's FIFO at spectrumRefreshHz
+    SpectrumAnalyser::Bands spectrum {};
+    double lastSpectrumUpdateMs = 0.0;
+    static constexpr double spectrumRefreshHz = 30.0;
     
     TestAudioProcessor& audioProcessor;
     
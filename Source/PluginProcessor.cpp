@@ -1,5 +1,132 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "RealtimeAllocationTracker.h"
+#include "PhoneWaveshaper.h"
+
+//==============================================================================
+// Debug allocation tracking: route the plugin's heap traffic through the
+// tracker so processBlock asserts if it ever allocates or frees memory.
+#if CELLYZ_TRACK_REALTIME_ALLOCATIONS
+namespace
+{
+    void* allocateTracked (std::size_t size) noexcept
+    {
+        RealtimeAllocationTracker::checkHeapAccess();
+        return std::malloc (size == 0 ? 1 : size);
+    }
+
+    // Over-allocates, and keeps the malloc'd pointer just below the aligned block
+    void* allocateAlignedTracked (std::size_t size, std::align_val_t alignment) noexcept
+    {
+        const auto align = juce::jmax (static_cast<std::size_t> (alignment), alignof (void*));
+
+        auto* block = static_cast<char*> (allocateTracked (size + align + sizeof (void*)));
+
+        if (block == nullptr)
+            return nullptr;
+
+        const auto aligned = (reinterpret_cast<std::uintptr_t> (block) + sizeof (void*) + align - 1) & ~(std::uintptr_t) (align - 1);
+        reinterpret_cast<void**> (aligned)[-1] = block;
+        return reinterpret_cast<void*> (aligned);
+    }
+
+    void freeTracked (void* ptr) noexcept
+    {
+        if (ptr != nullptr)
+            RealtimeAllocationTracker::checkHeapAccess();
+
+        std::free (ptr);
+    }
+
+    void freeAlignedTracked (void* ptr) noexcept
+    {
+        if (ptr != nullptr)
+            freeTracked (static_cast<void**> (ptr)[-1]);
+    }
+}
+
+void* operator new (std::size_t size)
+{
+    if (auto* ptr = allocateTracked (size))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void* operator new (std::size_t size, std::align_val_t alignment)
+{
+    if (auto* ptr = allocateAlignedTracked (size, alignment))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[] (std::size_t size)                                                         { return operator new (size); }
+void* operator new[] (std::size_t size, std::align_val_t alignment)                             { return operator new (size, alignment); }
+void* operator new (std::size_t size, const std::nothrow_t&) noexcept                           { return allocateTracked (size); }
+void* operator new[] (std::size_t size, const std::nothrow_t&) noexcept                         { return allocateTracked (size); }
+void* operator new (std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept   { return allocateAlignedTracked (size, alignment); }
+void* operator new[] (std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return allocateAlignedTracked (size, alignment); }
+
+void operator delete (void* ptr) noexcept                                                       { freeTracked (ptr); }
+void operator delete[] (void* ptr) noexcept                                                     { freeTracked (ptr); }
+void operator delete (void* ptr, std::size_t) noexcept                                          { freeTracked (ptr); }
+void operator delete[] (void* ptr, std::size_t) noexcept                                        { freeTracked (ptr); }
+void operator delete (void* ptr, const std::nothrow_t&) noexcept                                { freeTracked (ptr); }
+void operator delete[] (void* ptr, const std::nothrow_t&) noexcept                              { freeTracked (ptr); }
+void operator delete (void* ptr, std::align_val_t) noexcept                                     { freeAlignedTracked (ptr); }
+void operator delete[] (void* ptr, std::align_val_t) noexcept                                   { freeAlignedTracked (ptr); }
+void operator delete (void* ptr, std::size_t, std::align_val_t) noexcept                        { freeAlignedTracked (ptr); }
+void operator delete[] (void* ptr, std::size_t, std::align_val_t) noexcept                      { freeAlignedTracked (ptr); }
+void operator delete (void* ptr, std::align_val_t, const std::nothrow_t&) noexcept              { freeAlignedTracked (ptr); }
+void operator delete[] (void* ptr, std::align_val_t, const std::nothrow_t&) noexcept            { freeAlignedTracked (ptr); }
+#endif
+
+// HeapBlock (AudioBuffer's storage) and much of JUCE call std::malloc directly. On glibc the malloc
+// family is interposed for this binary only: the symbols are marked hidden in the object file (the
+// C library's declarations rule out a visibility attribute), so the linker binds every call made
+// from inside the plugin here and exports none of them - the host and other libraries keep calling
+// glibc. glibc's __libc_* entry points are the real allocator underneath.
+#if CELLYZ_TRACK_REALTIME_MALLOC
+__asm__ (".hidden malloc\n"
+         ".hidden calloc\n"
+         ".hidden realloc\n"
+         ".hidden free");
+
+extern "C"
+{
+    void* __libc_malloc (std::size_t);
+    void* __libc_calloc (std::size_t, std::size_t);
+    void* __libc_realloc (void*, std::size_t);
+    void __libc_free (void*);
+
+    void* malloc (std::size_t size) noexcept
+    {
+        RealtimeAllocationTracker::checkHeapAccess();
+        return __libc_malloc (size);
+    }
+
+    void* calloc (std::size_t count, std::size_t size) noexcept
+    {
+        RealtimeAllocationTracker::checkHeapAccess();
+        return __libc_calloc (count, size);
+    }
+
+    void* realloc (void* ptr, std::size_t size) noexcept
+    {
+        RealtimeAllocationTracker::checkHeapAccess();
+        return __libc_realloc (ptr, size);
+    }
+
+    void free (void* ptr) noexcept
+    {
+        if (ptr != nullptr)
+            RealtimeAllocationTracker::checkHeapAccess();
+
+        __libc_free (ptr);
+    }
+}
+#endif
 
 //==============================================================================
 // Parameter ID definitions
@@ -18,7 +145,10 @@ const juce::String TestAudioProcessor::INTERFERENCE_PRESET_ID = "interferencePre
 // PHASE 5: Advanced Audio Processing Parameter IDs
 const juce::String TestAudioProcessor::CODEC_TYPE_ID = "codecType";
 const juce::String TestAudioProcessor::PACKET_LOSS_ID = "packetLoss";  
+const juce::String TestAudioProcessor::PACKET_LOSS_MODEL_ID = "packetLossModel";
+const juce::String TestAudioProcessor::JITTER_ID = "jitter";
 const juce::String TestAudioProcessor::CALL_POSITION_ID = "callPosition";
+const juce::String TestAudioProcessor::CALL_POSITION_BINAURAL_ID = "callPositionBinaural";
 const juce::String TestAudioProcessor::AMBIENCE_TYPE_ID = "ambienceType";
 const juce::String TestAudioProcessor::AMBIENCE_LEVEL_ID = "ambienceLevel";
 
@@ -53,7 +183,10 @@ TestAudioProcessor::TestAudioProcessor()
     // PHASE 5: Advanced Audio Processing Parameter Pointers
     codecTypeParam = apvts.getRawParameterValue(CODEC_TYPE_ID);
     packetLossParam = apvts.getRawParameterValue(PACKET_LOSS_ID);
+    packetLossModelParam = apvts.getRawParameterValue(PACKET_LOSS_MODEL_ID);
+    jitterParam = apvts.getRawParameterValue(JITTER_ID);
     callPositionParam = apvts.getRawParameterValue(CALL_POSITION_ID);
+    callPositionBinauralParam = apvts.getRawParameterValue(CALL_POSITION_BINAURAL_ID);
     ambienceTypeParam = apvts.getRawParameterValue(AMBIENCE_TYPE_ID);
     ambienceLevelParam = apvts.getRawParameterValue(AMBIENCE_LEVEL_ID);
     
@@ -68,11 +201,11 @@ TestAudioProcessor::TestAudioProcessor()
     iphoneWarmthPhase = 0.0f;
     sonyAnalogPhase = 0.0f;
     
-    // Initialize TV interference state
-    tvInterferencePhase = 0.0f;
-    tvScanlinePhase = 0.0f;
-    tvBurstTimer = 0.0f;
-    tvBurstState = 0;
+   #if CELLYZ_TRACK_REALTIME_ALLOCATIONS
+    // Debug builds: make sure the allocation tracker can actually see what it's meant to, once per process
+    static const bool allocationTrackerChecked = [] { RealtimeAllocationTracker::runSelfTest(); return true; }();
+    juce::ignoreUnused(allocationTrackerChecked);
+   #endif
 }
 
 TestAudioProcessor::~TestAudioProcessor()
@@ -114,7 +247,7 @@ juce::AudioProcessorValueTreeState::ParameterLayout TestAudioProcessor::createPa
                 case 1: return juce::String("2.8kHz");
                 case 2: return juce::String("3.2kHz");
                 case 3: return juce::String("3.4kHz");
-                case 4: return juce::String("7kHz");
+                case 4: return juce::String("3.6kHz");
                 default: return juce::String("Off");
             }
         }
@@ -182,12 +315,38 @@ juce::AudioProcessorValueTreeState::ParameterLayout TestAudioProcessor::createPa
         [](float value, int) { return juce::String(static_cast<int>(value * 100)) + " %"; }
     ));
     
+    // Packet Loss pattern: independent frames, or bursts (see PacketLossStage.h)
+    parameters.push_back(std::make_unique<juce::AudioParameterChoice>(
+        PACKET_LOSS_MODEL_ID,
+        "Loss Pattern",
+        juce::StringArray{"Random", "Bursty (Gilbert)", "Bursty (Gilbert-Elliott)"},
+        PacketLossStage::gilbertElliott
+    ));
+    
+    // Network Jitter (0 - 100 ms mean extra delay per packet). The playout delay this adds wanders
+    // on top of the reported latency, so only the fixed part is compensated: below 100% wet the
+    // call runs behind the dry signal by the current playout delay, as a real call would
+    parameters.push_back(std::make_unique<juce::AudioParameterFloat>(
+        JITTER_ID, "Network Jitter",
+        juce::NormalisableRange<float>(0.0f, 100.0f, 1.0f), 0.0f,
+        juce::String(), juce::AudioProcessorParameter::genericParameter,
+        [](float value, int) { return juce::String(static_cast<int>(value)) + " ms"; }
+    ));
+    
     // Call Position (0-6: Center, Left/Right Ear, Speaker Near/Far, Bluetooth L/R)
     parameters.push_back(std::make_unique<juce::AudioParameterFloat>(
         CALL_POSITION_ID, "Call Position", 
         juce::NormalisableRange<float>(0.0f, 6.0f, 1.0f), 0.0f
     ));
     
+    // Binaural Positioning (On/Off): ear and Bluetooth positions through head filters (see CallPositionStage.h)
+    parameters.push_back(std::make_unique<juce::AudioParameterFloat>(
+        CALL_POSITION_BINAURAL_ID, "Binaural Positioning",
+        juce::NormalisableRange<float>(0.0f, 1.0f, 1.0f), 0.0f,
+        juce::String(), juce::AudioProcessorParameter::genericParameter,
+        [](float value, int) { return value > 0.5f ? "ON" : "OFF"; }
+    ));
+    
     // Ambience Type (0-7: Silent, Café, Car, Street, Tube, Office, Train, Airport)
     parameters.push_back(std::make_unique<juce::AudioParameterFloat>(
         AMBIENCE_TYPE_ID, "Ambience Type",
@@ -248,7 +407,9 @@ bool TestAudioProcessor::isMidiEffect() const
 
 double TestAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    // Beyond the latency, the jitter buffer's playout delay holds frames back for up to
+    // maxPlayoutDelay, and the handset responses ring on for as long as the loaded ones last
+    return JitterBufferStage::getMaxPlayoutDelaySamples() / telephoneRate + handsetResponse.getTailLengthSeconds();
 }
 
 int TestAudioProcessor::getNumPrograms()
@@ -290,15 +451,70 @@ void TestAudioProcessor::changeProgramName (int index, const juce::String& newNa
 void TestAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
     currentSampleRate = sampleRate;
+    maximumBlockSize = juce::jmax(1, samplesPerBlock);
+    
+    const int numScratchChannels = juce::jmax(getTotalNumInputChannels(), getTotalNumOutputChannels());
+    
+    // The degradation stages run in the telephone band, at the rate GSM and AMR code at. The codec's
+    // one-frame delay, the jitter buffer's packetising, the packet loss stage's hold-back and the band's
+    // resampling filters and queue are the plugin's latency - tell the host
+    codecStage.prepare(numScratchChannels);
+    packetLossStage.prepare(numScratchChannels);
+    narrowband.prepare(sampleRate, telephoneRate, numScratchChannels, maximumBlockSize,
+                       codecStage.getLatencySamples() + jitterBufferStage.getLatencySamples() + packetLossStage.getLatencySamples());
+    jitterBufferStage.prepare(numScratchChannels, narrowband.getMaxNarrowbandSamples());
+    setLatencySamples(narrowband.getLatencySamples());
+    
+    // Size every scratch buffer up front - processBlock must never touch the heap
+    const int maxNarrowbandSamples = narrowband.getMaxNarrowbandSamples();
+    dryBuffer.setSize(numScratchChannels, maximumBlockSize, false, true, false);
+    narrowbandBuffer.setSize(numScratchChannels, maxNarrowbandSamples, false, true, false);
+    noiseScratch.setSize(1, maxNarrowbandSamples, false, true, false);
+    toneScratch.setSize(1, maxNarrowbandSamples, false, true, false);
+    
+    // Restart every noise stream: same seed, same noise (see setNoiseSeed)
+    noise.seed(static_cast<juce::uint64>(noiseSeed.load()));
+    
+    // Ambience loops stream into the telephone band from disk; each instance starts them somewhere else
+    ambienceBuffer.setSize(1, maxNarrowbandSamples, false, true, false);
+    ambienceLoops.setStartPosition(noise.ambience.nextFloat());
+    ambienceLoops.prepare(telephoneRate, maxNarrowbandSamples);
+    
+    // Handset responses: the current phone's are loaded before playback starts, later changes in the background
+    const int phoneTypeIndex = juce::roundToInt(phoneTypeParam->load()); // The parameter runs 0-2
+    handsetResponse.prepare(numScratchChannels, maxNarrowbandSamples, juce::jlimit(0, 2, phoneTypeIndex));
+    
+    // Call positioning runs back at the host rate; it starts where the parameters are, without a ramp
+    callPositionStage.setPosition(static_cast<int>(callPositionParam->load() + 0.5f), callPositionBinauralParam->load() > 0.5f);
+    callPositionStage.prepare(sampleRate, maximumBlockSize);
+    
+    // Meters fall back to silence
+    inputMeter.prepare(sampleRate);
+    wetMeter.prepare(sampleRate);
+    outputMeter.prepare(sampleRate);
+    spectrumAnalyser.prepare(sampleRate);
+    
+    // Prepare DSP components: design every low-cut/high-cut setting for the telephone band once.
+    // Every high cut lies inside the band, so each choice does something.
+    std::array<float, CachedIIRFilter::numChoices> lowCutFrequencies, highCutFrequencies;
+    for (int i = 0; i < CachedIIRFilter::numChoices; ++i)
+    {
+        lowCutFrequencies[(size_t) i] = getLowCutFrequency(i);
+        highCutFrequencies[(size_t) i] = getHighCutFrequency(i);
+        jassert(highCutFrequencies[(size_t) i] < telephoneRate * 0.5);
+    }
     
-    // Prepare DSP components
-    juce::dsp::ProcessSpec spec;
-    spec.sampleRate = sampleRate;
-    spec.maximumBlockSize = static_cast<juce::uint32>(samplesPerBlock);
-    spec.numChannels = static_cast<juce::uint32>(getTotalNumOutputChannels());
+    lowCutFilter.prepare(telephoneRate, numScratchChannels, lowCutFrequencies);
+    highCutFilter.prepare(telephoneRate, numScratchChannels, highCutFrequencies);
     
-    lowCutFilter.prepare(spec);
-    highCutFilter.prepare(spec);
+    // Interference tones keep their phase across blocks (2kHz RF buzz)
+    interferenceOscillators.setFrequency(rfOscillator, 2000.0);
+    interferenceOscillators.prepare(telephoneRate);
+    
+    // Signal strength restarts at the chosen quality
+    signalQuality.setQuality(juce::jlimit(0, 5, static_cast<int>(interferencePresetParam->load() + 0.5f)), phoneTypeIndex);
+    signalQuality.prepare(telephoneRate, maxNarrowbandSamples);
+    currentSignalStrength = signalQuality.getSignalStrength();
     
     // Reset effect states
     gsmPhase = 0.0f;
@@ -307,22 +523,33 @@ void TestAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
     hissLevel = 0.0f;
     hissPhase = 0.0f;
     
-    // Initialize tonal coloring phases
+    // Initialize tonal coloring phases (their steps were voiced per sample at 44.1kHz)
     nokiaDigitalPhase = 0.0f;
     iphoneWarmthPhase = 0.0f;
     sonyAnalogPhase = 0.0f;
+    tonalPhaseScale = static_cast<float>(44100.0 / telephoneRate);
     
-    // Initialize TV interference state
-    tvInterferencePhase = 0.0f;
-    tvScanlinePhase = 0.0f;
-    tvBurstTimer = 0.0f;
-    tvBurstState = 0;
+    // TV interference state belongs to this instance only
+    tvGenerator.prepare(telephoneRate);
 }
 
 void TestAudioProcessor::releaseResources()
 {
     lowCutFilter.reset();
     highCutFilter.reset();
+    codecStage.reset();
+    jitterBufferStage.reset();
+    packetLossStage.reset();
+    narrowband.reset();
+    
+    dryBuffer.setSize(0, 0);
+    narrowbandBuffer.setSize(0, 0);
+    noiseScratch.setSize(0, 0);
+    toneScratch.setSize(0, 0);
+    ambienceBuffer.setSize(0, 0);
+    ambienceLoops.release();
+    handsetResponse.release();
+    maximumBlockSize = 0;
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -349,6 +576,8 @@ bool TestAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) con
 void TestAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer&)
 {
     juce::ScopedNoDenormals noDenormals;
+    RealtimeAllocationTracker::ScopedRealtimeSection realtimeSection; // Debug builds assert on any heap access below
+    
     auto totalNumInputChannels = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
@@ -359,98 +588,277 @@ void TestAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::M
     if (totalNumInputChannels == 0)
         return;
 
-    // Get current parameter values
-    float lowCutFreq = lowCutParam->load();
-    float highCutFreq = highCutParam->load();
+    if (maximumBlockSize <= 0)
+    {
+        jassertfalse; // processBlock called before prepareToPlay
+        return;
+    }
+
+    const int numSamples = buffer.getNumSamples();
+    inputMeter.measure(buffer.getArrayOfReadPointers(), totalNumInputChannels, numSamples);
+    
+    if (numSamples <= maximumBlockSize)
+    {
+        processSubBlock(buffer);
+    }
+    else
+    {
+        // Some hosts occasionally deliver more samples than announced in prepareToPlay.
+        // Process those in prepared-size slices instead of growing buffers on the audio thread.
+        // (Referencing buffers use AudioBuffer's preallocated channel table, so no allocation.)
+        for (int startSample = 0; startSample < numSamples; startSample += maximumBlockSize)
+        {
+            const int numThisTime = juce::jmin(maximumBlockSize, numSamples - startSample);
+            juce::AudioBuffer<float> slice(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), startSample, numThisTime);
+            processSubBlock(slice);
+        }
+    }
+    
+    outputMeter.measure(buffer.getArrayOfReadPointers(), totalNumInputChannels, numSamples);
+    spectrumAnalyser.pushSamples(buffer.getArrayOfReadPointers(), totalNumInputChannels, numSamples);
+    
+    // Once per block, the GUI's view of what just happened
+    Telemetry snapshot;
+    snapshot.input = inputMeter.getLevels();
+    snapshot.wet = wetMeter.getLevels();
+    snapshot.output = outputMeter.getLevels();
+    snapshot.signalStrength = currentSignalStrength;
+    snapshot.signalBars = signalBars;
+    snapshot.voiceActivity = voiceActivityLevel;
+    snapshot.droppingOut = isInDropout;
+    snapshot.concealingLoss = packetLossStage.isConcealing();
+    telemetry.write(snapshot);
+}
+
+void TestAudioProcessor::processSubBlock (juce::AudioBuffer<float>& buffer)
+{
+    auto totalNumInputChannels = getTotalNumInputChannels();
+    jassert(buffer.getNumSamples() <= dryBuffer.getNumSamples());
+    jassert(totalNumInputChannels <= dryBuffer.getNumChannels());
+
+    // Get current parameter values (low/high cut are discrete choice indices 0-4)
+    int lowCutIndex = juce::jlimit(0, CachedIIRFilter::numChoices - 1, static_cast<int>(lowCutParam->load() + 0.5f));
+    int highCutIndex = juce::jlimit(0, CachedIIRFilter::numChoices - 1, static_cast<int>(highCutParam->load() + 0.5f));
     float distortionLevel = distortionParam->load();
     float interferenceLevel = interferenceParam->load();
     float compressionLevel = compressionParam->load();
     bool tvInterferenceOn = tvInterferenceParam->load() > 0.5f;
     float wetDryMix = wetDryMixParam->load(); // NEW: Wet/Dry mix - THE MISSING PIECE!
-    int phoneTypeIndex = static_cast<int>(phoneTypeParam->load() * 2.0f + 0.5f); // Convert 0-1 to 0-2
+    int phoneTypeIndex = juce::roundToInt(phoneTypeParam->load()); // The parameter runs 0-2
     PhoneType currentPhoneType = static_cast<PhoneType>(juce::jlimit(0, 2, phoneTypeIndex));
+    CodecType codecType = static_cast<CodecType>(juce::jlimit(0, 6, static_cast<int>(codecTypeParam->load() + 0.5f)));
+    float packetLossAmount = packetLossParam->load();
+    float jitterMs = jitterParam->load();
+    AmbienceType ambienceType = static_cast<AmbienceType>(juce::jlimit(0, 7, static_cast<int>(ambienceTypeParam->load() + 0.5f)));
+    float ambienceAmount = ambienceLevelParam->load();
+    auto packetLossModel = static_cast<PacketLossStage::Model>(juce::jlimit(0, 2, static_cast<int>(packetLossModelParam->load() + 0.5f)));
+    CallPosition callPosition = static_cast<CallPosition>(juce::jlimit(0, 6, static_cast<int>(callPositionParam->load() + 0.5f)));
+    bool binauralPositioning = callPositionBinauralParam->load() > 0.5f;
+    SignalQuality signalQualitySetting = static_cast<SignalQuality>(juce::jlimit(0, 5, static_cast<int>(interferencePresetParam->load() + 0.5f)));
+
+    // Coefficients come from the per-sample-rate cache; a changed setting crossfades in
+    lowCutFilter.setChoice(lowCutIndex);
+    highCutFilter.setChoice(highCutIndex);
+
+    StageSettings settings;
+    settings.phoneType = currentPhoneType;
+    settings.codec = codecType;
+    settings.distortion = distortionLevel;
+    settings.compression = compressionLevel;
+    settings.interference = interferenceLevel;
+    settings.tvInterference = tvInterferenceOn;
+    settings.wetDryMix = wetDryMix;
+
+    // PHASE 0: Into the telephone band - every stage from here to PHASE 7 runs at 8kHz, like the
+    // phone network, on a fraction of the host's samples. The dry copy for the wet/dry mix comes
+    // back delayed by the band's latency, so the mix stays phase aligned.
+    const int numSamples = buffer.getNumSamples();
+    const int numNarrowband = narrowband.downsample(buffer.getArrayOfReadPointers(), dryBuffer.getArrayOfWritePointers(),
+                                                    totalNumInputChannels, numSamples, narrowbandBuffer.getArrayOfWritePointers());
+    juce::AudioBuffer<float> telephoneBand(narrowbandBuffer.getArrayOfWritePointers(), totalNumInputChannels, numNarrowband);
+
+    // Ambience - the caller's surroundings reach the phone's microphone along with their voice,
+    // so the codec and the network treat both alike
+    generateBackgroundAmbience(telephoneBand, ambienceType, ambienceAmount);
+    
+    // Microphone - voice and surroundings alike are heard through the phone's own microphone
+    handsetResponse.setPhone(currentPhoneType);
+    handsetResponse.process(HandsetResponseStage::microphone, telephoneBand.getArrayOfWritePointers(), totalNumInputChannels, numNarrowband);
+
+    // Codec - the caller's voice is encoded a frame at a time before the handset and line stages
+    // colour it. Full strength: the mix sets how much is heard. The AMR codecs pick their rate
+    // each frame from the current signal strength.
+    codecStage.setSignalStrength(currentSignalStrength);
+    codecStage.process(telephoneBand.getArrayOfWritePointers(), totalNumInputChannels, numNarrowband,
+                       getCodecStageType(settings.codec), 1.0f, noise.codec);
+
+    // Network - the coded frames cross it with varying delay into the receiver's jitter buffer, and
+    // the receiver conceals the ones that are lost or too late. Always run, so their fixed delays stay
+    // in the reported latency.
+    applyJitter(telephoneBand, totalNumInputChannels, jitterMs);
+    applyPacketLoss(telephoneBand, totalNumInputChannels, packetLossModel, packetLossAmount);
+    
+    // Radio link - the signal strength moves (Auto Dynamic) or holds at the chosen quality, and a weak
+    // one breaks the call up. The codec follows the strength from the next block on.
+    applySignalQuality(telephoneBand, totalNumInputChannels, currentPhoneType, signalQualitySetting);
+
+    if (processingMode.load() == Staged)
+        processStaged(telephoneBand, totalNumInputChannels, settings);
+    else
+        processFusedStages(telephoneBand, totalNumInputChannels, settings);
 
-    // PHASE 1: Store original signal for wet/dry mixing
-    juce::AudioBuffer<float> originalBuffer;
-    originalBuffer.makeCopyOf(buffer); // Store clean input signal
+    // Speaker - the listener hears the call through the same phone's earpiece
+    handsetResponse.process(HandsetResponseStage::speaker, telephoneBand.getArrayOfWritePointers(), totalNumInputChannels, numNarrowband);
 
-    // PHASE 2: Apply filters (low-cut and high-cut)
-    juce::dsp::AudioBlock<float> block(buffer);
-    juce::dsp::ProcessContextReplacing<float> context(block);
-
-    // Low-cut filter
-    if (lowCutFreq > 20.0f) {
-        auto lowCutCoeffs = juce::dsp::IIR::Coefficients<float>::makeHighPass(getSampleRate(), lowCutFreq);
-        lowCutFilter.state = *lowCutCoeffs;
-        lowCutFilter.process(context);
-    }
+    // PHASE 7: Back to the host rate, where the call is placed in the stereo field, then the WET/DRY MIX
+    narrowband.upsample(telephoneBand.getArrayOfReadPointers(), numNarrowband, buffer.getArrayOfWritePointers(),
+                        totalNumInputChannels, numSamples);
+    applyStereoPositioning(buffer, totalNumInputChannels, callPosition, binauralPositioning);
+    wetMeter.measure(buffer.getArrayOfReadPointers(), totalNumInputChannels, numSamples);
 
-    // High-cut filter
-    if (highCutFreq < 20000.0f) {
-        auto highCutCoeffs = juce::dsp::IIR::Coefficients<float>::makeLowPass(getSampleRate(), highCutFreq);
-        highCutFilter.state = *highCutCoeffs;
-        highCutFilter.process(context);
+    // The dry copy is delayed by the band's fixed latency only. The jitter buffer's playout delay
+    // changes from frame to frame, so no fixed dry delay could follow it: with jitter on, the wet
+    // signal trails the dry by the current playout delay (up to getMaxPlayoutDelaySamples()).
+    for (int channel = 0; channel < totalNumInputChannels; ++channel) {
+        auto* processedData = buffer.getWritePointer(channel);
+        juce::FloatVectorOperations::multiply(processedData, settings.wetDryMix, numSamples);
+        juce::FloatVectorOperations::addWithMultiply(processedData, dryBuffer.getReadPointer(channel), 1.0f - settings.wetDryMix, numSamples);
     }
+}
 
-    // PHASE 3: Apply phone-specific distortion/saturation
-    if (distortionLevel > 0.01f) {
-        for (int channel = 0; channel < totalNumInputChannels; ++channel) {
-            auto* channelData = buffer.getWritePointer(channel);
-            for (int sample = 0; sample < buffer.getNumSamples(); ++sample) {
-                float input = channelData[sample];
-                
-                // Apply authentic phone-specific distortion characteristics
-                float phoneDistorted = applyPhoneDistortion(input, currentPhoneType, distortionLevel);
-                channelData[sample] = phoneDistorted;
+// Runs the fused loop compiled for exactly the stages that are switched on
+void TestAudioProcessor::processFusedStages (juce::AudioBuffer<float>& buffer, int numChannels, const StageSettings& settings)
+{
+    // Inactive stages are dropped here, once per block, by picking the loop compiled without them
+    int stageMask = 0;
+    if (settings.distortion > 0.01f)   stageMask |= distortionStage;
+    if (settings.compression > 0.01f)  stageMask |= compressionStage;
+    if (settings.interference > 0.01f) stageMask |= interferenceStage;
+    if (settings.tvInterference)       stageMask |= tvStage;
+
+    static constexpr FusedProcessor fusedProcessors[numFusedStageCombinations] =
+    {
+        &TestAudioProcessor::processFused<0>,  &TestAudioProcessor::processFused<1>,  &TestAudioProcessor::processFused<2>,  &TestAudioProcessor::processFused<3>,
+        &TestAudioProcessor::processFused<4>,  &TestAudioProcessor::processFused<5>,  &TestAudioProcessor::processFused<6>,  &TestAudioProcessor::processFused<7>,
+        &TestAudioProcessor::processFused<8>,  &TestAudioProcessor::processFused<9>,  &TestAudioProcessor::processFused<10>, &TestAudioProcessor::processFused<11>,
+        &TestAudioProcessor::processFused<12>, &TestAudioProcessor::processFused<13>, &TestAudioProcessor::processFused<14>, &TestAudioProcessor::processFused<15>
+    };
+
+    (this->*fusedProcessors[stageMask])(buffer, numChannels, settings);
+}
+
+//==============================================================================
+// FUSED PIPELINE: every stage runs back to back on one sample while it sits in a register.
+// The block is walked in small tiles so the filters (which are block based) leave their
+// output in L1 for the per-sample loop, instead of each stage re-reading the whole buffer.
+template <int stageMask>
+void TestAudioProcessor::processFused (juce::AudioBuffer<float>& buffer, int numChannels, const StageSettings& settings)
+{
+    const int numSamples = buffer.getNumSamples();
+
+    for (int tileStart = 0; tileStart < numSamples; tileStart += fusedTileSize) {
+        const int tileLength = juce::jmin(fusedTileSize, numSamples - tileStart);
+        juce::AudioBuffer<float> tile(buffer.getArrayOfWritePointers(), numChannels, tileStart, tileLength);
+
+        // Filters on this tile only (the dry copy was taken on the way into the telephone band)
+        lowCutFilter.process(tile, numChannels);
+        highCutFilter.process(tile, numChannels);
+
+        // The RF tone is shared by every channel, so render it once per tile
+        float rfTone[fusedTileSize];
+
+        if constexpr ((stageMask & interferenceStage) != 0)
+            interferenceOscillators.render(rfOscillator, rfTone, tileLength);
+
+        // Same for the TV buzz
+        float tvBuzz[fusedTileSize];
+
+        if constexpr ((stageMask & tvStage) != 0)
+            tvGenerator.render(tvBuzz, tileLength, getTVInterferenceModel(settings.phoneType), 1.0f, noise.tv);
+
+        for (int channel = 0; channel < numChannels; ++channel) {
+            auto* channelData = tile.getWritePointer(channel);
+
+            // Distortion runs as a SIMD kernel over the tile before the per-sample stages
+            if constexpr ((stageMask & distortionStage) != 0)
+                applyDistortionKernel(channelData, tileLength, settings);
+
+            // Noise for the tile comes from the stage's own stream in one block fill
+            float interferenceNoise[fusedTileSize];
+
+            if constexpr ((stageMask & interferenceStage) != 0)
+                noise.interference.fillBipolar(interferenceNoise, tileLength, settings.interference * 0.015f);
+
+            for (int sample = 0; sample < tileLength; ++sample) {
+                float x = channelData[sample];
+
+                if constexpr ((stageMask & compressionStage) != 0)
+                    x = applyPhoneCompression(x, settings.phoneType, settings.compression);
+
+                if constexpr ((stageMask & interferenceStage) != 0)
+                    x += nextInterferenceSample(rfTone[sample], interferenceNoise[sample], settings);
+
+                if constexpr ((stageMask & tvStage) != 0)
+                    x += tvBuzz[sample];
+
+                x = applyPhoneTonalColor(x, settings.phoneType, 1.0f);
+
+                channelData[sample] = x;
             }
         }
     }
+}
+
+//==============================================================================
+// STAGED PIPELINE: the original one-sweep-per-stage path, kept selectable for A/B checks
+void TestAudioProcessor::processStaged (juce::AudioBuffer<float>& buffer, int totalNumInputChannels, const StageSettings& settings)
+{
+    // PHASE 1: Original signal for wet/dry mixing is already in dryBuffer, and the mix itself
+    // happens back at the host rate (see processSubBlock)
+
+    // PHASE 2: Apply filters (low-cut and high-cut)
+    lowCutFilter.process(buffer, totalNumInputChannels);
+    highCutFilter.process(buffer, totalNumInputChannels);
+
+    // PHASE 3: Apply phone-specific distortion/saturation
+    if (settings.distortion > 0.01f) {
+        for (int channel = 0; channel < totalNumInputChannels; ++channel)
+            applyDistortionKernel(buffer.getWritePointer(channel), buffer.getNumSamples(), settings);
+    }
 
     // PHASE 4: Apply phone-specific compression/limiting
-    if (compressionLevel > 0.01f) {
+    if (settings.compression > 0.01f) {
         for (int channel = 0; channel < totalNumInputChannels; ++channel) {
             auto* channelData = buffer.getWritePointer(channel);
             for (int sample = 0; sample < buffer.getNumSamples(); ++sample) {
                 float input = channelData[sample];
                 
                 // Apply authentic phone-specific compression characteristics
-                float phoneCompressed = applyPhoneCompression(input, currentPhoneType, compressionLevel);
+                float phoneCompressed = applyPhoneCompression(input, settings.phoneType, settings.compression);
                 channelData[sample] = phoneCompressed;
             }
         }
     }
 
     // PHASE 5: Apply interference/artifacts
-    if (interferenceLevel > 0.01f) {
+    if (settings.interference > 0.01f) {
+        auto* stageNoise = noiseScratch.getWritePointer(0);
+        auto* rfTone = toneScratch.getWritePointer(0);
+        interferenceOscillators.render(rfOscillator, rfTone, buffer.getNumSamples());
         for (int channel = 0; channel < totalNumInputChannels; ++channel) {
             auto* channelData = buffer.getWritePointer(channel);
-            for (int sample = 0; sample < buffer.getNumSamples(); ++sample) {
-                // Digital quantization artifacts
-                float localQuantizationNoise = (random.nextFloat() - 0.5f) * interferenceLevel * 0.03f;
-                
-                // RF interference (high-frequency buzzing)
-                float rfNoise = std::sin(2.0f * juce::MathConstants<float>::pi * 2000.0f * sample / getSampleRate()) * interferenceLevel * 0.02f;
-                
-                channelData[sample] += localQuantizationNoise + rfNoise;
-            }
+            noise.interference.fillBipolar(stageNoise, buffer.getNumSamples(), settings.interference * 0.015f);
+            for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+                channelData[sample] += nextInterferenceSample(rfTone[sample], stageNoise[sample], settings);
         }
     }
 
     // PHASE 6: Apply TV interference (if enabled)
-    if (tvInterferenceOn) {
-        static int tvSampleCounter = 0;
-        
-        for (int channel = 0; channel < totalNumInputChannels; ++channel) {
-            auto* channelData = buffer.getWritePointer(channel);
-            for (int sample = 0; sample < buffer.getNumSamples(); ++sample) {
-                // SAFE TV interference (much reduced amplitude)
-                float horizontalSync = std::sin(2.0f * juce::MathConstants<float>::pi * 1000.0f * tvSampleCounter / getSampleRate()) * 0.03f; // Reduced from 0.15f
-                float verticalNoise = (random.nextFloat() - 0.5f) * 0.015f; // Much safer amplitude
-                
-                channelData[sample] += horizontalSync + verticalNoise;
-                tvSampleCounter++;
-            }
-        }
+    if (settings.tvInterference) {
+        auto* tvBuzz = toneScratch.getWritePointer(0);
+        tvGenerator.render(tvBuzz, buffer.getNumSamples(), getTVInterferenceModel(settings.phoneType), 1.0f, noise.tv);
+        for (int channel = 0; channel < totalNumInputChannels; ++channel)
+            juce::FloatVectorOperations::add(buffer.getWritePointer(channel), tvBuzz, buffer.getNumSamples());
     }
 
     // PHASE 6.5: Apply phone-specific tonal coloring (THE MISSING PIECE!)
@@ -460,23 +868,65 @@ void TestAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::M
             float input = channelData[sample];
             
             // Apply authentic phone-specific tonal characteristics
-            float phoneColored = applyPhoneTonalColor(input, currentPhoneType, 1.0f);
+            float phoneColored = applyPhoneTonalColor(input, settings.phoneType, 1.0f);
             channelData[sample] = phoneColored;
         }
     }
+}
 
-    // PHASE 7: WET/DRY MIX - THE MISSING PIECE! 🔥
-    for (int channel = 0; channel < totalNumInputChannels; ++channel) {
-        auto* processedData = buffer.getWritePointer(channel);
-        const auto* originalData = originalBuffer.getReadPointer(channel);
-        
-        for (int sample = 0; sample < buffer.getNumSamples(); ++sample) {
-            // Mix original (dry) with processed (wet) signal
-            processedData[sample] = originalData[sample] * (1.0f - wetDryMix) + processedData[sample] * wetDryMix;
+//==============================================================================
+// Phone distortion for a run of samples: the phone type is fixed for the block, so pick
+// its SIMD waveshaper once instead of switching per sample (applyPhoneDistortion is the
+// scalar reference these kernels are verified against)
+void TestAudioProcessor::applyDistortionKernel (float* data, int numSamples, const StageSettings& settings)
+{
+    switch (settings.phoneType)
+    {
+        case Nokia:
+        {
+            if (settings.distortion <= 0.3f) {
+                PhoneWaveshaper::processNokia(data, nullptr, numSamples, settings.distortion);
+                break;
+            }
+
+            // Quantization noise is drawn up front so the kernel itself stays branch and call free
+            float quantizationNoise[fusedTileSize];
+
+            for (int start = 0; start < numSamples; start += fusedTileSize) {
+                const int numThisTime = juce::jmin(fusedTileSize, numSamples - start);
+                noise.distortion.fillBipolar(quantizationNoise, numThisTime, 0.001f * settings.distortion);
+
+                PhoneWaveshaper::processNokia(data + start, quantizationNoise, numThisTime, settings.distortion);
+            }
+            break;
         }
+
+        case iPhone:
+            PhoneWaveshaper::processIPhone(data, numSamples, settings.distortion);
+            break;
+
+        case SonyEricsson:
+            PhoneWaveshaper::processSonyEricsson(data, numSamples, settings.distortion);
+            break;
+
+        default:
+            break;
     }
 }
 
+//==============================================================================
+// Per-sample stage generators shared by the fused and staged pipelines.
+// Their noise is block-filled by the caller from the stage's own stream.
+float TestAudioProcessor::nextInterferenceSample (float rfTone, float localQuantizationNoise, const StageSettings& settings)
+{
+    // Digital quantization artifacts arrive in localQuantizationNoise (+/- 0.015 * interference)
+
+    // RF interference (high-frequency buzzing)
+    float rfNoise = rfTone * settings.interference * 0.02f;
+
+    return localQuantizationNoise + rfNoise;
+}
+
 //==============================================================================
 // AUTHENTIC INTERFERENCE METHODS (REPLACED BY DYNAMIC SIGNAL STRENGTH - COMMENTED OUT)
 
@@ -534,7 +984,7 @@ float TestAudioProcessor::applyPhoneDistortion(float input, PhoneType phoneType,
             // MUCH LESS quantization noise (was too buzzy!)
             if (amount > 0.3f) // FIXED: Only add at higher settings
             {
-                float localQuantizationNoise = (random.nextFloat() * 2.0f - 1.0f) * 0.001f * amount; // FIXED: Much quieter
+                float localQuantizationNoise = (noise.distortion.nextFloat() * 2.0f - 1.0f) * 0.001f * amount; // FIXED: Much quieter
                 clipped += localQuantizationNoise;
             }
             
@@ -635,7 +1085,7 @@ float TestAudioProcessor::applyNokiaTonalColor(float input, float intensity)
     // Nokia 3310: Digital bite with mid-range punch
     // Characteristic: Aggressive digital compression with 800Hz-2kHz emphasis
     
-    nokiaDigitalPhase += 0.01f;
+    nokiaDigitalPhase += 0.01f * tonalPhaseScale;
     
     // Add subtle digital "bite" - much more subtle
     float digitalBite = std::sin(nokiaDigitalPhase * 3.7f) * 0.015f * intensity; // Reduced from 0.08f
@@ -654,7 +1104,7 @@ float TestAudioProcessor::applyIPhoneTonalColor(float input, float intensity)
     // iPhone: Warm digital clarity with smooth compression
     // Characteristic: Clean, warm digital processing with subtle harmonics
     
-    iphoneWarmthPhase += 0.008f;
+    iphoneWarmthPhase += 0.008f * tonalPhaseScale;
     
     // Add warm digital harmonics - more subtle
     float warmth = std::sin(iphoneWarmthPhase * 2.1f) * 0.01f * intensity; // Reduced from 0.04f
@@ -673,7 +1123,7 @@ float TestAudioProcessor::applySonyEricssonTonalColor(float input, float intensi
     // Sony Ericsson: Analog grit with tape-like saturation
     // Characteristic: Warm analog distortion with slight wow/flutter
     
-    sonyAnalogPhase += 0.012f + (random.nextFloat() * 0.001f); // Reduced flutter
+    sonyAnalogPhase += (0.012f + (noise.tonalColor.nextFloat() * 0.001f)) * tonalPhaseScale; // Reduced flutter
     
     // Add analog grit and warmth - much more subtle
     float analogGrit = std::sin(sonyAnalogPhase * 1.8f) * 0.02f * intensity; // Reduced from 0.12f
@@ -687,14 +1137,15 @@ float TestAudioProcessor::applySonyEricssonTonalColor(float input, float intensi
 //==============================================================================
 void TestAudioProcessor::loadPhonePreset(PhoneType phoneType)
 {
+    // The cut parameters are choice indices (see getLowCutFrequency/getHighCutFrequency), not Hz
     switch (phoneType)
     {
         case Nokia:
             // Nokia 3310 - Classic GSM characteristics
             apvts.getParameter(LOW_CUT_ID)->setValueNotifyingHost(
-                apvts.getParameter(LOW_CUT_ID)->convertTo0to1(400.0f));
+                apvts.getParameter(LOW_CUT_ID)->convertTo0to1(4.0f)); // Index 4: 400Hz
             apvts.getParameter(HIGH_CUT_ID)->setValueNotifyingHost(
-                apvts.getParameter(HIGH_CUT_ID)->convertTo0to1(4000.0f));
+                apvts.getParameter(HIGH_CUT_ID)->convertTo0to1(4.0f)); // Index 4: 3.6kHz, the top of the band
             
             // FIX: Immediately update ALL parameters (no carryover)
             apvts.getParameter(DISTORTION_ID)->setValueNotifyingHost(0.2f);    // 20% - Small speaker distortion
@@ -705,9 +1156,9 @@ void TestAudioProcessor::loadPhonePreset(PhoneType phoneType)
         case iPhone:
             // iPhone - Modern smartphone with clean digital processing
             apvts.getParameter(LOW_CUT_ID)->setValueNotifyingHost(
-                apvts.getParameter(LOW_CUT_ID)->convertTo0to1(300.0f));
+                apvts.getParameter(LOW_CUT_ID)->convertTo0to1(3.0f)); // Index 3: 300Hz
             apvts.getParameter(HIGH_CUT_ID)->setValueNotifyingHost(
-                apvts.getParameter(HIGH_CUT_ID)->convertTo0to1(8000.0f));
+                apvts.getParameter(HIGH_CUT_ID)->convertTo0to1(4.0f)); // Index 4: 3.6kHz, the top of the band
             
             // FIX: Immediately update ALL parameters (no carryover)
             apvts.getParameter(DISTORTION_ID)->setValueNotifyingHost(0.03f);   // 3% - Minimal digital distortion
@@ -718,9 +1169,9 @@ void TestAudioProcessor::loadPhonePreset(PhoneType phoneType)
         case SonyEricsson:
             // Sony Ericsson - Vintage flip phone with analog circuits
             apvts.getParameter(LOW_CUT_ID)->setValueNotifyingHost(
-                apvts.getParameter(LOW_CUT_ID)->convertTo0to1(250.0f));
+                apvts.getParameter(LOW_CUT_ID)->convertTo0to1(2.0f)); // Index 2: 250Hz
             apvts.getParameter(HIGH_CUT_ID)->setValueNotifyingHost(
-                apvts.getParameter(HIGH_CUT_ID)->convertTo0to1(2500.0f));
+                apvts.getParameter(HIGH_CUT_ID)->convertTo0to1(1.0f)); // Index 1: 2.8kHz
             
             // FIX: Immediately update ALL parameters (no carryover)
             apvts.getParameter(DISTORTION_ID)->setValueNotifyingHost(0.35f);   // 35% - Tiny speaker, analog circuits
@@ -767,445 +1218,208 @@ void TestAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 //==============================================================================
 // TV INTERFERENCE METHODS (Phase 4: The TV Interference You've Been Waiting For!)
 
-float TestAudioProcessor::applyTVInterference(float input, PhoneType phoneType, float intensity)
+// The models live in TVInterferenceGenerator (one per instance, rendered a block at a time)
+TVInterferenceGenerator::Model TestAudioProcessor::getTVInterferenceModel(PhoneType phoneType)
 {
-    if (intensity < 0.5f) return input; // TV interference is OFF
-    
     switch (phoneType)
     {
-        case Nokia:
-            return generateNokiaTVInterference(input, intensity);
         case iPhone:
-            return generateIPhoneTVInterference(input, intensity);
+            return TVInterferenceGenerator::iPhoneLCD;
         case SonyEricsson:
-            return generateSonyTVInterference(input, intensity);
+            return TVInterferenceGenerator::sonyEricssonCRT;
+        case Nokia:
         default:
-            return input;
+            return TVInterferenceGenerator::nokiaCRT;
     }
 }
 
-float TestAudioProcessor::generateNokiaTVInterference(float input, float intensity)
+// Single-sample form, for per-sample callers
+float TestAudioProcessor::applyTVInterference(float input, PhoneType phoneType, float intensity)
 {
-    // Nokia 3310 near CRT TV: Classic GSM interference with TV scanline buzz
-    // FIX: Much safer levels to prevent speaker damage
-    
-    // TV scanline frequency reduced to safer range (1kHz instead of 15.625 kHz)
-    tvScanlinePhase += 2.0f * juce::MathConstants<float>::pi * 1000.0f / static_cast<float>(currentSampleRate);
-    
-    // GSM burst pattern interfering with TV
-    tvBurstTimer += 1.0f / static_cast<float>(currentSampleRate);
-    if (tvBurstTimer >= 0.0046f) // GSM burst every 4.6ms
-    {
-        tvBurstTimer = 0.0f;
-        tvBurstState = (tvBurstState + 1) % 4; // 4-state burst pattern
-    }
+    if (intensity < 0.5f) return input; // TV interference is OFF
     
-    // Generate authentic Nokia TV buzz - MUCH SAFER LEVELS
     float tvBuzz = 0.0f;
-    if (tvBurstState == 0 || tvBurstState == 2) // Active burst states
-    {
-        // 217Hz GSM carrier with TV scanline modulation
-        tvInterferencePhase += 2.0f * juce::MathConstants<float>::pi * 217.0f / static_cast<float>(currentSampleRate);
-        float gsmCarrier = std::sin(tvInterferencePhase);
-        float scanlineModulation = std::sin(tvScanlinePhase) * 0.1f; // Reduced from 0.3f
-        
-        // FIX: Much safer amplitude (0.03f instead of 0.15f)
-        tvBuzz = gsmCarrier * (0.8f + scanlineModulation) * 0.03f * intensity;
-        
-        // FIX: Much quieter digital clicking (0.02f instead of 0.2f)
-        if (tvRandom.nextFloat() > 0.98f) // Less frequent pops
-        {
-            tvBuzz += (tvRandom.nextFloat() * 2.0f - 1.0f) * 0.02f * intensity;
-        }
-    }
-    
+    tvGenerator.render(&tvBuzz, 1, getTVInterferenceModel(phoneType), intensity, noise.tv);
     return input + tvBuzz;
 }
 
-float TestAudioProcessor::generateIPhoneTVInterference(float input, float intensity)
-{
-    // iPhone near modern LCD/LED TV: Digital switching noise and power supply whine
-    // FIX: Much safer levels
-    
-    // LCD refresh rate interference (60Hz and harmonics)
-    tvScanlinePhase += 2.0f * juce::MathConstants<float>::pi * 60.0f / static_cast<float>(currentSampleRate);
-    tvInterferencePhase += 2.0f * juce::MathConstants<float>::pi * 120.0f / static_cast<float>(currentSampleRate);
-    
-    // Digital switching noise from iPhone's power management
-    float switchingNoise = std::sin(tvInterferencePhase) * 0.03f; // Reduced from 0.1f
-    float refreshNoise = std::sin(tvScanlinePhase) * 0.02f;       // Reduced from 0.05f
-    
-    // Combine with subtle digital artifacts - MUCH SAFER
-    float digitalBuzz = (switchingNoise + refreshNoise) * intensity * 0.02f; // Reduced from 0.08f
-    
-    // FIX: Much quieter occasional digital pops
-    if (tvRandom.nextFloat() > 0.998f) // Much less frequent
-    {
-        digitalBuzz += (tvRandom.nextFloat() * 2.0f - 1.0f) * 0.01f * intensity; // Reduced from 0.1f
-    }
-    
-    return input + digitalBuzz;
-}
-
-float TestAudioProcessor::generateSonyTVInterference(float input, float intensity)
-{
-    // Sony Ericsson near old CRT TV: Analog interference with magnetic field buzz
-    // FIX: Much safer levels
-    
-    // CRT horizontal sweep frequency reduced to safer range (500Hz instead of 15.625 kHz)
-    float flutterAmount = tvRandom.nextFloat() * 0.01f - 0.005f; // Reduced flutter
-    tvScanlinePhase += 2.0f * juce::MathConstants<float>::pi * (500.0f + flutterAmount * 50.0f) / static_cast<float>(currentSampleRate);
-    
-    // Magnetic field interference from CRT deflection coils
-    tvInterferencePhase += 2.0f * juce::MathConstants<float>::pi * 50.0f / static_cast<float>(currentSampleRate); // 50Hz mains hum
-    
-    // Generate analog TV interference - MUCH SAFER LEVELS
-    float magneticBuzz = std::sin(tvScanlinePhase) * 0.03f; // Reduced from 0.12f
-    float mainsHum = std::sin(tvInterferencePhase) * 0.02f; // Reduced from 0.06f
-    
-    // Add analog static and crackle - QUIETER
-    float analogStatic = (tvRandom.nextFloat() * 2.0f - 1.0f) * 0.01f; // Reduced from 0.03f
-    
-    // Combine all analog interference - MUCH SAFER
-    float analogInterference = (magneticBuzz + mainsHum + analogStatic) * intensity * 0.03f; // Reduced from 0.1f
-    
-    // FIX: Much quieter occasional analog pops
-    if (tvRandom.nextFloat() > 0.995f) // Less frequent
-    {
-        analogInterference += (tvRandom.nextFloat() * 2.0f - 1.0f) * 0.03f * intensity; // Reduced from 0.15f
-    }
-    
-    return input + analogInterference;
-}
-
 //==============================================================================
 // PHASE 5: ADVANCED AUDIO PROCESSING METHODS
 
 // Codec Simulation Methods
-float TestAudioProcessor::applyCodecSimulation(float input, CodecType codec, float intensity)
+void TestAudioProcessor::applyCodecSimulation(juce::AudioBuffer<float>& buffer, int numChannels, CodecType codec, float intensity)
 {
-    switch (codec)
-    {
-        case GSM_FullRate:
-            return applyGSMCodec(input, false, intensity);
-        case GSM_HalfRate:
-            return applyGSMCodec(input, true, intensity);
-        case CDMA_QCELP:
-            return applyCDMACodec(input, intensity);
-        case AMR_4_75:
-            return applyAMRCodec(input, 4.75f, intensity);
-        case AMR_12_2:
-            return applyAMRCodec(input, 12.2f, intensity);
-        case Early_VoIP:
-            return applyVoIPArtifacts(input, intensity);
-        case Digital_Artifact:
-            return applyVoIPArtifacts(input, intensity * 1.5f); // More extreme
-        default:
-            return input;
-    }
+    codecStage.process(buffer.getArrayOfWritePointers(), numChannels, buffer.getNumSamples(),
+                       getCodecStageType(codec), intensity, noise.codec);
 }
 
-float TestAudioProcessor::applyGSMCodec(float input, bool halfRate, float intensity)
+CodecStage::Codec TestAudioProcessor::getCodecStageType(CodecType codec)
 {
-    // GSM codec simulation: aggressive quantization and temporal artifacts
-    
-    // Quantization (8-bit to 13-bit depending on rate)
-    int quantLevels = halfRate ? 256 : 8192; // Half-rate = 8-bit, Full-rate = 13-bit
-    float quantized = std::round(input * quantLevels) / quantLevels;
-    
-    // Buffer for codec delay and artifacts
-    codecBuffer[codecBufferIndex] = quantized;
-    codecBufferIndex = (codecBufferIndex + 1) % 8;
-    
-    // GSM frame artifacts (20ms frames)
-    codecPhase += 1.0f / static_cast<float>(currentSampleRate);
-    if (codecPhase >= 0.02f) // 20ms frame
+    switch (codec)
     {
-        codecPhase = 0.0f;
-        quantizationNoise = (random.nextFloat() * 2.0f - 1.0f) * 0.02f;
+        case GSM_HalfRate:      return CodecStage::gsmHalfRate;
+        case CDMA_QCELP:        return CodecStage::cdmaQCELP;
+        case AMR_4_75:          return CodecStage::amr475;
+        case AMR_12_2:          return CodecStage::amr122;
+        case Early_VoIP:        return CodecStage::earlyVoIP;
+        case Digital_Artifact:  return CodecStage::digitalArtifact;
+        case GSM_FullRate:
+        default:                return CodecStage::gsmFullRate;
     }
-    
-    // Apply quantization noise and codec delay
-    float delayed = codecBuffer[(codecBufferIndex + 4) % 8]; // 4-sample delay
-    return juce::jlimit(-1.0f, 1.0f, delayed + quantizationNoise * intensity);
 }
 
-float TestAudioProcessor::applyCDMACodec(float input, float intensity)  
+// Packet Loss and Jitter Methods
+void TestAudioProcessor::applyPacketLoss(juce::AudioBuffer<float>& buffer, int numChannels, PacketLossStage::Model model, float lossAmount)
 {
-    // CDMA QCELP codec: variable rate with silence detection
-    
-    // Simulate voice activity detection
-    float threshold = 0.05f;
-    bool voiceActive = std::abs(input) > threshold;
-    
-    if (!voiceActive)
-    {
-        // Comfort noise generation during silence
-        return (random.nextFloat() * 2.0f - 1.0f) * 0.01f * intensity;
-    }
-    
-    // QCELP quantization (more aggressive than GSM)
-    int quantLevels = 512; // 9-bit equivalent
-    float quantized = std::round(input * quantLevels) / quantLevels;
-    
-    // Add CDMA-specific digital artifacts
-    codecPhase += 2.0f * juce::MathConstants<float>::pi * 8000.0f / static_cast<float>(currentSampleRate);
-    float digitalNoise = std::sin(codecPhase) * 0.01f * intensity;
-    
-    return juce::jlimit(-1.0f, 1.0f, quantized + digitalNoise);
+    // Frames the jitter buffer played late (this block's, when it ran first) are concealed as well
+    packetLossStage.setLossModel(model, lossAmount);
+    packetLossStage.process(buffer.getArrayOfWritePointers(), numChannels, buffer.getNumSamples(), noise.network,
+                            jitterBufferStage.getFramesLate(), jitterBufferStage.getNumFramesStarted());
 }
 
-float TestAudioProcessor::applyAMRCodec(float input, float bitrate, float intensity)
+void TestAudioProcessor::applyJitter(juce::AudioBuffer<float>& buffer, int numChannels, float jitterMs)
 {
-    // AMR codec simulation based on bitrate
-    
-    // Lower bitrate = more aggressive compression
-    float compressionFactor = 12.2f / bitrate; // Scale based on max AMR rate
-    
-    // Quantization levels based on bitrate
-    int quantLevels = static_cast<int>(8192 / compressionFactor);
-    float quantized = std::round(input * quantLevels) / quantLevels;
-    
-    // AMR artifacts: spectral shaping and noise
-    codecPhase += 0.1f;
-    float spectralNoise = std::sin(codecPhase * 2.3f) * 0.005f * compressionFactor * intensity;
-    
-    // Frame-based artifacts (20ms AMR frames)
-    if (static_cast<int>(codecPhase * 50) % 40 == 0) // Every 20ms at 50Hz update
-    {
-        quantizationNoise = (random.nextFloat() * 2.0f - 1.0f) * 0.01f * compressionFactor;
-    }
-    
-    return juce::jlimit(-1.0f, 1.0f, quantized + spectralNoise + quantizationNoise * intensity);
+    jitterBufferStage.setJitter(jitterMs);
+    jitterBufferStage.process(buffer.getArrayOfWritePointers(), numChannels, buffer.getNumSamples(), noise.network);
 }
 
-float TestAudioProcessor::applyVoIPArtifacts(float input, float intensity)
+// Stereo Positioning Methods
+void TestAudioProcessor::applyStereoPositioning(juce::AudioBuffer<float>& buffer, int numChannels, CallPosition position, bool binaural)
 {
-    // Early VoIP artifacts: packet reconstruction, echo cancellation artifacts
-    
-    // Simulate packet reconstruction errors
-    if (random.nextFloat() > 0.995f)
-    {
-        // Packet reconstruction glitch
-        return reconstructionBuffer[reconstructionIndex] * 0.7f;
-    }
+    if (numChannels < 2) return; // Skip if not stereo
     
-    // Store in reconstruction buffer
-    reconstructionBuffer[reconstructionIndex] = input;
-    reconstructionIndex = (reconstructionIndex + 1) % 16;
-    
-    // Echo cancellation artifacts
-    float echoArtifact = reconstructionBuffer[(reconstructionIndex + 8) % 16] * 0.05f;
-    
-    // Internet jitter simulation
-    codecPhase += (1.0f + random.nextFloat() * 0.2f) / static_cast<float>(currentSampleRate);
-    float jitterNoise = std::sin(codecPhase * 4000.0f) * 0.02f * intensity;
-    
-    return juce::jlimit(-1.0f, 1.0f, input + echoArtifact + jitterNoise);
+    // The position is picked once per block; the stage ramps to it
+    callPositionStage.setPosition(position, binaural);
+    callPositionStage.process(buffer.getWritePointer(0), buffer.getWritePointer(1), buffer.getNumSamples());
 }
 
-// Packet Loss and Jitter Methods
-float TestAudioProcessor::applyPacketLoss(float input, float lossAmount)
+// Background Ambience Methods  
+void TestAudioProcessor::generateBackgroundAmbience(juce::AudioBuffer<float>& buffer, AmbienceType type, float level)
 {
-    // Simulate packet loss with realistic reconstruction
+    // No level, no loop: stopping it means it fades back in from its start point when turned up again
+    ambienceLoops.selectLoop(level > 0.0f ? static_cast<int>(type) : static_cast<int>(Silent));
     
-    packetLossTimer += 1.0f / static_cast<float>(currentSampleRate);
+    if (type == Silent || level <= 0.0f)
+        return;
     
-    // Packet loss probability based on lossAmount
-    if (packetLossTimer >= 0.02f) // Check every 20ms (packet boundary)
-    {
-        packetLossTimer = 0.0f;
-        packetDropped = random.nextFloat() < lossAmount;
-    }
+    // Offline renders wait for the loop reader; a live host never does
+    const bool waitForLoop = isNonRealtime();
     
-    if (packetDropped)
+    for (int start = 0; start < buffer.getNumSamples(); start += ambienceBuffer.getNumSamples())
     {
-        // Simulate packet reconstruction: linear interpolation or repetition
-        float lastGood = reconstructionBuffer[(reconstructionIndex + 15) % 16];
-        float nextEstimate = lastGood * 0.8f; // Decay estimate
+        const int numThisTime = juce::jmin(ambienceBuffer.getNumSamples(), buffer.getNumSamples() - start);
+        auto* ambience = ambienceBuffer.getWritePointer(0);
+        float gain = level;
+        
+        // The recorded loop if it is installed, otherwise the synthesised stand-in (kept subtle)
+        if (! ambienceLoops.read(ambience, numThisTime, waitForLoop))
+        {
+            synthesiseAmbience(ambience, numThisTime, type);
+            gain = level * 0.15f;
+        }
         
-        return nextEstimate;
+        // The phone's one microphone hears the same room on every channel
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+            juce::FloatVectorOperations::addWithMultiply(buffer.getWritePointer(channel, start), ambience, gain, numThisTime);
     }
-    
-    // Store good packet
-    reconstructionBuffer[reconstructionIndex] = input;
-    reconstructionIndex = (reconstructionIndex + 1) % 16;
-    
-    return input;
 }
 
-float TestAudioProcessor::applyJitter(float input, float jitterAmount)
+void TestAudioProcessor::synthesiseAmbience(float* destination, int numSamples, AmbienceType type)
 {
-    // Simulate network jitter with variable delay
-    
-    // Update jitter phase for modulation
-    jitterPhase += 2.0f * juce::MathConstants<float>::pi * 0.5f / static_cast<float>(currentSampleRate);
-    
-    // Calculate variable delay (0-63 samples based on jitter amount)
-    int maxDelay = static_cast<int>(jitterAmount * 63.0f);
-    int currentDelay = static_cast<int>((std::sin(jitterPhase) + 1.0f) * 0.5f * maxDelay);
-    
-    // Store input in delay line
-    jitterDelay[jitterWriteIndex] = input;
-    jitterWriteIndex = (jitterWriteIndex + 1) % 64;
+    // Phase steps, decays and event rates were voiced per sample at 44.1kHz; this runs in the telephone band
+    const float rateScale = tonalPhaseScale;
+    const float hornDecay = std::pow(0.95f, rateScale);
+    const float keyboardDecay = std::pow(0.8f, rateScale);
+    const float announcementDecay = std::pow(0.98f, rateScale);
     
-    // Read from delayed position
-    int readIndex = (jitterWriteIndex - currentDelay - 1 + 64) % 64;
-    
-    return jitterDelay[readIndex];
-}
-
-// Stereo Positioning Methods
-void TestAudioProcessor::applyStereoPositioning(juce::AudioBuffer<float>& buffer, CallPosition position, float intensity)
-{
-    if (buffer.getNumChannels() < 2) return; // Skip if not stereo
-    
-    auto* leftChannel = buffer.getWritePointer(0);
-    auto* rightChannel = buffer.getWritePointer(1);
-    
-    for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+    for (int sample = 0; sample < numSamples; ++sample)
     {
-        float left = leftChannel[sample];
-        float right = rightChannel[sample];
-        float mono = (left + right) * 0.5f;
+        float ambience = 0.0f;
         
-        switch (position)
+        switch (type)
         {
-            case LeftEar:
-                // Phone held to left ear
-                leftChannel[sample] = mono;
-                rightChannel[sample] = mono * 0.2f; // Slight bleed to right
+            case Cafe_Busy:
+                // Busy café: chatter, dishes, coffee machine
+                ambiencePhase[0] += (0.01f + noise.ambience.nextFloat() * 0.02f) * rateScale; // Chatter
+                ambiencePhase[1] += 0.003f * rateScale; // Low rumble
+                ambience = std::sin(ambiencePhase[0]) * 0.3f + 
+                          std::sin(ambiencePhase[1]) * 0.1f +
+                          (noise.ambience.nextFloat() * 2.0f - 1.0f) * 0.1f; // Random noise
                 break;
                 
-            case RightEar:
-                // Phone held to right ear  
-                rightChannel[sample] = mono;
-                leftChannel[sample] = mono * 0.2f; // Slight bleed to left
+            case Car_Highway:
+                // Car on highway: engine, wind, road noise
+                ambiencePhase[0] += 0.008f * rateScale; // Engine rumble
+                ambiencePhase[1] += 0.15f * rateScale;  // Wind noise
+                ambience = std::sin(ambiencePhase[0]) * 0.4f +
+                          std::sin(ambiencePhase[1]) * (noise.ambience.nextFloat() * 0.2f + 0.1f);
                 break;
                 
-            case Speaker_Near:
-                // Speakerphone close - slight stereo widening
-                leftChannel[sample] = left * 1.1f - right * 0.1f;
-                rightChannel[sample] = right * 1.1f - left * 0.1f;
+            case Street_Traffic:
+                // City street: cars, horns, general urban noise
+                ambiencePhase[0] += (0.005f + noise.ambience.nextFloat() * 0.01f) * rateScale;
+                if (noise.ambience.nextFloat() > 1.0f - 0.002f * rateScale) // Occasional car horn
+                {
+                    ambienceLevel[0] = 0.5f;
+                }
+                ambienceLevel[0] *= hornDecay; // Decay
+                ambience = std::sin(ambiencePhase[0]) * 0.2f + ambienceLevel[0];
                 break;
                 
-            case Speaker_Far:
-                // Speakerphone distant - more ambient
-                leftChannel[sample] = mono * 0.8f + left * 0.4f;
-                rightChannel[sample] = mono * 0.8f + right * 0.4f;
+            case Underground_Tube:
+                // London Underground: train rumble, announcements, echoes
+                ambiencePhase[0] += 0.003f * rateScale; // Deep rumble
+                ambiencePhase[1] += 0.02f * rateScale;  // Electrical hum
+                ambience = std::sin(ambiencePhase[0]) * 0.5f +
+                          std::sin(ambiencePhase[1]) * 0.1f +
+                          (noise.ambience.nextFloat() * 2.0f - 1.0f) * 0.05f;
                 break;
                 
-            case Bluetooth_Left:
-                // Bluetooth earpiece left
-                leftChannel[sample] = mono * 0.9f;
-                rightChannel[sample] = mono * 0.1f;
+            case Office_Quiet:
+                // Quiet office: air conditioning, keyboards, quiet conversations
+                ambiencePhase[0] += 0.001f * rateScale; // AC hum
+                if (noise.ambience.nextFloat() > 1.0f - 0.005f * rateScale) // Occasional keyboard
+                {
+                    ambienceLevel[1] = 0.1f;
+                }
+                ambienceLevel[1] *= keyboardDecay; // Quick decay
+                ambience = std::sin(ambiencePhase[0]) * 0.05f + ambienceLevel[1];
                 break;
                 
-            case Bluetooth_Right:
-                // Bluetooth earpiece right
-                rightChannel[sample] = mono * 0.9f;
-                leftChannel[sample] = mono * 0.1f;
+            case Train_Interior:
+            {
+                // Inside moving train: rhythmic clacking, gentle swaying
+                ambiencePhase[0] += 0.02f * rateScale;  // Track rhythm
+                ambiencePhase[1] += 0.004f * rateScale; // Train rumble
+                float trackRhythm = std::sin(ambiencePhase[0]) > 0.8f ? 0.2f : 0.0f;
+                ambience = trackRhythm + std::sin(ambiencePhase[1]) * 0.3f;
                 break;
+            }
                 
-            default: // Center
-                break;
-        }
-    }
-}
-
-// Background Ambience Methods  
-void TestAudioProcessor::generateBackgroundAmbience(juce::AudioBuffer<float>& buffer, AmbienceType type, float level)
-{
-    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
-    {
-        auto* channelData = buffer.getWritePointer(channel);
-        
-        for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
-        {
-            float ambience = 0.0f;
-            
-            switch (type)
-            {
-                case Cafe_Busy:
-                    // Busy café: chatter, dishes, coffee machine
-                    ambiencePhase[0] += 0.01f + ambienceRandom.nextFloat() * 0.02f; // Chatter
-                    ambiencePhase[1] += 0.003f; // Low rumble
-                    ambience = std::sin(ambiencePhase[0]) * 0.3f + 
-                              std::sin(ambiencePhase[1]) * 0.1f +
-                              (ambienceRandom.nextFloat() * 2.0f - 1.0f) * 0.1f; // Random noise
-                    break;
-                    
-                case Car_Highway:
-                    // Car on highway: engine, wind, road noise
-                    ambiencePhase[0] += 0.008f; // Engine rumble
-                    ambiencePhase[1] += 0.15f;  // Wind noise
-                    ambience = std::sin(ambiencePhase[0]) * 0.4f +
-                              std::sin(ambiencePhase[1]) * (ambienceRandom.nextFloat() * 0.2f + 0.1f);
-                    break;
-                    
-                case Street_Traffic:
-                    // City street: cars, horns, general urban noise
-                    ambiencePhase[0] += 0.005f + ambienceRandom.nextFloat() * 0.01f;
-                    if (ambienceRandom.nextFloat() > 0.998f) // Occasional car horn
-                    {
-                        ambienceLevel[0] = 0.5f;
-                    }
-                    ambienceLevel[0] *= 0.95f; // Decay
-                    ambience = std::sin(ambiencePhase[0]) * 0.2f + ambienceLevel[0];
-                    break;
-                    
-                case Underground_Tube:
-                    // London Underground: train rumble, announcements, echoes
-                    ambiencePhase[0] += 0.003f; // Deep rumble
-                    ambiencePhase[1] += 0.02f;  // Electrical hum
-                    ambience = std::sin(ambiencePhase[0]) * 0.5f +
-                              std::sin(ambiencePhase[1]) * 0.1f +
-                              (ambienceRandom.nextFloat() * 2.0f - 1.0f) * 0.05f;
-                    break;
-                    
-                case Office_Quiet:
-                    // Quiet office: air conditioning, keyboards, quiet conversations
-                    ambiencePhase[0] += 0.001f; // AC hum
-                    if (ambienceRandom.nextFloat() > 0.995f) // Occasional keyboard
-                    {
-                        ambienceLevel[1] = 0.1f;
-                    }
-                    ambienceLevel[1] *= 0.8f; // Quick decay
-                    ambience = std::sin(ambiencePhase[0]) * 0.05f + ambienceLevel[1];
-                    break;
-                    
-                case Train_Interior:
+            case Airport_Terminal:
+                // Airport background: announcements, people, air conditioning
+                ambiencePhase[0] += 0.002f * rateScale; // AC system
+                ambiencePhase[1] += (0.01f + noise.ambience.nextFloat() * 0.02f) * rateScale; // People
+                if (noise.ambience.nextFloat() > 1.0f - 0.0005f * rateScale) // Rare announcement
                 {
-                    // Inside moving train: rhythmic clacking, gentle swaying
-                    ambiencePhase[0] += 0.02f;  // Track rhythm
-                    ambiencePhase[1] += 0.004f; // Train rumble
-                    float trackRhythm = std::sin(ambiencePhase[0]) > 0.8f ? 0.2f : 0.0f;
-                    ambience = trackRhythm + std::sin(ambiencePhase[1]) * 0.3f;
-                    break;
+                    ambienceLevel[2] = 0.3f;
                 }
-                    
-                case Airport_Terminal:
-                    // Airport background: announcements, people, air conditioning
-                    ambiencePhase[0] += 0.002f; // AC system
-                    ambiencePhase[1] += 0.01f + ambienceRandom.nextFloat() * 0.02f; // People
-                    if (ambienceRandom.nextFloat() > 0.9995f) // Rare announcement
-                    {
-                        ambienceLevel[2] = 0.3f;
-                    }
-                    ambienceLevel[2] *= 0.98f; // Slow decay
-                    ambience = std::sin(ambiencePhase[0]) * 0.1f +
-                              std::sin(ambiencePhase[1]) * 0.2f + ambienceLevel[2];
-                    break;
-                    
-                default: // Silent
-                    ambience = 0.0f;
-                    break;
-            }
-            
-            // Mix ambience with existing audio
-            channelData[sample] += ambience * level * 0.15f; // Keep ambience subtle
+                ambienceLevel[2] *= announcementDecay; // Slow decay
+                ambience = std::sin(ambiencePhase[0]) * 0.1f +
+                          std::sin(ambiencePhase[1]) * 0.2f + ambienceLevel[2];
+                break;
+                
+            default: // Silent
+                ambience = 0.0f;
+                break;
         }
+        
+        destination[sample] = ambience;
     }
+    
+    // Keep the phases bounded over long sessions
+    for (auto& phase : ambiencePhase)
+        phase = std::fmod(phase, juce::MathConstants<float>::twoPi);
 }
 
 //==============================================================================
@@ -1232,7 +1446,7 @@ float TestAudioProcessor::getHighCutFrequency(int choiceIndex) const
         case 1: return 2800.0f;  // 2.8kHz
         case 2: return 3200.0f;  // 3.2kHz
         case 3: return 3400.0f;  // 3.4kHz
-        case 4: return 7000.0f;  // 7kHz
+        case 4: return 3600.0f;  // 3.6kHz - the top of the 8kHz band, just under the resampler's cut-off
         default: return 0.0f;    // Default to Off
     }
 }
@@ -1259,189 +1473,16 @@ void TestAudioProcessor::updateParameterSmoothing()
 //==============================================================================
 // GAME-CHANGING: Dynamic Signal Strength System (replaces interference)
 
-void TestAudioProcessor::detectVoiceActivity(float inputLevel)
-{
-    // Smooth voice activity detection
-    float targetActivity = (inputLevel > 0.01f) ? inputLevel : 0.0f;
-    voiceActivityLevel += (targetActivity - voiceActivityLevel) * voiceActivitySmoothing;
-    
-    // Update silence timer
-    if (voiceActivityLevel > 0.05f)
-    {
-        silenceTimer = 0.0f; // Reset silence timer when voice detected
-    }
-    else
-    {
-        silenceTimer += 1.0f / static_cast<float>(currentSampleRate);
-    }
-}
-
-void TestAudioProcessor::updateSignalStrength(float inputLevel)
-{
-    // Update signal change timer
-    signalChangeTimer += 1.0f / static_cast<float>(currentSampleRate);
-    
-    // INTELLIGENT: Signal degrades during silence (realistic!) - BUT MORE STABLE
-    if (silenceTimer > silenceThreshold)
-    {
-        // Signal degrades when quiet (like real phones!) - MUCH MORE GRADUAL  
-        targetSignalStrength = 0.6f + random.nextFloat() * 0.3f; // FIXED: 60-90% strength (was 30-70%)
-    }
-    else if (voiceActivityLevel > 0.1f)
-    {
-        // Signal improves when talking (realistic behavior!) - STABLE
-        targetSignalStrength = 0.8f + random.nextFloat() * 0.2f; // FIXED: 80-100% strength (was 70-100%)
-    }
-    
-    // MUCH LESS FREQUENT signal variations (every 5-10 seconds instead of 2-5)
-    if (signalChangeTimer > (5.0f + random.nextFloat() * 5.0f)) // FIXED: Much more stable
-    {
-        signalChangeTimer = 0.0f;
-        
-        // Phone-specific signal behavior - MORE STABLE
-        switch (static_cast<PhoneType>(static_cast<int>(phoneTypeParam->load())))
-        {
-            case Nokia:
-                // Nokia: Very stable signal, rare drops
-                targetSignalStrength = 0.8f + random.nextFloat() * 0.2f; // FIXED: Much more stable (was 0.6-1.0)
-                if (random.nextFloat() > 0.98f) targetSignalStrength = 0.6f; // FIXED: Much rarer dropouts
-                break;
-                
-            case iPhone:
-                // iPhone: Excellent signal, very stable
-                targetSignalStrength = 0.9f + random.nextFloat() * 0.1f; // FIXED: Very stable (was 0.8-1.0)
-                break;
-                
-            case SonyEricsson:
-                // Sony: Slightly more variable but still reasonable
-                targetSignalStrength = 0.7f + random.nextFloat() * 0.3f; // FIXED: More stable (was 0.4-1.0)
-                break;
-        }
-    }
-    
-    // MUCH SMOOTHER signal strength transitions 
-    signalSmoothingSpeed = 0.005f; // FIXED: Even smoother (was 0.01f)
-    currentSignalStrength += (targetSignalStrength - currentSignalStrength) * signalSmoothingSpeed;
-    currentSignalStrength = juce::jlimit(0.0f, 1.0f, currentSignalStrength);
-    
-    // Update signal bars for GUI (1-5 bars)
-    signalBars = static_cast<int>(currentSignalStrength * 4.0f) + 1;
-    signalBars = juce::jlimit(1, 5, signalBars);
-}
-
-float TestAudioProcessor::applySignalQuality(float input, PhoneType phoneType, SignalQuality quality)
-{
-    float effectiveSignalStrength = currentSignalStrength;
-    
-    // Override signal strength based on quality setting
-    switch (quality)
-    {
-        case Perfect_Signal:
-            effectiveSignalStrength = 1.0f;
-            break;
-        case Good_Signal:
-            effectiveSignalStrength = 0.9f;  // FIXED: More forgiving
-            break;
-        case Fair_Signal:
-            effectiveSignalStrength = 0.75f; // FIXED: Less harsh
-            break;
-        case Poor_Signal:
-            effectiveSignalStrength = 0.6f;  // FIXED: Still usable
-            break;
-        case Breaking_Up:
-            effectiveSignalStrength = 0.4f;  // FIXED: Less extreme
-            break;
-        case Auto_Dynamic:
-            // Use intelligent signal strength (no override)
-            break;
-    }
-    
-    // Simulate call dynamics (dropouts, recovery)
-    simulateCallDynamics();
-    
-    // Apply signal-based effects - MUCH MORE SUBTLE
-    float processedInput = input;
-    
-    // Signal dropouts (breaking up) - LESS AGGRESSIVE
-    if (isInDropout || effectiveSignalStrength < 0.4f)
-    {
-        // Gentle signal loss - less jarring
-        if (random.nextFloat() > (effectiveSignalStrength + 0.5f)) // FIXED: Much less frequent
-        {
-            processedInput *= 0.3f; // FIXED: Less extreme (was 0.1f)
-        }
-        
-        // Very subtle crackling - MUCH LESS FREQUENT
-        if (random.nextFloat() > 0.998f) // FIXED: Only 0.2% chance (was 5%)
-        {
-            processedInput += (random.nextFloat() * 2.0f - 1.0f) * 0.02f; // FIXED: Much quieter
-        }
-    }
-    
-    // Signal-dependent compression and distortion - VERY SUBTLE
-    if (effectiveSignalStrength < 0.8f) // FIXED: Only apply when signal is quite poor
-    {
-        // Very gentle compression - like real phones
-        processedInput = applySmartCompression(processedInput, effectiveSignalStrength);
-        
-        // Minimal background noise - MUCH CLEANER
-        float noiseLevel = (1.0f - effectiveSignalStrength) * 0.015f; // FIXED: Much less noise (was 0.08f)
-        processedInput += (random.nextFloat() * 2.0f - 1.0f) * noiseLevel;
-    }
-    
-    return processedInput;
-}
-
-void TestAudioProcessor::simulateCallDynamics()
+void TestAudioProcessor::applySignalQuality(juce::AudioBuffer<float>& buffer, int numChannels, PhoneType phoneType, SignalQuality quality)
 {
-    callQualityTimer += 1.0f / static_cast<float>(currentSampleRate);
-    
-    // Handle current dropout
-    if (isInDropout)
-    {
-        dropoutRecoveryTimer += 1.0f / static_cast<float>(currentSampleRate);
-        
-        if (dropoutRecoveryTimer >= dropoutDuration)
-        {
-            // Recovery from dropout
-            isInDropout = false;
-            dropoutRecoveryTimer = 0.0f;
-            targetSignalStrength = 0.7f + random.nextFloat() * 0.3f; // Signal recovers
-        }
-    }
-    else
-    {
-        // Check for new dropout events (more likely with poor signal)
-        float dropoutProbability = (1.0f - currentSignalStrength) * 0.0002f; // Very low base probability
-        
-        if (random.nextFloat() < dropoutProbability)
-        {
-            // Start a dropout
-            isInDropout = true;
-            dropoutDuration = 0.5f + random.nextFloat() * 2.0f; // 0.5-2.5 seconds
-            dropoutRecoveryTimer = 0.0f;
-            targetSignalStrength = 0.1f; // Signal drops dramatically
-        }
-    }
-}
-
-float TestAudioProcessor::applySmartCompression(float input, float signalStrength)
-{
-    // MUCH GENTLER compression - like real phone calls (not aggressive studio compression!)
-    float compressionIntensity = (1.0f - signalStrength) * 0.3f; // FIXED: Much less intense (was 0.8f)
-    float threshold = 0.5f - (compressionIntensity * 0.1f);       // FIXED: Higher threshold, less compression
-    float ratio = 1.5f + (compressionIntensity * 2.0f);          // FIXED: Gentle ratios 1.5:1 to 3.5:1 (was 2:1 to 10:1!)
-    
-    float absInput = std::abs(input);
-    if (absInput > threshold)
-    {
-        float excess = absInput - threshold;
-        float compressedExcess = excess / ratio;
-        float sign = (input >= 0.0f) ? 1.0f : -1.0f;
-        return sign * (threshold + compressedExcess);
-    }
-    
-    return input;
+    signalQuality.setQuality(quality, phoneType);
+    signalQuality.process(buffer.getArrayOfWritePointers(), numChannels, buffer.getNumSamples(), noise.signalQuality);
+    
+    // The codec picks its rate from this, and the GUI shows it
+    currentSignalStrength = signalQuality.getSignalStrength();
+    signalBars = signalQuality.getSignalBars();
+    isInDropout = signalQuality.isDroppingOut();
+    voiceActivityLevel = signalQuality.getVoiceActivity();
 }
 
 //==============================================================================
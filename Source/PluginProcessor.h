@@ -1,6 +1,21 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "AmbienceLoopPlayer.h"
+#include "CachedIIRFilter.h"
+#include "CallPositionStage.h"
+#include "CodecStage.h"
+#include "HandsetResponseStage.h"
+#include "JitterBufferStage.h"
+#include "LevelMeter.h"
+#include "NarrowbandResampler.h"
+#include "NoiseEngine.h"
+#include "PacketLossStage.h"
+#include "SignalQualityEngine.h"
+#include "SpectrumAnalyser.h"
+#include "OscillatorBank.h"
+#include "TVInterferenceGenerator.h"
+#include "TripleBuffer.h"
 
 //==============================================================================
 /**
@@ -66,7 +81,10 @@ public:
     // PHASE 5: Advanced Audio Processing
     static const juce::String CODEC_TYPE_ID;       // Real codec simulation
     static const juce::String PACKET_LOSS_ID;      // Packet loss simulation
+    static const juce::String PACKET_LOSS_MODEL_ID; // Random or bursty loss
+    static const juce::String JITTER_ID;           // Network jitter (ms)
     static const juce::String CALL_POSITION_ID;    // Stereo positioning
+    static const juce::String CALL_POSITION_BINAURAL_ID; // Ear positions through head filters
     static const juce::String AMBIENCE_TYPE_ID;    // Background ambience
     static const juce::String AMBIENCE_LEVEL_ID;   // Ambience volume
     
@@ -94,7 +112,7 @@ public:
         GSM_HalfRate = 1,       // GSM half-rate (5.6 kbps)  
         CDMA_QCELP = 2,         // CDMA QCELP codec
         AMR_4_75 = 3,           // AMR 4.75 kbps (very compressed)
-        AMR_12_2 = 4,           // AMR 12.2 kbps (higher quality)
+        AMR_12_2 = 4,           // AMR 12.2 kbps (higher quality, steps down as the signal weakens)
         Early_VoIP = 5,         // Early internet calling artifacts
         Digital_Artifact = 6    // Extreme digital compression
     };
@@ -157,30 +175,54 @@ public:
     
     // Simplified interference system (no more complex call simulation)
     
-    // Audio level monitoring for GUI
-    float getCurrentAudioLevel() const { return currentAudioLevel.load(); }
+    // What the audio thread last saw, for the GUI: levels, and the GAME-CHANGING Dynamic Signal Strength
+    // System's state. Published once per block through a wait-free triple buffer.
+    struct Telemetry
+    {
+        LevelMeter::Levels input;       // Per-channel peak and RMS meters: the host's input,
+        LevelMeter::Levels wet;         // the phone signal before the wet/dry mix,
+        LevelMeter::Levels output;      // and what leaves the plugin
+        float signalStrength = 1.0f;    // 0.0 = no signal, 1.0 = perfect
+        int signalBars = 5;             // 1-5 bars
+        float voiceActivity = 0.0f;     // 0.0-1.0
+        bool droppingOut = false;       // The call is dropping out
+        bool concealingLoss = false;    // A lost packet is being concealed
+    };
+    
+    // Message thread only (the single reader): the latest snapshot, never torn, never blocking
+    Telemetry getTelemetry() { return telemetry.read(); }
     
-    // GAME-CHANGING: Dynamic Signal Strength System (public for GUI display)
-    float getCurrentSignalStrength() const { return currentSignalStrength; }
-    int getSignalBars() const { return signalBars; }
-    bool isCallDropping() const { return isInDropout; }
-    float getVoiceActivity() const { return voiceActivityLevel; }
+    // The output's spectrum, for the phone screens: the audio thread feeds it, the editor computes it
+    SpectrumAnalyser& getSpectrumAnalyser() { return spectrumAnalyser; }
     
     // Phone preset loading
     void loadPhonePreset(PhoneType phoneType);
     
+    // Per-sample stage execution: Fused runs every active stage in one pass (default),
+    // Staged sweeps the buffer once per stage (kept for A/B comparison and benchmarking)
+    enum ProcessingMode
+    {
+        Staged = 0,
+        Fused = 1
+    };
+    
+    void setProcessingMode(ProcessingMode newMode) { processingMode.store(newMode); }
+    ProcessingMode getProcessingMode() const { return static_cast<ProcessingMode>(processingMode.load()); }
+    
+    // Reproducible noise: every prepareToPlay restarts all noise streams from this seed.
+    // Each instance starts with its own random seed; fix it for repeatable offline renders.
+    void setNoiseSeed(juce::int64 newSeed) { noiseSeed.store(newSeed); }
+    juce::int64 getNoiseSeed() const { return noiseSeed.load(); }
+    
     // AUTHENTIC INTERFERENCE METHODS (REPLACED WITH DYNAMIC SIGNAL STRENGTH)
     float applyAuthenticInterference(float input, PhoneType phoneType, int preset, float noiseLevel, float interferenceLevel);
     float applyNokiaInterference(float input, int preset, float noiseLevel, float interferenceLevel);
     float applyIPhoneInterference(float input, int preset, float noiseLevel, float interferenceLevel);
     float applySonyEricssonInterference(float input, int preset, float noiseLevel, float interferenceLevel);
     
-    // GAME-CHANGING: Dynamic Signal Strength Methods
-    void updateSignalStrength(float inputLevel);           // Analyze audio and update signal
-    float applySignalQuality(float input, PhoneType phoneType, SignalQuality quality);
-    void detectVoiceActivity(float inputLevel);            // Voice activity detection
-    void simulateCallDynamics();                          // Realistic call behavior simulation
-    float applySmartCompression(float input, float signalStrength); // Adaptive compression
+    // GAME-CHANGING: Dynamic Signal Strength - a block-rate engine drives the signal strength, dropouts
+    // and the gain envelope they put on the call (see SignalQualityEngine.h)
+    void applySignalQuality(juce::AudioBuffer<float>& buffer, int numChannels, PhoneType phoneType, SignalQuality quality);
     
     // Phone-specific interference presets (REPLACED WITH DYNAMIC SIGNAL STRENGTH)
     float applyPhoneDistortion(float input, PhoneType phoneType, float amount);
@@ -194,23 +236,28 @@ public:
 
     // NEW: TV Interference methods (Phase 4)
     float applyTVInterference(float input, PhoneType phoneType, float intensity);
-    float generateNokiaTVInterference(float input, float intensity);
-    float generateIPhoneTVInterference(float input, float intensity);
-    float generateSonyTVInterference(float input, float intensity);
+    static TVInterferenceGenerator::Model getTVInterferenceModel(PhoneType phoneType);
 
     // PHASE 5: Advanced Audio Processing Methods
-    float applyCodecSimulation(float input, CodecType codec, float intensity);
-    float applyGSMCodec(float input, bool halfRate, float intensity);
-    float applyCDMACodec(float input, float intensity);
-    float applyAMRCodec(float input, float bitrate, float intensity);
-    float applyVoIPArtifacts(float input, float intensity);
-    
-    float applyPacketLoss(float input, float lossAmount);
-    float applyJitter(float input, float jitterAmount);
-    
-    void applyStereoPositioning(juce::AudioBuffer<float>& buffer, CallPosition position, float intensity);
+    // Codec simulation works on whole 20ms frames of 8kHz audio and delays it by one frame (see CodecStage.h)
+    void applyCodecSimulation(juce::AudioBuffer<float>& buffer, int numChannels, CodecType codec, float intensity);
+    static CodecStage::Codec getCodecStageType(CodecType codec);
+    
+    // Packet loss drops whole 20ms frames of 8kHz audio and conceals them (see PacketLossStage.h)
+    void applyPacketLoss(juce::AudioBuffer<float>& buffer, int numChannels, PacketLossStage::Model model, float lossAmount);
+    // Jitter delays those frames by a varying amount; an adaptive jitter buffer plays them out (see JitterBufferStage.h)
+    void applyJitter(juce::AudioBuffer<float>& buffer, int numChannels, float jitterMs);
+    
+    // Call positioning is a gain matrix per position, ramped on changes (see CallPositionStage.h)
+    void applyStereoPositioning(juce::AudioBuffer<float>& buffer, int numChannels, CallPosition position, bool binaural);
+    // Ambience plays a recorded loop where one is installed (see AmbienceLoopPlayer.h)
     void generateBackgroundAmbience(juce::AudioBuffer<float>& buffer, AmbienceType type, float level);
     
+    // The telephone band the stages above (codec to ambience, and signal quality) run in: its rate, and the
+    // most samples per block they are prepared for by the last prepareToPlay
+    static constexpr double getTelephoneBandRate() { return telephoneRate; }
+    int getMaxTelephoneBandBlockSize() const { return narrowband.getMaxNarrowbandSamples(); }
+    
     // Frequency conversion functions for discrete choice parameters
     float getLowCutFrequency(int choiceIndex) const;
     float getHighCutFrequency(int choiceIndex) const;
@@ -229,9 +276,49 @@ private:
     // Parameter layout creation
     juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
     
-    // Audio processing components
-    juce::dsp::ProcessorDuplicator<juce::dsp::IIR::Filter<float>, juce::dsp::IIR::Coefficients<float>> lowCutFilter;
-    juce::dsp::ProcessorDuplicator<juce::dsp::IIR::Filter<float>, juce::dsp::IIR::Coefficients<float>> highCutFilter;
+    // Real-time processing of at most maximumBlockSize samples (called from processBlock)
+    void processSubBlock(juce::AudioBuffer<float>& buffer);
+    
+    // Block-constant settings handed to the per-sample stages
+    struct StageSettings
+    {
+        PhoneType phoneType = Nokia;
+        CodecType codec = GSM_FullRate;
+        float distortion = 0.0f;
+        float compression = 0.0f;
+        float interference = 0.0f;
+        bool tvInterference = false;
+        float wetDryMix = 1.0f;
+    };
+    
+    // Optional stages of the fused loop; each combination gets its own compiled loop
+    enum FusedStage
+    {
+        distortionStage   = 1 << 0,
+        compressionStage  = 1 << 1,
+        interferenceStage = 1 << 2,
+        tvStage           = 1 << 3,
+        numFusedStageCombinations = 1 << 4
+    };
+    
+    static constexpr int fusedTileSize = 64;   // Samples per tile: filter output stays in L1 for the stage loop
+    
+    using FusedProcessor = void (TestAudioProcessor::*)(juce::AudioBuffer<float>&, int, const StageSettings&);
+    
+    // Both pipelines run on telephone-band audio (see processSubBlock)
+    void processFusedStages(juce::AudioBuffer<float>& buffer, int numChannels, const StageSettings& settings);
+    template <int stageMask>
+    void processFused(juce::AudioBuffer<float>& buffer, int numChannels, const StageSettings& settings);
+    void processStaged(juce::AudioBuffer<float>& buffer, int numChannels, const StageSettings& settings);
+    
+    void applyDistortionKernel(float* data, int numSamples, const StageSettings& settings);
+    float nextInterferenceSample(float rfTone, float localQuantizationNoise, const StageSettings& settings);
+    
+    std::atomic<int> processingMode { Fused };
+    
+    // Audio processing components (coefficients cached per sample rate, crossfaded on change)
+    CachedIIRFilter lowCutFilter { CachedIIRFilter::highPass };
+    CachedIIRFilter highCutFilter { CachedIIRFilter::lowPass };
     
     // Atomic parameter pointers for thread-safe access
     std::atomic<float>* lowCutParam;
@@ -246,7 +333,10 @@ private:
     // PHASE 5: Advanced Audio Processing Parameters
     std::atomic<float>* codecTypeParam = nullptr;       // Codec simulation type
     std::atomic<float>* packetLossParam = nullptr;       // Packet loss amount
+    std::atomic<float>* packetLossModelParam = nullptr;  // Packet loss pattern
+    std::atomic<float>* jitterParam = nullptr;           // Network jitter
     std::atomic<float>* callPositionParam = nullptr;     // Stereo positioning
+    std::atomic<float>* callPositionBinauralParam = nullptr; // Binaural ear positions
     std::atomic<float>* ambienceTypeParam = nullptr;     // Background ambience type
     std::atomic<float>* ambienceLevelParam = nullptr;    // Ambience volume
     
@@ -326,14 +416,32 @@ private:
     // Call quality degradation
     void applyCallQualityDegradation(juce::AudioBuffer<float>& buffer, float quality);
     
-    // Audio level monitoring
-    std::atomic<float> currentAudioLevel{0.0f};
+    // Audio level monitoring: metered in processBlock, published to the GUI through the telemetry
+    LevelMeter inputMeter, wetMeter, outputMeter;
+    TripleBuffer<Telemetry> telemetry;
+    SpectrumAnalyser spectrumAnalyser;
     
     // Sample rate
     double currentSampleRate = 44100.0;
     
-    // Random number generator for noise
-    juce::Random random;
+    // Real-time safety: scratch buffers sized in prepareToPlay and reused every block
+    int maximumBlockSize = 0;              // Largest sub-block processSubBlock will ever see
+    juce::AudioBuffer<float> dryBuffer;    // Clean input for wet/dry mixing, delayed to line up with the telephone band
+    juce::AudioBuffer<float> narrowbandBuffer; // One block at the telephone rate, where every degradation stage runs
+    juce::AudioBuffer<float> noiseScratch; // One block of stage noise for the staged path
+    juce::AudioBuffer<float> toneScratch;  // One block of RF tone / TV buzz for the staged path
+    
+    // Block noise generators, one stream per stage (see NoiseEngine.h)
+    NoiseEngine noise;
+    
+    // Phase-continuous interference tones
+    enum InterferenceOscillator
+    {
+        rfOscillator = 0
+    };
+    
+    OscillatorBank interferenceOscillators;
+    std::atomic<juce::int64> noiseSeed { juce::Random::getSystemRandom().nextInt64() };
     
     // GSM interference simulation (REPLACED WITH DYNAMIC SIGNAL STRENGTH)
     float gsmPhase = 0.0f;
@@ -343,23 +451,13 @@ private:
     float gsmBurstIntensity = 0.0f; // NEW: Dynamic burst intensity (da-da-da-dit pattern)
     float hissPhase = 0.0f;
     
-    // GAME-CHANGING: Dynamic Signal Strength System
-    float currentSignalStrength = 1.0f;    // Current signal quality (0.0 = no signal, 1.0 = perfect)
-    float targetSignalStrength = 1.0f;     // Target signal strength (for smooth transitions)
-    float signalChangeTimer = 0.0f;        // Timer for signal strength changes
-    float signalSmoothingSpeed = 0.01f;    // How fast signal strength changes
+    // GAME-CHANGING: Dynamic Signal Strength System (in the telephone band, updated per 1ms tick)
+    SignalQualityEngine signalQuality;
     
-    // INTELLIGENT: Voice Activity Detection  
+    // The engine's state as of the last block, for the codec (and the GUI, through the telemetry)
+    float currentSignalStrength = 1.0f;    // Current signal quality (0.0 = no signal, 1.0 = perfect)
     float voiceActivityLevel = 0.0f;       // Current detected voice activity (0.0-1.0)
-    float voiceActivitySmoothing = 0.05f;  // Smoothing for voice detection
-    float silenceTimer = 0.0f;             // How long since last voice activity
-    float silenceThreshold = 2.0f;         // Seconds of silence before signal degrades
-    
-    // REALISTIC: Call Quality Dynamics
-    float callQualityTimer = 0.0f;         // Timer for realistic call events
     bool isInDropout = false;              // Currently experiencing signal dropout
-    float dropoutDuration = 0.0f;          // How long current dropout lasts
-    float dropoutRecoveryTimer = 0.0f;     // Timer for signal recovery
     int signalBars = 5;                    // Visual signal strength (1-5 bars)
     
     // AUTHENTIC: Phone-specific signal characteristics  
@@ -377,37 +475,40 @@ private:
     float iphoneWarmthPhase = 0.0f;        // iPhone's warm digital processing
     float sonyAnalogPhase = 0.0f;          // Sony's analog character
     float tonalColoringIntensity = 0.15f;  // Much more subtle overall tonal coloring
+    float tonalPhaseScale = 1.0f;          // Keeps the coloring tones' pitch at the telephone rate
     
-    // NEW: TV Interference variables
-    float tvInterferencePhase = 0.0f;      // Main TV interference oscillation
-    float tvScanlinePhase = 0.0f;          // CRT scanline frequency
-    float tvBurstTimer = 0.0f;             // Burst pattern timing
-    int tvBurstState = 0;                  // Current burst state
-    juce::Random tvRandom;                 // Random for TV static
+    // NEW: TV Interference (per instance - never shared between plugin instances)
+    TVInterferenceGenerator tvGenerator;
 
     // PHASE 5: Advanced Audio Processing Variables
     
-    // Codec simulation state
-    float codecPhase = 0.0f;              // Phase for codec artifacts
-    float codecBuffer[8] = {0};           // Small buffer for codec delays
-    int codecBufferIndex = 0;             // Current buffer position
-    float quantizationNoise = 0.0f;       // Quantization artifacts
+    // The telephone band: the host signal resampled to the codec rate and back. Its delay, the
+    // codec's frame, the jitter buffer's packetising and the packet loss stage's hold-back included,
+    // is the plugin's reported latency.
+    static constexpr double telephoneRate = CodecStage::sampleRate;
+    NarrowbandResampler narrowband;
+    
+    // Codec simulation (frame based, in the telephone band)
+    CodecStage codecStage;
+    
+    // Packet loss simulation (frame based, in the telephone band, after the jitter buffer)
+    PacketLossStage packetLossStage;
+    
+    // Jitter simulation (frame based, in the telephone band, between the codec and packet loss)
+    JitterBufferStage jitterBufferStage;
     
-    // Packet loss simulation
-    float packetLossTimer = 0.0f;         // Timer for packet loss events
-    bool packetDropped = false;           // Current packet state
-    float reconstructionBuffer[16] = {0}; // Buffer for reconstruction artifacts
-    int reconstructionIndex = 0;         // Reconstruction buffer position
+    // The phone's microphone and speaker responses, convolved in the telephone band (no latency)
+    HandsetResponseStage handsetResponse;
     
-    // Jitter simulation  
-    float jitterDelay[64] = {0};          // Delay line for jitter
-    int jitterWriteIndex = 0;             // Write position in jitter buffer
-    float jitterPhase = 0.0f;             // Phase for jitter modulation
+    // Call positioning (at the host rate, on the wet signal)
+    CallPositionStage callPositionStage;
     
-    // Background ambience generation
+    // Background ambience: recorded loops streamed from disk, synthesised when a loop isn't installed
+    AmbienceLoopPlayer ambienceLoops;
+    juce::AudioBuffer<float> ambienceBuffer;  // One block of ambience, mixed into every channel
+    void synthesiseAmbience(float* destination, int numSamples, AmbienceType type);
     float ambiencePhase[4] = {0};         // Multiple phases for complex ambience
     float ambienceLevel[8] = {0};         // Level tracking for ambience layers
-    juce::Random ambienceRandom;          // Random for ambience variations
     
     // NEW: Parameter smoothing for professional transitions (private implementation details)
     float currentDistortion = 0.0f;     // Current smoothed distortion
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <numeric>
+
+//==============================================================================
+/**
+    Streaming sample-rate converter for a fixed rational ratio, one channel.
+
+    The two rates are reduced to upsample-by-L / downsample-by-M, and a single
+    Kaiser-windowed sinc low-pass at L times the input rate is split into L
+    polyphase branches. Each output sample is one dot product of a branch
+    with the most recent input, so no zero-stuffed samples are ever computed
+    and the cost per output is the branch length. The branches are stored
+    back to front next to a doubled input history, so the dot product runs
+    over two contiguous arrays and vectorises.
+
+    The cut-off sits just below the Nyquist frequency of the lower of the two
+    rates, so the same class is both the anti-aliasing decimator into a
+    narrowband domain and the anti-imaging interpolator back out of it.
+
+    prepare() designs the filter and allocates; process() never allocates.
+*/
+class PolyphaseResampler
+{
+public:
+    PolyphaseResampler() = default;
+
+    //==============================================================================
+    void prepare (double newInputRate, double newOutputRate)
+    {
+        const int inputRate = juce::roundToInt (newInputRate);
+        const int outputRate = juce::roundToInt (newOutputRate);
+        jassert (inputRate > 0 && outputRate > 0);
+
+        const int divisor = std::gcd (inputRate, outputRate);
+        upFactor = outputRate / divisor;
+        downFactor = inputRate / divisor;
+
+        // Cut-off relative to the upsampled rate (inputRate * upFactor)
+        const double cutoff = cutoffRatio * 0.5 / (double) juce::jmax (upFactor, downFactor);
+        const int halfLength = juce::roundToInt (zeroCrossings / (2.0 * cutoff));
+
+        // Branches are padded with zero taps to a whole number of vector lanes
+        branchLength = (2 * halfLength + 1 + upFactor - 1) / upFactor;
+        branchLength = juce::jmax (numLanes, (branchLength + numLanes - 1) / numLanes * numLanes);
+        const int prototypeLength = branchLength * upFactor;
+        const double centre = (2 * halfLength) * 0.5;
+
+        std::vector<double> prototype ((size_t) prototypeLength, 0.0);
+        const double window = besselI0 (kaiserBeta);
+        double sum = 0.0;
+
+        for (int n = 0; n <= 2 * halfLength; ++n)
+        {
+            const double t = n - centre;
+            const double x = 2.0 * cutoff * t;
+            const double sinc = t == 0.0 ? 1.0 : std::sin (juce::MathConstants<double>::pi * x) / (juce::MathConstants<double>::pi * x);
+            const double r = t / juce::jmax (1.0, centre);
+
+            prototype[(size_t) n] = 2.0 * cutoff * sinc * besselI0 (kaiserBeta * std::sqrt (juce::jmax (0.0, 1.0 - r * r))) / window;
+            sum += prototype[(size_t) n];
+        }
+
+        // Unity gain through every branch once upsampling spreads the input over upFactor branches
+        const double gain = sum != 0.0 ? upFactor / sum : 0.0;
+
+        branches.assign ((size_t) (upFactor * branchLength), 0.0f);
+
+        for (int phase = 0; phase < upFactor; ++phase)
+            for (int k = 0; k < branchLength; ++k)
+                branches[(size_t) (phase * branchLength + branchLength - 1 - k)] = static_cast<float> (prototype[(size_t) (phase + k * upFactor)] * gain);
+
+        history.assign ((size_t) (2 * branchLength), 0.0f);
+        groupDelay = centre / upFactor;
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        std::fill (history.begin(), history.end(), 0.0f);
+        writePosition = 0;
+        phase = 0;
+    }
+
+    //==============================================================================
+    // Most outputs a call with numInputs samples can produce
+    int getMaxOutputSamples (int numInputs) const noexcept
+    {
+        return static_cast<int> (((juce::int64) numInputs * upFactor) / downFactor) + 1;
+    }
+
+    // Delay of the filter, in input samples
+    double getGroupDelay() const noexcept               { return groupDelay; }
+
+    // Converts numInputs samples and returns how many were written to output
+    int process (const float* input, int numInputs, float* output) noexcept
+    {
+        int numOutputs = 0;
+
+        for (int i = 0; i < numInputs; ++i)
+        {
+            history[(size_t) writePosition] = history[(size_t) (writePosition + branchLength)] = input[i];
+
+            if (++writePosition == branchLength)
+                writePosition = 0;
+
+            // Every output due before the next input sample arrives
+            for (; phase < upFactor; phase += downFactor)
+                output[numOutputs++] = dotProduct (branches.data() + phase * branchLength, history.data() + writePosition);
+
+            phase -= upFactor;
+        }
+
+        return numOutputs;
+    }
+
+private:
+    //==============================================================================
+    static constexpr double zeroCrossings = 16.0;   // Per side, at the lower rate
+    static constexpr double cutoffRatio = 0.92;     // Of the lower Nyquist frequency
+    static constexpr double kaiserBeta = 8.0;       // About 80dB stop band
+
+    static constexpr int numLanes = 8;
+
+    // Eight running sums, so the compiler may vectorise without reordering a single sum
+    float dotProduct (const float* coefficients, const float* samples) const noexcept
+    {
+        float sums[numLanes] = {};
+
+        for (int k = 0; k < branchLength; k += numLanes)
+            for (int lane = 0; lane < numLanes; ++lane)
+                sums[lane] += coefficients[k + lane] * samples[k + lane];
+
+        float sum = 0.0f;
+
+        for (auto laneSum : sums)
+            sum += laneSum;
+
+        return sum;
+    }
+
+    static double besselI0 (double x) noexcept
+    {
+        double sum = 1.0, term = 1.0;
+
+        for (int k = 1; k < 50 && term > 1.0e-12 * sum; ++k)
+        {
+            term *= (x * 0.5 / k) * (x * 0.5 / k);
+            sum += term;
+        }
+
+        return sum;
+    }
+
+    //==============================================================================
+    int upFactor = 1, downFactor = 1;
+    int branchLength = 1;
+    double groupDelay = 0.0;
+
+    std::vector<float> branches;    // upFactor branches of branchLength taps, each reversed
+    std::vector<float> history;     // The last branchLength inputs, stored twice
+
+    int writePosition = 0;
+    int phase = 0;                  // Position of the next output between the last two inputs, in 1 / upFactor steps
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PolyphaseResampler)
+};
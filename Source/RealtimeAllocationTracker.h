@@ -0,0 +1,151 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+// Debug-build heap tracker for the audio thread.
+//
+// When CELLYZ_TRACK_REALTIME_ALLOCATIONS is enabled (the default for debug
+// builds), PluginProcessor.cpp replaces the global operator new/delete for the
+// plugin binary - plain, nothrow and aligned. Any heap access made while a
+// ScopedRealtimeSection is alive on the calling thread hits a jassert, so
+// allocations that sneak into processBlock show up immediately instead of as
+// xruns in a busy session.
+//
+// Much of JUCE (HeapBlock, so AudioBuffer::setSize and makeCopyOf) calls
+// std::malloc and friends directly, past operator new. Where the C library is
+// glibc, PluginProcessor.cpp also interposes malloc, calloc, realloc and free
+// with hidden visibility: every call made from inside the plugin binary goes
+// through the tracker, the host's own calls don't
+// (CELLYZ_TRACK_REALTIME_MALLOC). Elsewhere only operator new is tracked.
+//
+// runSelfTest() checks, once per process, that each of those paths trips it.
+#ifndef CELLYZ_TRACK_REALTIME_ALLOCATIONS
+ #if JUCE_DEBUG
+  #define CELLYZ_TRACK_REALTIME_ALLOCATIONS 1
+ #else
+  #define CELLYZ_TRACK_REALTIME_ALLOCATIONS 0
+ #endif
+#endif
+
+#ifndef CELLYZ_TRACK_REALTIME_MALLOC
+ #if CELLYZ_TRACK_REALTIME_ALLOCATIONS && defined (__GLIBC__)
+  #define CELLYZ_TRACK_REALTIME_MALLOC 1
+ #else
+  #define CELLYZ_TRACK_REALTIME_MALLOC 0
+ #endif
+#endif
+
+class RealtimeAllocationTracker
+{
+public:
+    // Marks the current thread as running real-time code (processBlock)
+    struct ScopedRealtimeSection
+    {
+       #if CELLYZ_TRACK_REALTIME_ALLOCATIONS
+        ScopedRealtimeSection() noexcept  { ++depth(); }
+        ~ScopedRealtimeSection() noexcept { --depth(); }
+       #else
+        ScopedRealtimeSection() noexcept {}
+       #endif
+    };
+
+    // Temporarily lifts the check (used while reporting the assertion itself)
+    struct ScopedAllowAllocations
+    {
+       #if CELLYZ_TRACK_REALTIME_ALLOCATIONS
+        ScopedAllowAllocations() noexcept : savedDepth (depth()) { depth() = 0; }
+        ~ScopedAllowAllocations() noexcept { depth() = savedDepth; }
+
+    private:
+        int savedDepth;
+       #else
+        ScopedAllowAllocations() noexcept {}
+       #endif
+    };
+
+    static bool isInRealtimeSection() noexcept
+    {
+       #if CELLYZ_TRACK_REALTIME_ALLOCATIONS
+        return depth() > 0;
+       #else
+        return false;
+       #endif
+    }
+
+    // Called from the replaced operator new/delete (and malloc family)
+    static void checkHeapAccess() noexcept
+    {
+       #if CELLYZ_TRACK_REALTIME_ALLOCATIONS
+        if (depth() > 0)
+        {
+            if (expectedAccesses() >= 0)
+            {
+                ++expectedAccesses();
+                return;
+            }
+
+            ScopedAllowAllocations allowReporting;
+            jassertfalse; // Something on the processBlock path touched the heap!
+        }
+       #endif
+    }
+
+   #if CELLYZ_TRACK_REALTIME_ALLOCATIONS
+    // Debug self-test: heap access from each tracked path, inside a realtime section, must be caught
+    static void runSelfTest()
+    {
+        struct alignas (64) CacheLine { float values[16]; };
+
+        jassert (catchesHeapAccess ([] { auto* p = new int (0);                       escape (p); delete p; }));
+        jassert (catchesHeapAccess ([] { auto* p = new float[16];                     escape (p); delete[] p; }));
+        jassert (catchesHeapAccess ([] { auto* p = new (std::nothrow) int (0);        escape (p); delete p; }));
+        jassert (catchesHeapAccess ([] { auto* p = new CacheLine();                   escape (p); delete p; }));
+        jassert (catchesHeapAccess ([] { auto* p = new (std::nothrow) CacheLine[2];   escape (p); delete[] p; }));
+
+       #if CELLYZ_TRACK_REALTIME_MALLOC
+        // What the dry buffer used to do on every block
+        jassert (catchesHeapAccess ([] { juce::AudioBuffer<float> buffer; buffer.setSize (2, 512); escape (buffer.getWritePointer (0)); }));
+        jassert (catchesHeapAccess ([] { auto* p = std::calloc (16, sizeof (float)); escape (p); std::free (p); }));
+       #endif
+    }
+   #endif
+
+private:
+   #if CELLYZ_TRACK_REALTIME_ALLOCATIONS
+    static int& depth() noexcept
+    {
+        static thread_local int realtimeDepth = 0;
+        return realtimeDepth;
+    }
+
+    // Counts heap accesses instead of asserting while the self-test runs, -1 otherwise
+    static int& expectedAccesses() noexcept
+    {
+        static thread_local int count = -1;
+        return count;
+    }
+
+    template <typename Function>
+    static bool catchesHeapAccess (Function&& touchHeap)
+    {
+        expectedAccesses() = 0;
+
+        {
+            ScopedRealtimeSection realtimeSection;
+            touchHeap();
+        }
+
+        const bool caught = expectedAccesses() > 0;
+        expectedAccesses() = -1;
+        return caught;
+    }
+
+    // Keeps the compiler from eliding an allocation the self-test makes on purpose
+    static void escape (void* p) noexcept
+    {
+        static void* volatile sink = nullptr;
+        sink = p;
+    }
+   #endif
+};
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <map>
+#include <typeindex>
+
+//==============================================================================
+/**
+    Read-only assets (recorded loops, impulse responses, tables) shared by
+    every plugin instance in the process.
+
+    acquire() looks an asset up by ID and only runs the loader when no one
+    holds it yet, so however many instances ask for the same asset, it is
+    loaded and kept in memory once. Instances get a shared, const handle;
+    the asset stays alive while any handle does, and is dropped from the
+    cache with the last one. Nothing is kept around for assets no instance
+    uses.
+
+    The loader runs without the cache locked, so a slow load never holds up
+    other lookups; if two threads load the same asset at once, the first to
+    finish wins and the other's copy is thrown away.
+
+    acquire() locks and may load from disk, and releasing the last handle
+    frees the asset - keep both off the audio thread. Handles are for
+    prepare(), loader threads and the like; the audio thread may read
+    through a handle something else keeps alive.
+*/
+class SharedAssetCache
+{
+public:
+    template <typename AssetType>
+    using Handle = std::shared_ptr<const AssetType>;
+
+    //==============================================================================
+    // The asset stored under id, loaded by load() (which returns a std::unique_ptr<AssetType>,
+    // or nullptr if the asset can't be had) if no one holds it. Returns nullptr if loading fails.
+    template <typename AssetType, typename LoadFunction>
+    static Handle<AssetType> acquire (const juce::String& id, LoadFunction&& load)
+    {
+        auto& cache = getInstance();
+
+        {
+            const juce::ScopedLock sl (cache.lock);
+
+            if (auto existing = cache.find<AssetType> (id))
+                return existing;
+        }
+
+        std::unique_ptr<AssetType> loaded (load());
+
+        if (loaded == nullptr)
+            return {};
+
+        const juce::ScopedLock sl (cache.lock);
+
+        if (auto existing = cache.find<AssetType> (id))
+            return existing;
+
+        Handle<AssetType> handle (loaded.release(), Evictor { id });
+        cache.entries.insert_or_assign (id, Entry { std::type_index (typeid (AssetType)), handle });
+        return handle;
+    }
+
+    // How many assets are held right now
+    static int getNumAssets()
+    {
+        auto& cache = getInstance();
+        const juce::ScopedLock sl (cache.lock);
+        return (int) cache.entries.size();
+    }
+
+private:
+    //==============================================================================
+    struct Entry
+    {
+        std::type_index type;
+        std::weak_ptr<const void> asset;
+    };
+
+    // Deletes an asset when its last handle goes, and takes it out of the cache
+    struct Evictor
+    {
+        juce::String id;
+
+        template <typename AssetType>
+        void operator() (const AssetType* asset) const
+        {
+            getInstance().evict (id);
+            delete asset;
+        }
+    };
+
+    SharedAssetCache() = default;
+
+    static SharedAssetCache& getInstance()
+    {
+        static SharedAssetCache instance;
+        return instance;
+    }
+
+    template <typename AssetType>
+    Handle<AssetType> find (const juce::String& id) const
+    {
+        const auto entry = entries.find (id);
+
+        if (entry == entries.end())
+            return {};
+
+        // One ID, one type
+        jassert (entry->second.type == std::type_index (typeid (AssetType)));
+
+        if (entry->second.type != std::type_index (typeid (AssetType)))
+            return {};
+
+        return std::static_pointer_cast<const AssetType> (entry->second.asset.lock());
+    }
+
+    void evict (const juce::String& id)
+    {
+        const juce::ScopedLock sl (lock);
+        const auto entry = entries.find (id);
+
+        // A fresh copy may already have replaced the one going away
+        if (entry != entries.end() && entry->second.asset.expired())
+            entries.erase (entry);
+    }
+
+    //==============================================================================
+    juce::CriticalSection lock;
+    std::map<juce::String, Entry> entries;
+
+    JUCE_DECLARE_NON_COPYABLE (SharedAssetCache)
+};
@@ -0,0 +1,309 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "NoiseEngine.h"
+
+//==============================================================================
+/**
+    The radio link's signal strength, and what a weak signal does to a call.
+    Runs in the processor's telephone band (8kHz), after the network stages.
+
+    The Signal Quality setting either holds the signal at a fixed strength
+    (Perfect to Breaking Up) or, in Auto Dynamic, lets it move on its own:
+    it picks up while the caller talks and sags through long silences, it
+    drifts every few seconds by an amount that depends on the phone, and
+    a weak signal now and then drops out altogether for a second or two.
+    The strength glides toward its target rather than jumping.
+
+    All of that is a state machine updated once per 1ms control tick, with
+    time kept in integer sample counts and the random draws made per tick,
+    not per sample. The one thing rendered per sample is the gain envelope:
+    while the signal is breaking up, each tick is either passed or chopped
+    to 0.3 at random, and the gain ramps linearly from one tick's value to
+    the next. The envelope is written once per block and multiplied into
+    every channel with vector operations. A signal below 80% also
+    compresses the voice gently and adds a little noise; one that is
+    breaking up adds the occasional crackle.
+
+    prepare() sizes everything; process() never allocates.
+*/
+class SignalQualityEngine
+{
+public:
+    static constexpr int numQualities = 6;      // As TestAudioProcessor::SignalQuality
+    static constexpr int autoDynamic = 5;
+    static constexpr int numPhones = 3;         // Nokia, iPhone, Sony Ericsson (as TestAudioProcessor::PhoneType)
+
+    SignalQualityEngine() = default;
+
+    //==============================================================================
+    void prepare (double newSampleRate, int maximumBlockSize)
+    {
+        sampleRate = newSampleRate;
+        tickLength = juce::jmax (1, juce::roundToInt (sampleRate * 0.001));
+
+        const double tickSeconds = (double) tickLength / sampleRate;
+        voiceSmoothing = (float) (1.0 - std::exp (-tickSeconds / voiceTimeConstant));
+        strengthSmoothing = (float) (1.0 - std::exp (-tickSeconds / strengthTimeConstant));
+
+        envelope.setSize (1, juce::jmax (1, maximumBlockSize));
+        crackle.setSize (1, juce::jmax (1, maximumBlockSize));
+        noiseScratch.setSize (1, juce::jmax (1, maximumBlockSize));
+
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        tickPosition = 0;
+        tickPeak = 0.0f;
+        gain = targetGain = 1.0f;
+        gainStep = 0.0f;
+        clickPosition = -1;
+
+        strength = targetStrength = getFixedStrength (quality);
+        voiceActivity = 0.0f;
+        talking = false;
+        samplesSilent = 0;
+        samplesUntilDrift = 0;
+        dropoutSamplesLeft = 0;
+    }
+
+    //==============================================================================
+    // Audio thread, once per block: the Signal Quality setting and the phone (which sets how the signal drifts)
+    void setQuality (int newQuality, int newPhone) noexcept
+    {
+        quality = juce::jlimit (0, numQualities - 1, newQuality);
+        phone = juce::jlimit (0, numPhones - 1, newPhone);
+    }
+
+    float getSignalStrength() const noexcept        { return strength; }
+    int getSignalBars() const noexcept              { return juce::jlimit (1, 5, (int) (strength * 4.0f) + 1); }
+    bool isDroppingOut() const noexcept             { return dropoutSamplesLeft > 0; }
+    float getVoiceActivity() const noexcept         { return voiceActivity; }
+
+    //==============================================================================
+    // Runs numSamples of every channel through the link in place
+    void process (float* const* channels, int numChannels, int numSamples, NoiseGenerator& noise) noexcept
+    {
+        for (int start = 0; start < numSamples; start += envelope.getNumSamples())
+        {
+            const int numThisTime = juce::jmin (envelope.getNumSamples(), numSamples - start);
+            processChunk (channels, numChannels, start, numThisTime, noise);
+        }
+    }
+
+private:
+    //==============================================================================
+    static constexpr double voiceTimeConstant = 0.01;
+    static constexpr double strengthTimeConstant = 0.5;
+    static constexpr double silenceBeforeSagging = 2.0;         // Seconds
+    static constexpr float choppedGain = 0.3f;
+
+    static float getFixedStrength (int quality) noexcept
+    {
+        static constexpr float strengths[numQualities] = { 1.0f, 0.9f, 0.75f, 0.6f, 0.4f, 1.0f };
+        return strengths[quality];
+    }
+
+    int toSamples (double seconds) const noexcept   { return (int) (seconds * sampleRate); }
+
+    //==============================================================================
+    void processChunk (float* const* channels, int numChannels, int offset, int numSamples, NoiseGenerator& noise) noexcept
+    {
+        auto* gains = envelope.getWritePointer (0);
+        auto* clicks = crackle.getWritePointer (0);
+        juce::FloatVectorOperations::clear (clicks, numSamples);
+
+        // Control ticks: the envelope ramps across each one, and the input level is measured over it
+        for (int start = 0; start < numSamples;)
+        {
+            if (tickPosition == 0)
+                startTick (noise);
+
+            const int numThisTime = juce::jmin (numSamples - start, tickLength - tickPosition);
+
+            for (int i = 0; i < numThisTime; ++i)
+                gains[start + i] = gain + gainStep * (float) i;
+
+            gain += gainStep * (float) numThisTime;
+
+            if (clickPosition >= tickPosition && clickPosition < tickPosition + numThisTime)
+                clicks[start + clickPosition - tickPosition] = clickValue;
+
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                const auto range = juce::FloatVectorOperations::findMinAndMax (channels[channel] + offset + start, numThisTime);
+                tickPeak = juce::jmax (tickPeak, -range.getStart(), range.getEnd());
+            }
+
+            start += numThisTime;
+            tickPosition += numThisTime;
+
+            if (tickPosition == tickLength)
+            {
+                endTick (noise);
+                tickPosition = 0;
+            }
+        }
+
+        // The strength barely moves within a block, so the compression and noise take its current value
+        const bool weak = strength < 0.8f;
+        const float compressionIntensity = (1.0f - strength) * 0.3f;
+        const float threshold = 0.5f - compressionIntensity * 0.1f;
+        const float inverseRatio = 1.0f / (1.5f + compressionIntensity * 2.0f);
+        const float noiseLevel = (1.0f - strength) * 0.015f;
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto* data = channels[channel] + offset;
+
+            juce::FloatVectorOperations::multiply (data, gains, numSamples);
+            juce::FloatVectorOperations::add (data, clicks, numSamples);
+
+            if (! weak)
+                continue;
+
+            // Gentle compression above the threshold
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const float magnitude = std::abs (data[i]);
+
+                if (magnitude > threshold)
+                    data[i] = std::copysign (threshold + (magnitude - threshold) * inverseRatio, data[i]);
+            }
+
+            auto* hiss = noiseScratch.getWritePointer (0);
+            noise.fillBipolar (hiss, numSamples, noiseLevel);
+            juce::FloatVectorOperations::add (data, hiss, numSamples);
+        }
+    }
+
+    // Decides this tick's gain (and any crackle) from the current state
+    void startTick (NoiseGenerator& noise) noexcept
+    {
+        const bool breakingUp = isDroppingOut() || strength < 0.5f;
+        const float chopProbability = breakingUp ? 0.5f - strength : 0.0f;
+
+        targetGain = noise.nextFloat() < chopProbability ? choppedGain : 1.0f;
+        gainStep = (targetGain - gain) / (float) tickLength;
+
+        clickPosition = -1;
+
+        if (breakingUp && noise.nextFloat() < 0.002f * (float) tickLength)
+        {
+            clickPosition = juce::jmin (tickLength - 1, (int) (noise.nextFloat() * (float) tickLength));
+            clickValue = (noise.nextFloat() * 2.0f - 1.0f) * 0.02f;
+        }
+    }
+
+    // Moves the state machine on by one tick, given the input's peak level over it
+    void endTick (NoiseGenerator& noise) noexcept
+    {
+        gain = targetGain;
+
+        // Voice activity follows the input level, ignoring the noise floor
+        voiceActivity += ((tickPeak > 0.01f ? tickPeak : 0.0f) - voiceActivity) * voiceSmoothing;
+        tickPeak = 0.0f;
+
+        // Silence is counted up to the point the signal starts to sag
+        const int sagAfter = toSamples (silenceBeforeSagging);
+        const bool wasSagging = samplesSilent > sagAfter;
+        samplesSilent = voiceActivity > 0.05f ? 0 : juce::jmin (samplesSilent + tickLength, sagAfter + tickLength);
+
+        if (quality == autoDynamic)
+            updateDynamics (! wasSagging && samplesSilent > sagAfter, noise);
+        else
+            targetStrength = getFixedStrength (quality);
+
+        strength += (targetStrength - strength) * strengthSmoothing;
+    }
+
+    void updateDynamics (bool startsSagging, NoiseGenerator& noise) noexcept
+    {
+        // A signal that's already dropped out comes back when the dropout is over
+        if (dropoutSamplesLeft > 0)
+        {
+            dropoutSamplesLeft -= tickLength;
+
+            if (dropoutSamplesLeft <= 0)
+            {
+                dropoutSamplesLeft = 0;
+                targetStrength = 0.7f + noise.nextFloat() * 0.3f;
+            }
+
+            return;
+        }
+
+        // Talking steadies the signal, a long silence lets it sag
+        const bool nowTalking = voiceActivity > 0.1f;
+
+        if (nowTalking && ! talking)
+            targetStrength = 0.8f + noise.nextFloat() * 0.2f;
+        else if (startsSagging)
+            targetStrength = 0.6f + noise.nextFloat() * 0.3f;
+
+        talking = nowTalking;
+
+        // Every 5 - 10 seconds the signal drifts, within the phone's range
+        samplesUntilDrift -= tickLength;
+
+        if (samplesUntilDrift <= 0)
+        {
+            samplesUntilDrift = toSamples (5.0 + noise.nextFloat() * 5.0);
+
+            switch (phone)
+            {
+                case 0:     // Nokia: very stable, the odd dip
+                    targetStrength = noise.nextFloat() > 0.98f ? 0.6f : 0.8f + noise.nextFloat() * 0.2f;
+                    break;
+
+                case 1:     // iPhone: excellent
+                    targetStrength = 0.9f + noise.nextFloat() * 0.1f;
+                    break;
+
+                default:    // Sony Ericsson: a little more variable
+                    targetStrength = 0.7f + noise.nextFloat() * 0.3f;
+                    break;
+            }
+        }
+
+        // The weaker the signal, the likelier a dropout: once a minute at 90%, every 12 seconds at 60%
+        const float dropoutsPerSecond = (1.0f - strength) * 0.2f;
+
+        if (noise.nextFloat() < dropoutsPerSecond * (float) tickLength / (float) sampleRate)
+        {
+            dropoutSamplesLeft = toSamples (0.5 + noise.nextFloat() * 2.0);
+            targetStrength = 0.1f;
+        }
+    }
+
+    //==============================================================================
+    double sampleRate = 8000.0;
+    int tickLength = 8;
+    float voiceSmoothing = 1.0f, strengthSmoothing = 1.0f;
+
+    int quality = 0;
+    int phone = 0;
+
+    // Per tick
+    int tickPosition = 0;
+    float tickPeak = 0.0f;
+    float gain = 1.0f, targetGain = 1.0f, gainStep = 0.0f;
+    int clickPosition = -1;
+    float clickValue = 0.0f;
+
+    // The link, in sample counts
+    float strength = 1.0f, targetStrength = 1.0f;
+    float voiceActivity = 0.0f;
+    bool talking = false;
+    int samplesSilent = 0;
+    int samplesUntilDrift = 0;
+    int dropoutSamplesLeft = 0;
+
+    juce::AudioBuffer<float> envelope;      // One chunk of per-sample gain, shared by every channel
+    juce::AudioBuffer<float> crackle;
+    juce::AudioBuffer<float> noiseScratch;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SignalQualityEngine)
+};
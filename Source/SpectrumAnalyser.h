@@ -0,0 +1,169 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    A spectrum analyser for the phone screens, so the band-limiting can be
+    seen as well as heard.
+
+    The audio thread only pushes samples: pushSamples() mixes the block to
+    mono straight into a lock-free juce::AbstractFifo, a couple of vector
+    operations per block, and drops what doesn't fit if no one is reading.
+    Everything else happens on the reader's thread (the editor's timer, at
+    about 30Hz): computeSpectrum() drains the FIFO into a sliding window,
+    runs a Hann-windowed FFT over the latest fftSize samples, and bins the
+    magnitudes into numBands log-spaced bands from 20Hz to 20kHz (or
+    Nyquist). Band levels are in dB, mapped to 0-1 over the display range,
+    rise instantly and fall back at a fixed rate.
+
+    The FIFO is allocated once, up front, so the two sides never race over
+    a resize. One writer thread (the audio thread) and one reader thread.
+*/
+class SpectrumAnalyser
+{
+public:
+    static constexpr int numBands = 32;
+    using Bands = std::array<float, numBands>;      // 0 = at or below the floor, 1 = full scale
+
+    SpectrumAnalyser()
+    {
+        fifoSamples.setSize (1, fifoSize);
+        fifoSamples.clear();
+    }
+
+    //==============================================================================
+    // Before playback: the rate of the samples that will be pushed
+    void prepare (double newSampleRate) noexcept
+    {
+        sampleRate.store (newSampleRate, std::memory_order_relaxed);
+    }
+
+    // Audio thread: numSamples of each channel, mixed to mono
+    void pushSamples (const float* const* channels, int numChannels, int numSamples) noexcept
+    {
+        if (numChannels <= 0)
+            return;
+
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite (numSamples, start1, size1, start2, size2);
+
+        auto* destination = fifoSamples.getWritePointer (0);
+        const float channelGain = 1.0f / (float) numChannels;
+
+        for (auto [start, size, offset] : { std::array<int, 3> { start1, size1, 0 }, std::array<int, 3> { start2, size2, size1 } })
+        {
+            if (size <= 0)
+                continue;
+
+            juce::FloatVectorOperations::multiply (destination + start, channels[0] + offset, channelGain, size);
+
+            for (int channel = 1; channel < numChannels; ++channel)
+                juce::FloatVectorOperations::addWithMultiply (destination + start, channels[channel] + offset, channelGain, size);
+        }
+
+        fifo.finishedWrite (size1 + size2);
+    }
+
+    //==============================================================================
+    // Reader thread: takes in everything pushed since the last call and updates bands from the latest window
+    void computeSpectrum (Bands& bands)
+    {
+        drainFifo();
+
+        const double rate = sampleRate.load (std::memory_order_relaxed);
+
+        if (rate != bandsSampleRate)
+            layOutBands (rate);
+
+        std::copy (window.begin(), window.end(), fftData.begin());
+        hann.multiplyWithWindowingTable (fftData.data(), (size_t) fftSize);
+        fft.performFrequencyOnlyForwardTransform (fftData.data(), true);
+
+        for (int band = 0; band < numBands; ++band)
+        {
+            const auto& range = bandBins[(size_t) band];
+            float magnitude = 0.0f;
+
+            for (int bin = range.getStart(); bin < range.getEnd(); ++bin)
+                magnitude = juce::jmax (magnitude, fftData[(size_t) bin]);
+
+            // A Hann-windowed sine of amplitude A peaks at A * fftSize / 4
+            const float level = juce::Decibels::gainToDecibels (magnitude * 4.0f / (float) fftSize, floorDb);
+            const float position = juce::jmap (level, floorDb, 0.0f, 0.0f, 1.0f);
+
+            bands[(size_t) band] = juce::jmax (position, bands[(size_t) band] - fallPerUpdate);
+        }
+    }
+
+private:
+    //==============================================================================
+    static constexpr int fftOrder = 11;
+    static constexpr int fftSize = 1 << fftOrder;
+    static constexpr int fifoSize = 1 << 15;            // A second of 32kHz, a sixth of 192kHz, between updates
+    static constexpr float floorDb = -72.0f;
+    static constexpr float fallPerUpdate = 1.5f / 72.0f; // 1.5dB per update, 45dB/s at 30Hz
+    static constexpr float lowestFrequency = 20.0f, highestFrequency = 20000.0f;
+
+    // Moves what's in the FIFO onto the end of the sliding window
+    void drainFifo()
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToRead (fifo.getNumReady(), start1, size1, start2, size2);
+
+        const auto* source = fifoSamples.getReadPointer (0);
+
+        for (auto [start, size] : { std::array<int, 2> { start1, size1 }, std::array<int, 2> { start2, size2 } })
+        {
+            const int numToKeep = juce::jmin (size, fftSize);
+            const int numToShift = fftSize - numToKeep;
+
+            std::memmove (window.data(), window.data() + numToKeep, sizeof (float) * (size_t) numToShift);
+            std::memcpy (window.data() + numToShift, source + start + size - numToKeep, sizeof (float) * (size_t) numToKeep);
+        }
+
+        fifo.finishedRead (size1 + size2);
+    }
+
+    // Which FFT bins each band covers; a band narrower than a bin takes the bin its centre falls in
+    void layOutBands (double rate)
+    {
+        bandsSampleRate = rate;
+
+        const float binWidth = (float) (rate / fftSize);
+        const float top = juce::jmin (highestFrequency, (float) rate * 0.5f);
+        const float ratio = std::pow (top / lowestFrequency, 1.0f / (float) numBands);
+
+        for (int band = 0; band < numBands; ++band)
+        {
+            const float low = lowestFrequency * std::pow (ratio, (float) band);
+            const float high = low * ratio;
+
+            int first = juce::roundToInt (low / binWidth);
+            int last = juce::roundToInt (high / binWidth);
+
+            if (last <= first)
+            {
+                first = juce::roundToInt (std::sqrt (low * high) / binWidth);
+                last = first + 1;
+            }
+
+            bandBins[(size_t) band] = { juce::jlimit (0, fftSize / 2, first), juce::jlimit (1, fftSize / 2 + 1, last) };
+        }
+    }
+
+    //==============================================================================
+    juce::AbstractFifo fifo { fifoSize };
+    juce::AudioBuffer<float> fifoSamples;
+    std::atomic<double> sampleRate { 44100.0 };
+
+    // Reader thread only
+    juce::dsp::FFT fft { fftOrder };
+    juce::dsp::WindowingFunction<float> hann { (size_t) fftSize, juce::dsp::WindowingFunction<float>::hann, false };
+    std::array<float, fftSize> window {};               // The latest fftSize samples
+    std::array<float, 2 * fftSize> fftData {};
+    std::array<juce::Range<int>, numBands> bandBins;
+    double bandsSampleRate = 0.0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SpectrumAnalyser)
+};
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "NoiseEngine.h"
+#include "OscillatorBank.h"
+
+//==============================================================================
+/**
+    The "phone next to a TV" buzz, one generator per plugin instance.
+
+    The three models are the per-sample TV interference models the processor
+    used to run (GSM bursts into a CRT for the Nokia, LCD refresh whine for
+    the iPhone, CRT deflection hum for the Sony Ericsson), reworked to render
+    a block at a time: their tones come from an OscillatorBank, their static
+    and pops from a NoiseGenerator block fill.
+
+    The interference is an outside source, so it is rendered once as a mono
+    signal and the caller adds it to every channel. All state lives in the
+    instance and is cleared by prepare(), and the object sits on its own cache
+    lines, so hosts running many instances on parallel threads share nothing.
+*/
+class alignas (64) TVInterferenceGenerator
+{
+public:
+    enum Model
+    {
+        nokiaCRT = 0,         // Nokia near a CRT TV
+        iPhoneLCD = 1,        // iPhone near an LCD/LED TV
+        sonyEricssonCRT = 2   // Sony Ericsson near an old CRT TV
+    };
+
+    TVInterferenceGenerator() = default;
+
+    //==============================================================================
+    void prepare (double newSampleRate) noexcept
+    {
+        sampleRate = newSampleRate;
+        oscillators.prepare (sampleRate);
+
+        // GSM burst every 4.6ms
+        burstPeriodSamples = juce::jmax (1, static_cast<int> (std::ceil (0.0046 * sampleRate)));
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        oscillators.reset();
+        samplesUntilBurstChange = burstPeriodSamples;
+        burstState = 0;
+    }
+
+    //==============================================================================
+    // Writes numSamples of interference (without the input) for the given model.
+    // An intensity below 0.5 means TV interference is off and renders silence.
+    void render (float* destination, int numSamples, Model model, float intensity, NoiseGenerator& noise) noexcept
+    {
+        if (intensity < 0.5f)
+        {
+            std::fill (destination, destination + numSamples, 0.0f);
+            return;
+        }
+
+        for (int start = 0; start < numSamples; start += chunkSize)
+        {
+            const int numThisTime = juce::jmin (chunkSize, numSamples - start);
+            auto* chunk = destination + start;
+
+            switch (model)
+            {
+                case nokiaCRT:          renderNokia (chunk, numThisTime, intensity, noise); break;
+                case iPhoneLCD:         renderIPhone (chunk, numThisTime, intensity, noise); break;
+                case sonyEricssonCRT:   renderSonyEricsson (chunk, numThisTime, intensity, noise); break;
+                default:                std::fill (chunk, chunk + numThisTime, 0.0f); break;
+            }
+        }
+    }
+
+private:
+    //==============================================================================
+    static constexpr int chunkSize = 64;
+
+    enum Oscillator
+    {
+        scanlineOscillator = 0,       // Scanline / refresh / deflection tone
+        interferenceOscillator = 1    // Carrier / switching / mains tone
+    };
+
+    // Nokia 3310 near CRT TV: 217Hz GSM carrier gated by the 4-state burst pattern,
+    // modulated by a 1kHz scanline buzz, with occasional digital clicks
+    void renderNokia (float* output, int numSamples, float intensity, NoiseGenerator& noise) noexcept
+    {
+        float scanline[chunkSize], popChance[chunkSize], popLevel[chunkSize];
+
+        oscillators.setFrequency (scanlineOscillator, 1000.0);
+        oscillators.setFrequency (interferenceOscillator, 217.0);
+        oscillators.render (scanlineOscillator, scanline, numSamples);
+        noise.fillUniform (popChance, numSamples);
+        noise.fillBipolar (popLevel, numSamples, 0.02f * intensity);
+
+        // Walk the chunk in runs of constant burst state; the carrier only advances while a burst is active
+        for (int start = 0; start < numSamples;)
+        {
+            const int runLength = juce::jmin (numSamples - start, samplesUntilBurstChange);
+            auto* run = output + start;
+
+            if (burstState == 0 || burstState == 2)
+            {
+                oscillators.render (interferenceOscillator, run, runLength);
+
+                for (int i = 0; i < runLength; ++i)
+                {
+                    const int n = start + i;
+                    const float tvBuzz = run[i] * (0.8f + scanline[n] * 0.1f) * 0.03f * intensity;
+                    run[i] = tvBuzz + (popChance[n] > 0.98f ? popLevel[n] : 0.0f);
+                }
+            }
+            else
+            {
+                std::fill (run, run + runLength, 0.0f);
+            }
+
+            start += runLength;
+            samplesUntilBurstChange -= runLength;
+
+            if (samplesUntilBurstChange == 0)
+            {
+                samplesUntilBurstChange = burstPeriodSamples;
+                burstState = (burstState + 1) % 4;
+            }
+        }
+    }
+
+    // iPhone near LCD/LED TV: 60Hz refresh and 120Hz power-supply switching whine
+    void renderIPhone (float* output, int numSamples, float intensity, NoiseGenerator& noise) noexcept
+    {
+        float popChance[chunkSize], popLevel[chunkSize];
+        const float level = intensity * 0.02f;
+
+        std::fill (output, output + numSamples, 0.0f);
+        oscillators.setFrequency (scanlineOscillator, 60.0);
+        oscillators.setFrequency (interferenceOscillator, 120.0);
+        oscillators.renderAdd (interferenceOscillator, output, numSamples, 0.03f * level);
+        oscillators.renderAdd (scanlineOscillator, output, numSamples, 0.02f * level);
+
+        noise.fillUniform (popChance, numSamples);
+        noise.fillBipolar (popLevel, numSamples, 0.01f * intensity);
+
+        for (int i = 0; i < numSamples; ++i)
+            output[i] += popChance[i] > 0.998f ? popLevel[i] : 0.0f;
+    }
+
+    // Sony Ericsson near old CRT TV: fluttering 500Hz deflection buzz, 50Hz mains hum and analog static
+    void renderSonyEricsson (float* output, int numSamples, float intensity, NoiseGenerator& noise) noexcept
+    {
+        float popChance[chunkSize], popLevel[chunkSize];
+        const float level = intensity * 0.03f;
+
+        // The sweep flutter is drawn once per chunk (it was per sample) - at +/-0.25Hz nobody hears the difference
+        const float flutterAmount = noise.nextFloat() * 0.01f - 0.005f;
+        oscillators.setFrequency (scanlineOscillator, 500.0 + flutterAmount * 50.0);
+        oscillators.setFrequency (interferenceOscillator, 50.0);
+
+        noise.fillBipolar (output, numSamples, 0.01f * level);  // Analog static
+        oscillators.renderAdd (scanlineOscillator, output, numSamples, 0.03f * level);
+        oscillators.renderAdd (interferenceOscillator, output, numSamples, 0.02f * level);
+
+        noise.fillUniform (popChance, numSamples);
+        noise.fillBipolar (popLevel, numSamples, 0.03f * intensity);
+
+        for (int i = 0; i < numSamples; ++i)
+            output[i] += popChance[i] > 0.995f ? popLevel[i] : 0.0f;
+    }
+
+    //==============================================================================
+    double sampleRate = 44100.0;
+    OscillatorBank oscillators;
+
+    int burstPeriodSamples = 1;
+    int samplesUntilBurstChange = 1;
+    int burstState = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TVInterferenceGenerator)
+};
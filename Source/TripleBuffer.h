@@ -0,0 +1,63 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Hands the latest value of a small, trivially copyable struct from one
+    thread to another, wait-free on both sides.
+
+    There are three slots: the writer fills the back one, the reader reads
+    the front one, and the middle one holds the latest finished value. A
+    write fills the back slot and swaps it with the middle; a read swaps the
+    middle into the front if anything new has arrived there since. The swap
+    is a single atomic exchange of the slot indices, so neither side ever
+    waits for the other or sees a half-written value, and the reader always
+    gets the latest complete value (values it was too slow for are skipped).
+
+    One writer thread and one reader thread only.
+*/
+template <typename ValueType>
+class TripleBuffer
+{
+public:
+    static_assert (std::is_trivially_copyable_v<ValueType>, "TripleBuffer copies values with no locking");
+
+    TripleBuffer() = default;
+
+    //==============================================================================
+    // Writer thread: publishes a new value
+    void write (const ValueType& newValue) noexcept
+    {
+        slots[(size_t) backIndex].value = newValue;
+        backIndex = middle.exchange (backIndex | freshFlag, std::memory_order_acq_rel) & indexMask;
+    }
+
+    // Reader thread: the latest value written (or the value-initialised one before any write)
+    ValueType read() noexcept
+    {
+        if ((middle.load (std::memory_order_relaxed) & freshFlag) != 0)
+            frontIndex = middle.exchange (frontIndex, std::memory_order_acq_rel) & indexMask;
+
+        return slots[(size_t) frontIndex].value;
+    }
+
+private:
+    //==============================================================================
+    static constexpr int indexMask = 3;
+    static constexpr int freshFlag = 4;     // Set on the middle index when it holds a value not yet read
+
+    // Each slot on its own cache line, so the two threads don't share one
+    struct alignas (64) Slot
+    {
+        ValueType value {};
+    };
+
+    std::array<Slot, 3> slots;
+
+    int backIndex = 0;                      // Writer only
+    std::atomic<int> middle { 1 };
+    int frontIndex = 2;                     // Reader only
+
+    JUCE_DECLARE_NON_COPYABLE (TripleBuffer)
+};
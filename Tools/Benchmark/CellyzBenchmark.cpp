@@ -0,0 +1,370 @@
+/*
+  ==============================================================================
+
+    CellyzBenchmark.cpp
+
+    Command-line throughput benchmark for TestAudioProcessor. Runs the same
+    stereo 48kHz program material through the fused and the staged pipelines
+    and reports how much faster than real time each one is, then times the
+    SIMD distortion kernels against the scalar applyPhoneDistortion.
+
+    --verify checks the SIMD waveshapers and their fast sin/tanh/atan against
+    the scalar reference instead, and exits non-zero if any bound is broken.
+
+    --suite runs the per-stage micro-benchmarks instead (StageBenchmarks.h):
+    every DSP stage and the whole processBlock at block sizes 32-2048, mono
+    and stereo, 44.1/48/96kHz, reporting ns/sample and realtime factor.
+    --json writes the results as JSON for regression tracking.
+
+    Build (from Builds/LinuxMakefile):  make -f Tools.mk CONFIG=Release benchmark
+    Run:  build/CellyzBenchmark [--seconds 20] [--block 512] [--runs 5] [--verify]
+          build/CellyzBenchmark --suite [--json results.json] [--seconds 1] [--runs 3]
+                                [--stage applyJitter,processBlock.fused] [--quick]
+
+  ==============================================================================
+*/
+
+#include "../../Source/PluginProcessor.h"
+#include "../../Source/PhoneWaveshaper.h"
+#include "ProgramMaterial.h"
+#include "StageBenchmarks.h"
+#include <iostream>
+#include <limits>
+
+namespace
+{
+    constexpr double benchmarkSampleRate = 48000.0;
+    constexpr int benchmarkNumChannels = 2;
+
+    void setParameter (TestAudioProcessor& processor, const juce::String& parameterID, float value)
+    {
+        if (auto* parameter = processor.apvts.getParameter (parameterID))
+            parameter->setValueNotifyingHost (parameter->convertTo0to1 (value));
+    }
+
+    struct Scenario
+    {
+        const char* name;
+        float distortion, compression, interference, tvInterference;
+    };
+
+    //==============================================================================
+    // Returns the fastest of several passes over the material, in seconds
+    double timeProcessor (TestAudioProcessor& processor, const juce::AudioBuffer<float>& material, int blockSize, int numRuns)
+    {
+        juce::AudioBuffer<float> block (benchmarkNumChannels, blockSize);
+        juce::MidiBuffer midi;
+        double bestSeconds = std::numeric_limits<double>::max();
+
+        // The first pass only warms caches and settles the filter crossfades
+        for (int run = 0; run <= numRuns; ++run)
+        {
+            const auto startTicks = juce::Time::getHighResolutionTicks();
+
+            for (int start = 0; start < material.getNumSamples(); start += blockSize)
+            {
+                const int numThisTime = juce::jmin (blockSize, material.getNumSamples() - start);
+                block.setSize (benchmarkNumChannels, numThisTime, false, false, true);
+
+                for (int channel = 0; channel < benchmarkNumChannels; ++channel)
+                    block.copyFrom (channel, 0, material, channel, start, numThisTime);
+
+                processor.processBlock (block, midi);
+            }
+
+            const double seconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks);
+
+            if (run > 0)
+                bestSeconds = juce::jmin (bestSeconds, seconds);
+        }
+
+        return bestSeconds;
+    }
+
+    double runScenario (const Scenario& scenario, TestAudioProcessor::ProcessingMode mode,
+                        const juce::AudioBuffer<float>& material, int blockSize, int numRuns)
+    {
+        TestAudioProcessor processor;
+        processor.setRateAndBufferSizeDetails (benchmarkSampleRate, blockSize);
+        processor.setProcessingMode (mode);
+        processor.setNoiseSeed (1); // Same noise in every run and mode
+
+        setParameter (processor, TestAudioProcessor::LOW_CUT_ID, 3.0f);
+        setParameter (processor, TestAudioProcessor::HIGH_CUT_ID, 3.0f);
+        setParameter (processor, TestAudioProcessor::WET_DRY_MIX_ID, 0.8f);
+        setParameter (processor, TestAudioProcessor::DISTORTION_ID, scenario.distortion);
+        setParameter (processor, TestAudioProcessor::COMPRESSION_ID, scenario.compression);
+        setParameter (processor, TestAudioProcessor::INTERFERENCE_ID, scenario.interference);
+        setParameter (processor, TestAudioProcessor::TV_INTERFERENCE_ID, scenario.tvInterference);
+
+        processor.prepareToPlay (benchmarkSampleRate, blockSize);
+        const double seconds = timeProcessor (processor, material, blockSize, numRuns);
+        processor.releaseResources();
+
+        return seconds;
+    }
+
+    //==============================================================================
+    // Distortion stage on its own: scalar per-sample reference vs the block kernels
+    void runDistortionKernel (TestAudioProcessor::PhoneType phoneType, float* data, const float* noise, int numSamples, float amount)
+    {
+        switch (phoneType)
+        {
+            case TestAudioProcessor::Nokia:         PhoneWaveshaper::processNokia (data, noise, numSamples, amount); break;
+            case TestAudioProcessor::iPhone:        PhoneWaveshaper::processIPhone (data, numSamples, amount); break;
+            case TestAudioProcessor::SonyEricsson:  PhoneWaveshaper::processSonyEricsson (data, numSamples, amount); break;
+            default: break;
+        }
+    }
+
+    template <typename Function>
+    double bestOf (int numRuns, Function&& function)
+    {
+        double bestSeconds = std::numeric_limits<double>::max();
+
+        for (int run = 0; run <= numRuns; ++run)
+        {
+            const auto startTicks = juce::Time::getHighResolutionTicks();
+            function();
+            const double seconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks);
+
+            if (run > 0)
+                bestSeconds = juce::jmin (bestSeconds, seconds);
+        }
+
+        return bestSeconds;
+    }
+
+    void benchmarkDistortion (const juce::AudioBuffer<float>& material, int numRuns)
+    {
+        const char* phoneNames[] = { "Nokia", "iPhone", "SonyEricsson" };
+        const float amount = 0.25f;   // Below the Nokia noise threshold, so both sides do identical work
+        const int numSamples = material.getNumSamples();
+
+        TestAudioProcessor reference;
+        std::vector<float> work ((size_t) numSamples);
+
+        std::cout << std::endl << juce::String ("distortion stage").paddedRight (' ', 22)
+                  << juce::String ("scalar (Ms/s)").paddedLeft (' ', 16)
+                  << juce::String ("SIMD (Ms/s)").paddedLeft (' ', 16)
+                  << juce::String ("speedup").paddedLeft (' ', 10) << std::endl;
+
+        for (int phone = 0; phone < 3; ++phone)
+        {
+            const auto phoneType = static_cast<TestAudioProcessor::PhoneType> (phone);
+
+            const double scalarSeconds = bestOf (numRuns, [&]
+            {
+                std::copy (material.getReadPointer (0), material.getReadPointer (0) + numSamples, work.begin());
+
+                for (auto& sample : work)
+                    sample = reference.applyPhoneDistortion (sample, phoneType, amount);
+            });
+
+            const double simdSeconds = bestOf (numRuns, [&]
+            {
+                std::copy (material.getReadPointer (0), material.getReadPointer (0) + numSamples, work.begin());
+                runDistortionKernel (phoneType, work.data(), nullptr, numSamples, amount);
+            });
+
+            std::cout << juce::String (phoneNames[phone]).paddedRight (' ', 22)
+                      << juce::String (numSamples / scalarSeconds / 1.0e6, 1).paddedLeft (' ', 16)
+                      << juce::String (numSamples / simdSeconds / 1.0e6, 1).paddedLeft (' ', 16)
+                      << (juce::String (scalarSeconds / simdSeconds, 2) + "x").paddedLeft (' ', 10) << std::endl;
+        }
+    }
+
+    //==============================================================================
+    // Accuracy of the SIMD waveshapers against the scalar reference
+    bool checkBound (const char* name, double maxError, double bound)
+    {
+        const bool passed = maxError <= bound;
+        std::cout << (passed ? "  ok    " : "  FAIL  ") << juce::String (name).paddedRight (' ', 28)
+                  << "max error " << maxError << " (bound " << bound << ")" << std::endl;
+        return passed;
+    }
+
+    bool verifyWaveshapers()
+    {
+        std::cout << "Verifying SIMD waveshapers against the scalar reference" << std::endl;
+        bool passed = true;
+
+        // The approximations on their own, through both the scalar and the SIMD overloads
+        double sinError = 0.0, tanhError = 0.0, atanError = 0.0;
+
+        for (int i = 0; i <= 1000000; ++i)
+        {
+            const float x = -64.0f + 128.0f * static_cast<float> (i) / 1.0e6f;
+            const auto lanes = PhoneWaveshaper::Vec::expand (x);
+
+            sinError  = juce::jmax (sinError,  std::abs (PhoneWaveshaper::fastSin (x) - std::sin ((double) x)),
+                                               std::abs (PhoneWaveshaper::fastSin (lanes).get (0) - std::sin ((double) x)));
+            tanhError = juce::jmax (tanhError, std::abs (PhoneWaveshaper::fastTanh (x) - std::tanh ((double) x)),
+                                               std::abs (PhoneWaveshaper::fastTanh (lanes).get (0) - std::tanh ((double) x)));
+            atanError = juce::jmax (atanError, std::abs (PhoneWaveshaper::fastAtan (x) - std::atan ((double) x)),
+                                               std::abs (PhoneWaveshaper::fastAtan (lanes).get (0) - std::atan ((double) x)));
+        }
+
+        passed &= checkBound ("fastSin  |x| <= 64", sinError, 4.0e-6);
+        passed &= checkBound ("fastTanh", tanhError, 1.0e-6);
+        passed &= checkBound ("fastAtan", atanError, 4.0e-6);
+
+        // Full kernels against applyPhoneDistortion over a sweep of inputs and amounts.
+        // An odd length and offset start exercise the unaligned and scalar-tail paths.
+        TestAudioProcessor reference;
+        const int numSamples = 4097;
+        std::vector<float> input ((size_t) numSamples), output ((size_t) numSamples), noise ((size_t) numSamples, 0.0f);
+
+        for (int i = 0; i < numSamples; ++i)
+            input[(size_t) i] = -2.0f + 4.0f * static_cast<float> (i) / static_cast<float> (numSamples - 1);
+
+        const char* phoneNames[] = { "Nokia kernel", "iPhone kernel", "SonyEricsson kernel" };
+
+        for (int phone = 0; phone < 3; ++phone)
+        {
+            const auto phoneType = static_cast<TestAudioProcessor::PhoneType> (phone);
+            double worstError = 0.0, worstBound = 1.0e-5;
+
+            for (float amount : { 0.02f, 0.1f, 0.25f, 0.3f, 0.5f, 0.75f, 1.0f })
+            {
+                // Above 0.3 the Nokia reference adds its own random noise of up to 0.001 * amount,
+                // which the bite curve can amplify by a further 16% * amount
+                const bool referenceAddsNoise = phoneType == TestAudioProcessor::Nokia && amount > 0.3f;
+                const double bound = 1.0e-5 + (referenceAddsNoise ? 0.001 * amount * (1.0 + 0.16 * amount) : 0.0);
+
+                output = input;
+                runDistortionKernel (phoneType, output.data() + 1, noise.data() + 1, numSamples - 1, amount);
+
+                for (int i = 1; i < numSamples; ++i)
+                {
+                    const float expected = reference.applyPhoneDistortion (input[(size_t) i], phoneType, amount);
+                    const double error = std::abs (output[(size_t) i] - expected);
+
+                    if (error / bound > worstError / worstBound)
+                    {
+                        worstError = error;
+                        worstBound = bound;
+                    }
+                }
+            }
+
+            passed &= checkBound (phoneNames[phone], worstError, worstBound);
+        }
+
+        std::cout << (passed ? "All waveshapers within bounds" : "Waveshaper accuracy check FAILED") << std::endl;
+        return passed;
+    }
+}
+
+//==============================================================================
+namespace
+{
+    int runSuite (const juce::ArgumentList& args)
+    {
+        StageSuiteOptions options;
+
+        if (args.containsOption ("--seconds"))
+            options.secondsPerMeasurement = juce::jmax (0.05, args.getValueForOption ("--seconds").getDoubleValue());
+
+        if (args.containsOption ("--runs"))
+            options.numRuns = juce::jmax (1, args.getValueForOption ("--runs").getIntValue());
+
+        if (args.containsOption ("--stage"))
+        {
+            options.stages = juce::StringArray::fromTokens (args.getValueForOption ("--stage"), ",", {});
+            options.stages.trim();
+
+            for (const auto& name : options.stages)
+            {
+                if (! getBenchmarkStageNames().contains (name))
+                {
+                    std::cerr << "Unknown stage " << name << "; stages are: " << getBenchmarkStageNames().joinIntoString (", ") << std::endl;
+                    return 1;
+                }
+            }
+        }
+
+        // A quick pass for local iteration: three block sizes, one rate
+        if (args.containsOption ("--quick"))
+        {
+            options.blockSizes = { 64, 512, 2048 };
+            options.sampleRates = { 48000.0 };
+        }
+
+        std::cout << "Cellyz stage benchmarks: " << options.secondsPerMeasurement << " s of material per point, best of "
+                  << options.numRuns << " runs" << std::endl << std::endl;
+
+        const auto measurements = runStageSuite (options, std::cout);
+
+        if (args.containsOption ("--json"))
+        {
+            const auto file = args.getFileForOption ("--json");
+
+            if (! file.replaceWithText (juce::JSON::toString (stageMeasurementsToJSON (measurements, options))))
+            {
+                std::cerr << "Can't write " << file.getFullPathName() << std::endl;
+                return 1;
+            }
+
+            std::cout << std::endl << "Wrote " << file.getFullPathName() << std::endl;
+        }
+
+        return 0;
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ArgumentList args (argc, argv);
+
+    if (args.containsOption ("--verify"))
+        return verifyWaveshapers() ? 0 : 1;
+
+    if (args.containsOption ("--suite"))
+        return runSuite (args);
+
+    const auto optionOr = [&args] (const char* option, int fallback)
+    {
+        return args.containsOption (option) ? args.getValueForOption (option).getIntValue() : fallback;
+    };
+
+    const int materialSeconds = juce::jmax (1, optionOr ("--seconds", 20));
+    const int blockSize = juce::jmax (1, optionOr ("--block", 512));
+    const int numRuns = juce::jmax (1, optionOr ("--runs", 5));
+
+    juce::AudioBuffer<float> material (benchmarkNumChannels, static_cast<int> (benchmarkSampleRate) * materialSeconds);
+    fillProgramMaterial (material, benchmarkSampleRate);
+
+    const Scenario scenarios[] =
+    {
+        { "all stages",          0.6f, 0.5f, 0.3f, 1.0f },
+        { "distortion + comp",   0.6f, 0.5f, 0.0f, 0.0f },
+        { "filters + colour",    0.0f, 0.0f, 0.0f, 0.0f }
+    };
+
+    std::cout << "Cellyz pipeline benchmark: stereo " << benchmarkSampleRate / 1000.0 << " kHz, "
+              << materialSeconds << " s of material, block " << blockSize << ", best of " << numRuns << " runs" << std::endl
+              << std::endl;
+
+    std::cout << juce::String ("scenario").paddedRight (' ', 22)
+              << juce::String ("staged (x RT)").paddedLeft (' ', 16)
+              << juce::String ("fused (x RT)").paddedLeft (' ', 16)
+              << juce::String ("speedup").paddedLeft (' ', 10) << std::endl;
+
+    for (const auto& scenario : scenarios)
+    {
+        const double stagedSeconds = runScenario (scenario, TestAudioProcessor::Staged, material, blockSize, numRuns);
+        const double fusedSeconds  = runScenario (scenario, TestAudioProcessor::Fused,  material, blockSize, numRuns);
+
+        std::cout << juce::String (scenario.name).paddedRight (' ', 22)
+                  << juce::String (materialSeconds / stagedSeconds, 1).paddedLeft (' ', 16)
+                  << juce::String (materialSeconds / fusedSeconds, 1).paddedLeft (' ', 16)
+                  << (juce::String (stagedSeconds / fusedSeconds, 2) + "x").paddedLeft (' ', 10) << std::endl;
+    }
+
+    benchmarkDistortion (material, numRuns);
+
+    return 0;
+}
@@ -0,0 +1,38 @@
+/*
+  ==============================================================================
+
+    ProgramMaterial.h
+
+    Deterministic test signal shared by the benchmarks.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+// Speech-like test signal: a gliding harmonic voice gated at syllable rate plus a little noise
+inline void fillProgramMaterial (juce::AudioBuffer<float>& material, double sampleRate)
+{
+    juce::Random noise (0x43656c6c);
+    double phase = 0.0;
+
+    for (int sample = 0; sample < material.getNumSamples(); ++sample)
+    {
+        const double t = sample / sampleRate;
+        const double pitch = 140.0 + 40.0 * std::sin (2.0 * juce::MathConstants<double>::pi * 0.7 * t);
+        phase += 2.0 * juce::MathConstants<double>::pi * pitch / sampleRate;
+
+        double voice = 0.0;
+        for (int harmonic = 1; harmonic <= 8; ++harmonic)
+            voice += std::sin (phase * harmonic) / harmonic;
+
+        const double syllables = 0.5 + 0.5 * std::sin (2.0 * juce::MathConstants<double>::pi * 4.0 * t);
+        const float value = static_cast<float> (0.3 * voice * syllables) + (noise.nextFloat() - 0.5f) * 0.01f;
+
+        for (int channel = 0; channel < material.getNumChannels(); ++channel)
+            material.setSample (channel, sample, channel == 0 ? value : value * 0.9f);
+    }
+}
@@ -0,0 +1,314 @@
+/*
+  ==============================================================================
+
+    StageBenchmarks.cpp
+
+  ==============================================================================
+*/
+
+#include "StageBenchmarks.h"
+#include "ProgramMaterial.h"
+#include "../../Source/PhoneWaveshaper.h"
+#include <iostream>
+#include <limits>
+
+namespace
+{
+    using StageFunction = std::function<void (TestAudioProcessor&, juce::AudioBuffer<float>&)>;
+
+    struct Stage
+    {
+        const char* name;
+        StageFunction process;
+        bool inTelephoneBand = false;       // Runs on 8kHz blocks inside processBlock (see runStageSuite)
+    };
+
+    template <typename SampleFunction>
+    void forEachSample (juce::AudioBuffer<float>& buffer, SampleFunction&& function)
+    {
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+        {
+            auto* data = buffer.getWritePointer (channel);
+
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                data[i] = function (data[i]);
+        }
+    }
+
+    constexpr float distortionAmount = 0.6f;
+
+    // The SIMD waveshapers as the processor's distortion kernel runs them, Nokia quantization noise
+    // included (drawn up front in tiles), so they do the same work as applyPhoneDistortion
+    void waveshape (juce::AudioBuffer<float>& buffer, TestAudioProcessor::PhoneType phone, float amount)
+    {
+        static NoiseGenerator noise;
+        constexpr int tileSize = 64;
+
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+        {
+            auto* data = buffer.getWritePointer (channel);
+            const int numSamples = buffer.getNumSamples();
+
+            switch (phone)
+            {
+                case TestAudioProcessor::Nokia:
+                    for (int start = 0; start < numSamples; start += tileSize)
+                    {
+                        float quantizationNoise[tileSize];
+                        const int numThisTime = juce::jmin (tileSize, numSamples - start);
+                        const bool noisy = amount > 0.3f;
+
+                        if (noisy)
+                            noise.fillBipolar (quantizationNoise, numThisTime, 0.001f * amount);
+
+                        PhoneWaveshaper::processNokia (data + start, noisy ? quantizationNoise : nullptr, numThisTime, amount);
+                    }
+                    break;
+
+                case TestAudioProcessor::iPhone:        PhoneWaveshaper::processIPhone (data, numSamples, amount); break;
+                case TestAudioProcessor::SonyEricsson:  PhoneWaveshaper::processSonyEricsson (data, numSamples, amount); break;
+                default: break;
+            }
+        }
+    }
+
+    // Settings are mid-range values that keep each stage on its busy path
+    const std::vector<Stage>& getStages()
+    {
+        using P = TestAudioProcessor;
+
+        static const std::vector<Stage> stages
+        {
+            // Scalar reference and SIMD waveshaper, phone for phone, at the same amount
+            { "applyPhoneDistortion.nokia", [] (P& p, juce::AudioBuffer<float>& b)
+                { forEachSample (b, [&p] (float x) { return p.applyPhoneDistortion (x, P::Nokia, distortionAmount); }); } },
+
+            { "PhoneWaveshaper.nokia", [] (P&, juce::AudioBuffer<float>& b)
+                { waveshape (b, P::Nokia, distortionAmount); } },
+
+            { "applyPhoneDistortion.iphone", [] (P& p, juce::AudioBuffer<float>& b)
+                { forEachSample (b, [&p] (float x) { return p.applyPhoneDistortion (x, P::iPhone, distortionAmount); }); } },
+
+            { "PhoneWaveshaper.iphone", [] (P&, juce::AudioBuffer<float>& b)
+                { waveshape (b, P::iPhone, distortionAmount); } },
+
+            { "applyPhoneDistortion.sonyEricsson", [] (P& p, juce::AudioBuffer<float>& b)
+                { forEachSample (b, [&p] (float x) { return p.applyPhoneDistortion (x, P::SonyEricsson, distortionAmount); }); } },
+
+            { "PhoneWaveshaper.sonyEricsson", [] (P&, juce::AudioBuffer<float>& b)
+                { waveshape (b, P::SonyEricsson, distortionAmount); } },
+
+            { "applyPhoneCompression", [] (P& p, juce::AudioBuffer<float>& b)
+                { forEachSample (b, [&p] (float x) { return p.applyPhoneCompression (x, P::Nokia, 0.5f); }); } },
+
+            { "applyPhoneTonalColor", [] (P& p, juce::AudioBuffer<float>& b)
+                { forEachSample (b, [&p] (float x) { return p.applyPhoneTonalColor (x, P::SonyEricsson, 1.0f); }); } },
+
+            { "applyTVInterference", [] (P& p, juce::AudioBuffer<float>& b)
+                { forEachSample (b, [&p] (float x) { return p.applyTVInterference (x, P::Nokia, 1.0f); }); } },
+
+            { "applySignalQuality", [] (P& p, juce::AudioBuffer<float>& b)
+                { p.applySignalQuality (b, b.getNumChannels(), P::Nokia, P::Auto_Dynamic); }, true },
+
+            { "applyCodecSimulation", [] (P& p, juce::AudioBuffer<float>& b)
+                { p.applyCodecSimulation (b, b.getNumChannels(), P::GSM_FullRate, 0.7f); }, true },
+
+            { "applyPacketLoss", [] (P& p, juce::AudioBuffer<float>& b)
+                { p.applyPacketLoss (b, b.getNumChannels(), PacketLossStage::gilbertElliott, 0.1f); }, true },
+
+            { "applyJitter", [] (P& p, juce::AudioBuffer<float>& b)
+                { p.applyJitter (b, b.getNumChannels(), 30.0f); }, true },
+
+            { "applyStereoPositioning", [] (P& p, juce::AudioBuffer<float>& b)
+                { p.applyStereoPositioning (b, b.getNumChannels(), P::LeftEar, false); } },
+
+            { "applyStereoPositioning.binaural", [] (P& p, juce::AudioBuffer<float>& b)
+                { p.applyStereoPositioning (b, b.getNumChannels(), P::LeftEar, true); } },
+
+            { "generateBackgroundAmbience", [] (P& p, juce::AudioBuffer<float>& b)
+                { p.generateBackgroundAmbience (b, P::Cafe_Busy, 0.3f); }, true },
+
+            { "processBlock.fused", [] (P& p, juce::AudioBuffer<float>& b)
+                {
+                    juce::MidiBuffer midi;
+                    p.setProcessingMode (P::Fused);
+                    p.processBlock (b, midi);
+                } },
+
+            { "processBlock.staged", [] (P& p, juce::AudioBuffer<float>& b)
+                {
+                    juce::MidiBuffer midi;
+                    p.setProcessingMode (P::Staged);
+                    p.processBlock (b, midi);
+                } }
+        };
+
+        return stages;
+    }
+
+    void setParameter (TestAudioProcessor& processor, const juce::String& parameterID, float value)
+    {
+        if (auto* parameter = processor.apvts.getParameter (parameterID))
+            parameter->setValueNotifyingHost (parameter->convertTo0to1 (value));
+    }
+
+    // A processor configured like a typical session, with every processBlock stage switched on
+    std::unique_ptr<TestAudioProcessor> createProcessor (double sampleRate, int numChannels, int blockSize)
+    {
+        auto processor = std::make_unique<TestAudioProcessor>();
+        processor->setPlayConfigDetails (numChannels, numChannels, sampleRate, blockSize);
+        processor->setNoiseSeed (1);
+
+        setParameter (*processor, TestAudioProcessor::LOW_CUT_ID, 3.0f);
+        setParameter (*processor, TestAudioProcessor::HIGH_CUT_ID, 3.0f);
+        setParameter (*processor, TestAudioProcessor::WET_DRY_MIX_ID, 0.8f);
+        setParameter (*processor, TestAudioProcessor::DISTORTION_ID, 0.6f);
+        setParameter (*processor, TestAudioProcessor::COMPRESSION_ID, 0.5f);
+        setParameter (*processor, TestAudioProcessor::INTERFERENCE_ID, 0.3f);
+        setParameter (*processor, TestAudioProcessor::TV_INTERFERENCE_ID, 1.0f);
+
+        processor->prepareToPlay (sampleRate, blockSize);
+        return processor;
+    }
+
+    // Best time for one pass over the material in blockSize blocks. Every block is refilled from
+    // the material first, so the stages never see their own (possibly decayed) output.
+    double timeStage (const Stage& stage, TestAudioProcessor& processor, const juce::AudioBuffer<float>& material,
+                      juce::AudioBuffer<float>& block, int blockSize, int numRuns)
+    {
+        double bestSeconds = std::numeric_limits<double>::max();
+
+        for (int run = 0; run <= numRuns; ++run)
+        {
+            const auto startTicks = juce::Time::getHighResolutionTicks();
+
+            for (int start = 0; start + blockSize <= material.getNumSamples(); start += blockSize)
+            {
+                for (int channel = 0; channel < block.getNumChannels(); ++channel)
+                    block.copyFrom (channel, 0, material, channel, start, blockSize);
+
+                stage.process (processor, block);
+            }
+
+            const double seconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks);
+
+            if (run > 0)
+                bestSeconds = juce::jmin (bestSeconds, seconds);
+        }
+
+        return bestSeconds;
+    }
+}
+
+//==============================================================================
+juce::StringArray getBenchmarkStageNames()
+{
+    juce::StringArray names;
+
+    for (const auto& stage : getStages())
+        names.add (stage.name);
+
+    return names;
+}
+
+std::vector<StageMeasurement> runStageSuite (const StageSuiteOptions& options, std::ostream& log)
+{
+    std::vector<StageMeasurement> measurements;
+
+    log << juce::String ("stage").paddedRight (' ', 28) << juce::String ("rate").paddedLeft (' ', 7)
+        << juce::String ("ch").paddedLeft (' ', 4);
+
+    for (auto blockSize : options.blockSizes)
+        log << juce::String (blockSize).paddedLeft (' ', 9);
+
+    log << "   ns/host sample by block size; x RT at largest" << std::endl;
+
+    for (const auto& stage : getStages())
+    {
+        if (! options.stages.isEmpty() && ! options.stages.contains (stage.name))
+            continue;
+
+        for (auto sampleRate : options.sampleRates)
+        {
+            for (auto numChannels : options.channelCounts)
+            {
+                // Telephone-band stages get what processBlock gives them: 8kHz material, in the blocks
+                // each host block turns into, no longer than the band was prepared for
+                const double stageRate = stage.inTelephoneBand ? TestAudioProcessor::getTelephoneBandRate() : sampleRate;
+                const int materialLength = juce::jmax (1, static_cast<int> (stageRate * options.secondsPerMeasurement));
+                juce::AudioBuffer<float> material (numChannels, materialLength);
+                fillProgramMaterial (material, stageRate);
+
+                log << juce::String (stage.name).paddedRight (' ', 28) << juce::String (sampleRate / 1000.0, 1).paddedLeft (' ', 7)
+                    << juce::String (numChannels).paddedLeft (' ', 4);
+
+                double lastRealtimeFactor = 0.0;
+
+                for (auto blockSize : options.blockSizes)
+                {
+                    // A fresh processor per point, so no stage inherits another's state
+                    auto processor = createProcessor (sampleRate, numChannels, blockSize);
+
+                    const int stageBlockSize = stage.inTelephoneBand
+                        ? juce::jlimit (1, processor->getMaxTelephoneBandBlockSize(), (int) std::ceil (blockSize * stageRate / sampleRate))
+                        : blockSize;
+                    juce::AudioBuffer<float> block (numChannels, stageBlockSize);
+
+                    const int numBlocks = juce::jmax (1, materialLength / stageBlockSize);
+                    const double seconds = timeStage (stage, *processor, material, block, stageBlockSize, options.numRuns);
+
+                    // Results are per host sample: the audio timed, at the host's rate
+                    const double audioSecondsTimed = (double) numBlocks * stageBlockSize / stageRate;
+                    const double numSamplesTimed = audioSecondsTimed * sampleRate;
+
+                    StageMeasurement measurement;
+                    measurement.stage = stage.name;
+                    measurement.sampleRate = sampleRate;
+                    measurement.numChannels = numChannels;
+                    measurement.blockSize = blockSize;
+                    measurement.nsPerSample = seconds * 1.0e9 / (numSamplesTimed * numChannels);
+                    measurement.realtimeFactor = seconds > 0.0 ? audioSecondsTimed / seconds : 0.0;
+                    measurements.push_back (measurement);
+
+                    lastRealtimeFactor = measurement.realtimeFactor;
+                    log << juce::String (measurement.nsPerSample, 2).paddedLeft (' ', 9);
+
+                    processor->releaseResources();
+                }
+
+                log << juce::String (lastRealtimeFactor, 1).paddedLeft (' ', 12) << "x" << std::endl;
+            }
+        }
+    }
+
+    return measurements;
+}
+
+juce::var stageMeasurementsToJSON (const std::vector<StageMeasurement>& measurements, const StageSuiteOptions& options)
+{
+    juce::Array<juce::var> results;
+
+    for (const auto& measurement : measurements)
+    {
+        auto* entry = new juce::DynamicObject();
+        entry->setProperty ("stage", measurement.stage);
+        entry->setProperty ("sampleRate", measurement.sampleRate);
+        entry->setProperty ("channels", measurement.numChannels);
+        entry->setProperty ("blockSize", measurement.blockSize);
+        entry->setProperty ("nsPerSample", measurement.nsPerSample);
+        entry->setProperty ("realtimeFactor", measurement.realtimeFactor);
+        results.add (juce::var (entry));
+    }
+
+    auto* root = new juce::DynamicObject();
+    root->setProperty ("benchmark", "cellyz-stages");
+    root->setProperty ("formatVersion", 1);
+    root->setProperty ("timestamp", juce::Time::getCurrentTime().toISO8601 (true));
+    root->setProperty ("cpu", juce::SystemStats::getCpuModel());
+    root->setProperty ("numCpus", juce::SystemStats::getNumCpus());
+    root->setProperty ("secondsPerMeasurement", options.secondsPerMeasurement);
+    root->setProperty ("runs", options.numRuns);
+    root->setProperty ("results", results);
+
+    return juce::var (root);
+}
@@ -0,0 +1,52 @@
+/*
+  ==============================================================================
+
+    StageBenchmarks.h
+
+    Per-stage micro-benchmarks for TestAudioProcessor: every DSP stage on its
+    own plus the whole processBlock, over a grid of block sizes, channel
+    counts and sample rates.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "../../Source/PluginProcessor.h"
+#include <iosfwd>
+
+//==============================================================================
+struct StageSuiteOptions
+{
+    double secondsPerMeasurement = 1.0;     // Audio timed per measurement (per run)
+    int numRuns = 3;                        // Best of this many runs, after one warm-up run
+
+    std::vector<int> blockSizes { 32, 64, 128, 256, 512, 1024, 2048 };
+    std::vector<int> channelCounts { 1, 2 };
+    std::vector<double> sampleRates { 44100.0, 48000.0, 96000.0 };
+
+    juce::StringArray stages;               // Empty runs every stage
+};
+
+struct StageMeasurement
+{
+    juce::String stage;
+    double sampleRate = 0.0;
+    int numChannels = 0;
+    int blockSize = 0;
+
+    double nsPerSample = 0.0;               // Per host sample per channel. Telephone-band stages run on the 8kHz
+                                            // blocks processBlock gives them; their time is spread over the host
+                                            // samples those blocks stand for.
+    double realtimeFactor = 0.0;            // Seconds of audio processed per second of CPU
+};
+
+//==============================================================================
+// Names of every stage the suite knows, in the order it runs them
+juce::StringArray getBenchmarkStageNames();
+
+// Runs the grid, printing one table row per stage/rate/channel combination to 'log'
+std::vector<StageMeasurement> runStageSuite (const StageSuiteOptions& options, std::ostream& log);
+
+// Machine-readable results, for tracking regressions between builds
+juce::var stageMeasurementsToJSON (const std::vector<StageMeasurement>& measurements, const StageSuiteOptions& options);
@@ -0,0 +1,214 @@
+/*
+  ==============================================================================
+
+    BatchRenderer.cpp
+
+  ==============================================================================
+*/
+
+#include "BatchRenderer.h"
+#include <deque>
+#include <numeric>
+
+//==============================================================================
+class BatchRenderer::Worker : public juce::Thread
+{
+public:
+    Worker (BatchRenderer& ownerToUse, int indexToUse)
+        : juce::Thread ("Cellyz render worker " + juce::String (indexToUse + 1)),
+          owner (ownerToUse), index (indexToUse)
+    {
+    }
+
+    ~Worker() override
+    {
+        stopThread (-1);
+    }
+
+    void run() override
+    {
+        for (int job = owner.takeJob (index); job >= 0 && ! threadShouldExit(); job = owner.takeJob (index))
+        {
+            const auto& renderJob = owner.currentJobs->getReference (job);
+            const auto result = renderer.render (renderJob.source, renderJob.destination, renderJob.settings);
+
+            // Each job has its own slot, so only the callback needs the lock
+            (*owner.currentResults)[(size_t) job] = result;
+
+            if (owner.jobFinishedCallback != nullptr)
+            {
+                const juce::ScopedLock sl (owner.callbackLock);
+                owner.jobFinishedCallback (renderJob, result);
+            }
+        }
+    }
+
+    OfflineRenderer renderer;
+
+    juce::CriticalSection queueLock;
+    std::deque<int> queue;          // Job indices: the owner takes from the front, thieves from the back
+
+private:
+    BatchRenderer& owner;
+    const int index;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Worker)
+};
+
+//==============================================================================
+BatchRenderer::BatchRenderer (int numWorkers)
+{
+    if (numWorkers <= 0)
+        numWorkers = juce::SystemStats::getNumCpus();
+
+    // Every renderer (and its processor) is built here, on the calling thread
+    for (int i = 0; i < numWorkers; ++i)
+        workers.add (new Worker (*this, i));
+}
+
+BatchRenderer::~BatchRenderer()
+{
+    workers.clear();
+}
+
+std::vector<RenderResult> BatchRenderer::run (const juce::Array<RenderJob>& jobs, JobFinishedCallback onJobFinished)
+{
+    std::vector<RenderResult> results ((size_t) jobs.size());
+
+    currentJobs = &jobs;
+    currentResults = &results;
+    jobFinishedCallback = std::move (onJobFinished);
+
+    // Longest first, dealt round robin: the big files start early and the queues come out even
+    std::vector<int> order ((size_t) jobs.size());
+    std::iota (order.begin(), order.end(), 0);
+
+    std::stable_sort (order.begin(), order.end(), [&jobs] (int a, int b)
+    {
+        return jobs.getReference (a).source.getSize() > jobs.getReference (b).source.getSize();
+    });
+
+    for (size_t i = 0; i < order.size(); ++i)
+        workers.getUnchecked ((int) (i % (size_t) workers.size()))->queue.push_back (order[i]);
+
+    for (auto* worker : workers)
+        worker->startThread();
+
+    for (auto* worker : workers)
+        worker->waitForThreadToExit (-1);
+
+    currentJobs = nullptr;
+    currentResults = nullptr;
+    jobFinishedCallback = nullptr;
+
+    return results;
+}
+
+int BatchRenderer::takeJob (int workerIndex)
+{
+    {
+        auto* worker = workers.getUnchecked (workerIndex);
+        const juce::ScopedLock sl (worker->queueLock);
+
+        if (! worker->queue.empty())
+        {
+            const int job = worker->queue.front();
+            worker->queue.pop_front();
+            return job;
+        }
+    }
+
+    // Own queue is empty: steal the smallest remaining job from the next busy worker
+    for (int offset = 1; offset < workers.size(); ++offset)
+    {
+        auto* victim = workers.getUnchecked ((workerIndex + offset) % workers.size());
+        const juce::ScopedLock sl (victim->queueLock);
+
+        if (! victim->queue.empty())
+        {
+            const int job = victim->queue.back();
+            victim->queue.pop_back();
+            return job;
+        }
+    }
+
+    return -1; // Jobs never add jobs, so empty everywhere means done
+}
+
+//==============================================================================
+namespace
+{
+    void applyManifestSettings (const juce::var& entry, RenderSettings& settings)
+    {
+        if (entry.hasProperty ("preset"))
+            settings.preset = entry["preset"].toString();
+
+        if (entry.hasProperty ("seed"))
+            settings.noiseSeed = static_cast<juce::int64> (entry["seed"]);
+
+        if (entry.hasProperty ("block"))
+            settings.blockSize = static_cast<int> (entry["block"]);
+
+        if (entry.hasProperty ("bits"))
+            settings.bitsPerSample = static_cast<int> (entry["bits"]);
+
+        if (auto* parameters = entry["parameters"].getDynamicObject())
+            for (const auto& property : parameters->getProperties())
+                settings.parameters.set (property.name.toString(), property.value.toString());
+
+        settings.readBlockSize = juce::jmax (settings.readBlockSize, settings.blockSize);
+    }
+}
+
+juce::Result BatchRenderer::loadManifest (const juce::File& manifest, const RenderSettings& baseSettings,
+                                          const juce::File& outputDirectory, const juce::String& outputFormat,
+                                          juce::Array<RenderJob>& jobs)
+{
+    juce::var root;
+    const auto parseResult = juce::JSON::parse (manifest.loadFileAsString(), root);
+
+    if (parseResult.failed())
+        return juce::Result::fail (manifest.getFileName() + ": " + parseResult.getErrorMessage());
+
+    const auto* entries = root["jobs"].getArray();
+
+    if (entries == nullptr)
+        return juce::Result::fail (manifest.getFileName() + ": expected a \"jobs\" array");
+
+    auto defaults = baseSettings;
+    applyManifestSettings (root["defaults"], defaults);
+
+    const auto baseDirectory = manifest.getParentDirectory();
+
+    for (const auto& entry : *entries)
+    {
+        const auto input = entry["input"].toString();
+
+        if (input.isEmpty())
+            return juce::Result::fail (manifest.getFileName() + ": job " + juce::String (jobs.size() + 1) + " has no \"input\"");
+
+        RenderJob job;
+        job.source = baseDirectory.getChildFile (input);
+        job.settings = defaults;
+        applyManifestSettings (entry, job.settings);
+
+        if (entry.hasProperty ("output"))
+            job.destination = baseDirectory.getChildFile (entry["output"].toString());
+        else if (outputDirectory != juce::File())
+            job.destination = getOutputFile (job.source, outputDirectory, outputFormat);
+        else
+            return juce::Result::fail (input + " has no \"output\" and no --output-dir was given");
+
+        jobs.add (job);
+    }
+
+    return juce::Result::ok();
+}
+
+juce::File BatchRenderer::getOutputFile (const juce::File& input, const juce::File& outputDirectory, const juce::String& format)
+{
+    const auto extension = format.isNotEmpty() ? "." + format.trimCharactersAtStart (".").toLowerCase()
+                                               : input.getFileExtension();
+
+    return outputDirectory.getChildFile (input.getFileNameWithoutExtension() + extension);
+}
@@ -0,0 +1,89 @@
+/*
+  ==============================================================================
+
+    BatchRenderer.h
+
+    Renders a manifest of files on every core.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "OfflineRenderer.h"
+
+//==============================================================================
+/** One file to render and what to render it with. */
+struct RenderJob
+{
+    juce::File source, destination;
+    RenderSettings settings;
+};
+
+//==============================================================================
+/**
+    Fans render jobs out over a pool of workers, each with its own
+    OfflineRenderer (and so its own TestAudioProcessor - nothing is shared
+    between workers while they render).
+
+    Jobs are dealt out largest file first, round robin, into one queue per
+    worker. A worker takes from the front of its own queue; once that is
+    empty it steals from the back of the others', so a few long files can't
+    leave cores idle at the end of a batch. Each worker's renderer reads
+    ahead and writes behind on its own I/O threads, so reading, processing
+    and writing overlap within every worker as well as across them.
+*/
+class BatchRenderer
+{
+public:
+    // numWorkers <= 0 uses one worker per CPU core
+    explicit BatchRenderer (int numWorkers = 0);
+    ~BatchRenderer();
+
+    int getNumWorkers() const noexcept      { return workers.size(); }
+
+    // Called on the worker thread as each job finishes (calls are serialised)
+    using JobFinishedCallback = std::function<void (const RenderJob&, const RenderResult&)>;
+
+    // Renders every job and returns their results in job order
+    std::vector<RenderResult> run (const juce::Array<RenderJob>& jobs, JobFinishedCallback onJobFinished = {});
+
+    //==============================================================================
+    /** Reads a JSON manifest:
+
+            {
+              "defaults": { "preset": "nokia", "seed": 1, "parameters": { "distortion": 0.4 } },
+              "jobs": [
+                { "input": "stems/line01.wav", "output": "out/line01.flac" },
+                { "input": "stems/line02.wav", "preset": "sony", "parameters": { "tvInterference": 1 } }
+              ]
+            }
+
+        Relative paths are resolved against the manifest's folder. A job without
+        an "output" goes into outputDirectory under its input's name, with the
+        extension of outputFormat if one is given (see getOutputFile()). Job settings
+        start from baseSettings, then "defaults", then the job's own entries
+        (parameters are merged key by key).
+    */
+    static juce::Result loadManifest (const juce::File& manifest, const RenderSettings& baseSettings,
+                                      const juce::File& outputDirectory, const juce::String& outputFormat,
+                                      juce::Array<RenderJob>& jobs);
+
+    // Where an input goes in outputDirectory: same name, with format ("wav", "flac") as the
+    // extension, or the input's own extension if format is empty
+    static juce::File getOutputFile (const juce::File& input, const juce::File& outputDirectory, const juce::String& format);
+
+private:
+    //==============================================================================
+    class Worker;
+
+    int takeJob (int workerIndex);
+
+    juce::OwnedArray<Worker> workers;
+    const juce::Array<RenderJob>* currentJobs = nullptr;
+    std::vector<RenderResult>* currentResults = nullptr;
+    JobFinishedCallback jobFinishedCallback;
+    juce::CriticalSection callbackLock;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BatchRenderer)
+};
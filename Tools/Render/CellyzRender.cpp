@@ -0,0 +1,231 @@
+/*
+  ==============================================================================
+
+    CellyzRender.cpp
+
+    Headless renderer: runs WAV/FLAC files through TestAudioProcessor with a
+    phone preset and parameter overrides, without a DAW.
+
+    Build (from Builds/LinuxMakefile):  make -f Tools.mk CONFIG=Release render
+    Run:  build/CellyzRender [options] input.wav [more inputs...]
+          build/CellyzRender --batch manifest.json [--jobs 32] [options]
+
+      --output <file>        Output file, for a single input (.wav or .flac)
+      --output-dir <dir>     Output folder; each input keeps its name
+      --format <wav|flac>    Output format with --output-dir, also for --batch jobs without an
+                             "output" (default: same as the input)
+      --preset <name>        nokia, iphone or sony
+      --set <id>=<value>     Parameter override, e.g. --set distortion=0.4 (repeatable)
+      --seed <n>             Noise seed (default 1; the same seed renders identical output)
+      --block <n>            Samples per processBlock call (default 4096)
+      --bits <n>             Output bit depth (default: same as the input)
+      --batch <manifest>     Render every job in a JSON manifest (see BatchRenderer.h) on all cores;
+                             the options above become the defaults for its jobs
+      --jobs <n>             Worker count for --batch (default: one per core)
+
+  ==============================================================================
+*/
+
+#include "BatchRenderer.h"
+#include <iostream>
+
+namespace
+{
+    void printUsage()
+    {
+        std::cout << "Usage: CellyzRender [--output <file> | --output-dir <dir> [--format wav|flac]]" << std::endl
+                  << "                    [--preset nokia|iphone|sony] [--set <id>=<value>]... [--seed <n>]" << std::endl
+                  << "                    [--block <n>] [--bits <n>] input [input...]" << std::endl
+                  << "       CellyzRender --batch <manifest.json> [--jobs <n>] [--output-dir <dir> [--format wav|flac]] [options]" << std::endl;
+    }
+
+    bool isValueOption (const juce::String& argument)
+    {
+        return juce::StringArray { "--output", "--output-dir", "--format", "--preset", "--set", "--seed", "--block", "--bits", "--batch", "--jobs" }.contains (argument);
+    }
+
+    //==============================================================================
+    int runBatch (const juce::File& manifest, const RenderSettings& settings, const juce::String& outputDirectoryPath,
+                  const juce::String& format, int numWorkers)
+    {
+        const auto outputDirectory = outputDirectoryPath.isNotEmpty() ? juce::File::getCurrentWorkingDirectory().getChildFile (outputDirectoryPath)
+                                                                      : juce::File();
+        juce::Array<RenderJob> jobs;
+
+        if (const auto loaded = BatchRenderer::loadManifest (manifest, settings, outputDirectory, format, jobs); loaded.failed())
+        {
+            std::cerr << loaded.getErrorMessage() << std::endl;
+            return 1;
+        }
+
+        BatchRenderer batch (numWorkers);
+
+        // Catch bad presets and parameter names before any worker starts
+        {
+            OfflineRenderer checker;
+
+            for (const auto& job : jobs)
+            {
+                if (const auto error = checker.validate (job.settings); error.isNotEmpty())
+                {
+                    std::cerr << job.source.getFileName() << ": " << error << std::endl;
+                    return 1;
+                }
+            }
+        }
+
+        std::cout << "Rendering " << jobs.size() << " files on " << batch.getNumWorkers() << " workers" << std::endl;
+
+        int numFinished = 0;
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+
+        const auto results = batch.run (jobs, [&] (const RenderJob& job, const RenderResult& result)
+        {
+            const auto progress = "[" + juce::String (++numFinished).paddedLeft (' ', juce::String (jobs.size()).length())
+                                    + "/" + juce::String (jobs.size()) + "] ";
+
+            if (result.wasOk())
+                std::cout << progress << job.source.getFileName().paddedRight (' ', 32)
+                          << juce::String (result.getAudioSeconds(), 1).paddedLeft (' ', 9) << " s audio"
+                          << juce::String (result.seconds, 2).paddedLeft (' ', 9) << " s"
+                          << juce::String (result.getRealtimeFactor(), 1).paddedLeft (' ', 9) << "x realtime" << std::endl;
+            else
+                std::cerr << progress << job.source.getFileName() << ": " << result.errorMessage << std::endl;
+        });
+
+        const double wallSeconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks);
+        double audioSeconds = 0.0, renderSeconds = 0.0;
+        int numFailed = 0;
+
+        for (const auto& result : results)
+        {
+            if (! result.wasOk())
+            {
+                ++numFailed;
+                continue;
+            }
+
+            audioSeconds += result.getAudioSeconds();
+            renderSeconds += result.seconds;
+        }
+
+        std::cout << std::endl
+                  << (jobs.size() - numFailed) << " files (" << numFailed << " failed), "
+                  << juce::String (audioSeconds, 1) << " s of audio in " << juce::String (wallSeconds, 2) << " s" << std::endl
+                  << "Aggregate: " << juce::String (wallSeconds > 0.0 ? audioSeconds / wallSeconds : 0.0, 1) << "x realtime, "
+                  << "per worker: " << juce::String (renderSeconds > 0.0 ? audioSeconds / renderSeconds : 0.0, 1) << "x realtime" << std::endl;
+
+        return numFailed == 0 ? 0 : 1;
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ArgumentList args (argc, argv);
+
+    if (args.size() == 0 || args.containsOption ("--help|-h"))
+    {
+        printUsage();
+        return args.size() == 0 ? 1 : 0;
+    }
+
+    // Options with values, and inputs (everything else)
+    RenderSettings settings;
+    juce::String outputPath, outputDirectoryPath, format, manifestPath;
+    int numWorkers = 0;
+    juce::Array<juce::File> inputs;
+
+    for (int i = 0; i < args.size(); ++i)
+    {
+        const auto& argument = args[i].text;
+
+        if (! isValueOption (argument))
+        {
+            if (argument.startsWith ("-"))
+            {
+                std::cerr << "Unknown option " << argument << std::endl;
+                return 1;
+            }
+
+            inputs.add (args[i].resolveAsFile());
+            continue;
+        }
+
+        if (i + 1 >= args.size())
+        {
+            std::cerr << argument << " needs a value" << std::endl;
+            return 1;
+        }
+
+        const auto value = args[++i].text;
+
+        if (argument == "--output")             outputPath = value;
+        else if (argument == "--output-dir")    outputDirectoryPath = value;
+        else if (argument == "--format")        format = value;
+        else if (argument == "--preset")        settings.preset = value;
+        else if (argument == "--seed")          settings.noiseSeed = value.getLargeIntValue();
+        else if (argument == "--block")         settings.blockSize = value.getIntValue();
+        else if (argument == "--bits")          settings.bitsPerSample = value.getIntValue();
+        else if (argument == "--batch")         manifestPath = value;
+        else if (argument == "--jobs")          numWorkers = value.getIntValue();
+        else if (argument == "--set")
+        {
+            if (! value.containsChar ('='))
+            {
+                std::cerr << "--set expects <id>=<value>, got " << value << std::endl;
+                return 1;
+            }
+
+            settings.parameters.set (value.upToFirstOccurrenceOf ("=", false, false).trim(),
+                                     value.fromFirstOccurrenceOf ("=", false, false).trim());
+        }
+    }
+
+    settings.readBlockSize = juce::jmax (settings.readBlockSize, settings.blockSize);
+
+    if (manifestPath.isNotEmpty())
+        return runBatch (juce::File::getCurrentWorkingDirectory().getChildFile (manifestPath), settings,
+                         outputDirectoryPath, format, numWorkers);
+
+    if (inputs.isEmpty() || (outputPath.isEmpty() == outputDirectoryPath.isEmpty()) || (outputPath.isNotEmpty() && inputs.size() > 1))
+    {
+        printUsage();
+        std::cerr << "Give either --output with one input, or --output-dir with any number of inputs" << std::endl;
+        return 1;
+    }
+
+    OfflineRenderer renderer;
+
+    if (const auto error = renderer.validate (settings); error.isNotEmpty())
+    {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+
+    const auto outputDirectory = juce::File::getCurrentWorkingDirectory().getChildFile (outputDirectoryPath);
+    int numFailed = 0;
+
+    for (const auto& input : inputs)
+    {
+        const auto output = outputPath.isNotEmpty() ? juce::File::getCurrentWorkingDirectory().getChildFile (outputPath)
+                                                    : BatchRenderer::getOutputFile (input, outputDirectory, format);
+
+        const auto result = renderer.render (input, output, settings);
+
+        if (result.wasOk())
+        {
+            std::cout << input.getFileName() << " -> " << output.getFullPathName() << "  ("
+                      << juce::String (result.getAudioSeconds(), 1) << " s in " << juce::String (result.seconds, 2) << " s, "
+                      << juce::String (result.getRealtimeFactor(), 1) << "x realtime)" << std::endl;
+        }
+        else
+        {
+            std::cerr << input.getFileName() << ": " << result.errorMessage << std::endl;
+            ++numFailed;
+        }
+    }
+
+    return numFailed == 0 ? 0 : 1;
+}
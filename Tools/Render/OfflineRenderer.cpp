@@ -0,0 +1,256 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer.cpp
+
+  ==============================================================================
+*/
+
+#include "OfflineRenderer.h"
+
+namespace
+{
+    // Plain numbers are values in the parameter's own range; anything else goes through its text parser
+    float getNormalisedValue (juce::RangedAudioParameter& parameter, const juce::String& text)
+    {
+        const auto trimmed = text.trim();
+
+        if (trimmed.containsOnly ("0123456789.-+eE") && trimmed.containsAnyOf ("0123456789"))
+            return parameter.convertTo0to1 (trimmed.getFloatValue());
+
+        return parameter.getValueForText (trimmed);
+    }
+
+    // Keeps the source bit depth when the format can write it, otherwise the deepest one it can
+    int chooseBitDepth (juce::AudioFormat& format, int requestedBits)
+    {
+        const auto possibleDepths = format.getPossibleBitDepths();
+
+        if (possibleDepths.contains (requestedBits))
+            return requestedBits;
+
+        return possibleDepths.isEmpty() ? 16 : possibleDepths.getLast();
+    }
+}
+
+//==============================================================================
+OfflineRenderer::OfflineRenderer()
+    : processor (std::make_unique<TestAudioProcessor>())
+{
+    formatManager.registerBasicFormats();
+    readerThread.startThread();
+    writerThread.startThread();
+}
+
+OfflineRenderer::~OfflineRenderer()
+{
+    readerThread.stopThread (5000);
+    writerThread.stopThread (5000);
+}
+
+//==============================================================================
+bool OfflineRenderer::getPresetPhoneType (const juce::String& presetName, TestAudioProcessor::PhoneType& phoneType)
+{
+    const auto name = presetName.trim().toLowerCase();
+
+    if (name == "nokia")                            { phoneType = TestAudioProcessor::Nokia;        return true; }
+    if (name == "iphone")                           { phoneType = TestAudioProcessor::iPhone;       return true; }
+    if (name == "sony" || name == "sonyericsson")   { phoneType = TestAudioProcessor::SonyEricsson; return true; }
+
+    return false;
+}
+
+juce::String OfflineRenderer::validate (const RenderSettings& settings) const
+{
+    TestAudioProcessor::PhoneType phoneType;
+
+    if (settings.preset.isNotEmpty() && ! getPresetPhoneType (settings.preset, phoneType))
+        return "Unknown preset '" + settings.preset + "' (use nokia, iphone or sony)";
+
+    for (const auto& parameterID : settings.parameters.getAllKeys())
+        if (processor->apvts.getParameter (parameterID) == nullptr)
+            return "Unknown parameter '" + parameterID + "'";
+
+    if (settings.blockSize < 1 || settings.readBlockSize < settings.blockSize)
+        return "The read block must be at least one processing block long";
+
+    return {};
+}
+
+void OfflineRenderer::applySettings (const RenderSettings& settings)
+{
+    // Nothing carries over from the previous file
+    for (auto* parameter : processor->getParameters())
+        parameter->setValueNotifyingHost (parameter->getDefaultValue());
+
+    TestAudioProcessor::PhoneType phoneType;
+
+    if (getPresetPhoneType (settings.preset, phoneType))
+        processor->loadPhonePreset (phoneType);
+
+    const auto& keys = settings.parameters.getAllKeys();
+    const auto& values = settings.parameters.getAllValues();
+
+    for (int i = 0; i < keys.size(); ++i)
+        if (auto* parameter = processor->apvts.getParameter (keys[i]))
+            parameter->setValueNotifyingHost (getNormalisedValue (*parameter, values[i]));
+
+    processor->setNoiseSeed (settings.noiseSeed);
+}
+
+//==============================================================================
+RenderResult OfflineRenderer::render (const juce::File& source, const juce::File& destination, const RenderSettings& settings)
+{
+    RenderResult result;
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+
+    result.errorMessage = validate (settings);
+
+    if (! result.wasOk())
+        return result;
+
+    std::unique_ptr<juce::AudioFormatReader> fileReader (formatManager.createReaderFor (source));
+
+    if (fileReader == nullptr)
+    {
+        result.errorMessage = "Can't read " + source.getFullPathName();
+        return result;
+    }
+
+    const int sourceBitsPerSample = (int) fileReader->bitsPerSample; // The buffering reader reports 32-bit float
+
+    // Decodes a few read blocks ahead on the reader thread; reads block until their data is there
+    auto reader = std::make_unique<juce::BufferingAudioReader> (fileReader.release(), readerThread, settings.readBlockSize * 4);
+    reader->setReadTimeout (-1);
+
+    if (reader->numChannels < 1 || reader->numChannels > 2)
+    {
+        result.errorMessage = source.getFileName() + ": only mono and stereo files are supported";
+        return result;
+    }
+
+    auto* format = formatManager.findFormatForFileExtension (destination.getFileExtension());
+
+    if (format == nullptr || ! getSupportedExtensions().contains (destination.getFileExtension(), true))
+    {
+        result.errorMessage = "Can't write " + destination.getFileExtension() + " files (use .wav or .flac)";
+        return result;
+    }
+
+    if (! destination.getParentDirectory().createDirectory())
+    {
+        result.errorMessage = "Can't create " + destination.getParentDirectory().getFullPathName();
+        return result;
+    }
+
+    // Rendered into a temporary file next to the target, which replaces the target only once complete
+    juce::TemporaryFile temporaryFile (destination);
+
+    {
+        std::unique_ptr<juce::FileOutputStream> stream (temporaryFile.getFile().createOutputStream());
+
+        if (stream == nullptr)
+        {
+            result.errorMessage = "Can't write " + destination.getFullPathName();
+            return result;
+        }
+
+        const int bitsPerSample = chooseBitDepth (*format, settings.bitsPerSample > 0 ? settings.bitsPerSample
+                                                                                      : sourceBitsPerSample);
+
+        std::unique_ptr<juce::AudioFormatWriter> writer (format->createWriterFor (stream.get(), reader->sampleRate, reader->numChannels,
+                                                                                  bitsPerSample, reader->metadataValues, 0));
+
+        if (writer == nullptr)
+        {
+            result.errorMessage = "Can't write " + juce::String (bitsPerSample) + "-bit " + format->getFormatName()
+                                    + " at " + juce::String (reader->sampleRate) + " Hz";
+            return result;
+        }
+
+        stream.release(); // Now owned by the writer
+
+        // Leaves room for a few read blocks, so the DSP never waits for the disk unless the disk really is slower
+        juce::AudioFormatWriter::ThreadedWriter threadedWriter (writer.release(), writerThread, settings.readBlockSize * 4);
+
+        result.errorMessage = renderStream (*reader, threadedWriter, settings, result.numSamples);
+    } // The threaded writer flushes whatever is still queued when it goes out of scope
+
+    if (result.wasOk() && ! temporaryFile.overwriteTargetFileWithTemporary())
+        result.errorMessage = "Can't replace " + destination.getFullPathName();
+
+    result.sampleRate = reader->sampleRate;
+    result.seconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks);
+    return result;
+}
+
+juce::String OfflineRenderer::renderStream (juce::AudioFormatReader& reader, juce::AudioFormatWriter::ThreadedWriter& writer,
+                                            const RenderSettings& settings, juce::int64& samplesWritten)
+{
+    constexpr int numProcessorChannels = 2;
+
+    processor->setRateAndBufferSizeDetails (reader.sampleRate, settings.blockSize);
+    processor->setNonRealtime (true);
+    applySettings (settings);
+    processor->prepareToPlay (reader.sampleRate, settings.blockSize);
+
+    // Run the input through, then the processor's latency and tail worth of silence, and drop the
+    // latency from the front: the output lines up with the input sample for sample, and runs on
+    // for the tail so the jitter buffer and the handset responses' ringing get out
+    const juce::int64 numInputSamples = reader.lengthInSamples;
+    juce::int64 samplesToSkip = processor->getLatencySamples();
+    const auto numTailSamples = (juce::int64) std::ceil (processor->getTailLengthSeconds() * reader.sampleRate);
+    const juce::int64 numSamplesToProcess = numInputSamples + samplesToSkip + numTailSamples;
+
+    juce::AudioBuffer<float> buffer (numProcessorChannels, settings.readBlockSize);
+    juce::MidiBuffer midi;
+    samplesWritten = 0;
+
+    for (juce::int64 position = 0; position < numSamplesToProcess; position += settings.readBlockSize)
+    {
+        const int numThisTime = (int) juce::jmin ((juce::int64) settings.readBlockSize, numSamplesToProcess - position);
+        const int numToRead = (int) juce::jlimit ((juce::int64) 0, (juce::int64) numThisTime, numInputSamples - position);
+
+        buffer.setSize (numProcessorChannels, numThisTime, false, false, true);
+        buffer.clear();
+
+        if (numToRead > 0)
+        {
+            if (! reader.read (buffer.getArrayOfWritePointers(), (int) reader.numChannels, position, numToRead))
+            {
+                processor->releaseResources();
+                return "Read error in " + reader.getFormatName() + " stream";
+            }
+
+            // A mono source feeds both sides of the processor
+            if (reader.numChannels == 1)
+                buffer.copyFrom (1, 0, buffer, 0, 0, numToRead);
+        }
+
+        for (int start = 0; start < numThisTime; start += settings.blockSize)
+        {
+            juce::AudioBuffer<float> block (buffer.getArrayOfWritePointers(), numProcessorChannels, start,
+                                            juce::jmin (settings.blockSize, numThisTime - start));
+            processor->processBlock (block, midi);
+        }
+
+        const int skip = (int) juce::jmin (samplesToSkip, (juce::int64) numThisTime);
+        const int numToWrite = numThisTime - skip;
+        samplesToSkip -= skip;
+
+        if (numToWrite > 0)
+        {
+            // The writer takes as many of these as the output file has channels
+            const float* channels[numProcessorChannels] = { buffer.getReadPointer (0, skip), buffer.getReadPointer (1, skip) };
+
+            // The queue only refuses while the writer thread catches up
+            while (! writer.write (channels, numToWrite))
+                juce::Thread::sleep (1);
+
+            samplesWritten += numToWrite;
+        }
+    }
+
+    processor->releaseResources();
+    return {};
+}
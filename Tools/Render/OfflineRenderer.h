@@ -0,0 +1,87 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer.h
+
+    Renders audio files through TestAudioProcessor without a host or GUI.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "../../Source/PluginProcessor.h"
+
+//==============================================================================
+/** What to render a file with. */
+struct RenderSettings
+{
+    juce::String preset;                // "nokia", "iphone", "sony", or empty for the parameter defaults
+    juce::StringPairArray parameters;   // Parameter ID -> value text ("0.4", "On", "GSM"...), applied after the preset
+    juce::int64 noiseSeed = 1;          // Same seed, same output, on every machine
+    int blockSize = 4096;               // Samples per processBlock call
+    int readBlockSize = 65536;          // Samples read from the source file at once
+    int bitsPerSample = 0;              // 0 keeps the source bit depth where the output format allows it
+};
+
+//==============================================================================
+/** How a render went. */
+struct RenderResult
+{
+    bool wasOk() const noexcept         { return errorMessage.isEmpty(); }
+
+    juce::String errorMessage;
+    juce::int64 numSamples = 0;         // Per channel
+    double sampleRate = 0.0;
+    double seconds = 0.0;               // Wall-clock time spent rendering
+
+    double getAudioSeconds() const noexcept     { return sampleRate > 0.0 ? (double) numSamples / sampleRate : 0.0; }
+    double getRealtimeFactor() const noexcept   { return seconds > 0.0 ? getAudioSeconds() / seconds : 0.0; }
+};
+
+//==============================================================================
+/**
+    Streams files through its own TestAudioProcessor instance.
+
+    The source is read in large blocks and handed to processBlock in
+    RenderSettings::blockSize slices. Reading goes through a
+    BufferingAudioReader and output through an
+    AudioFormatWriter::ThreadedWriter, so decoding the next blocks and
+    encoding/writing the previous ones run on background threads while the
+    current block is being processed. The output
+    is written to a temporary file and only replaces the target once it is
+    complete, so a failed render never leaves a truncated file behind.
+
+    One renderer renders one file at a time; run several renderers to use
+    several cores.
+*/
+class OfflineRenderer
+{
+public:
+    OfflineRenderer();
+    ~OfflineRenderer();
+
+    RenderResult render (const juce::File& source, const juce::File& destination, const RenderSettings& settings);
+
+    // Checks the preset name and parameter IDs up front; returns an error message, or an empty string if all is well
+    juce::String validate (const RenderSettings& settings) const;
+
+    // Maps the names accepted by RenderSettings::preset ("nokia", "iphone", "sony") to a phone type
+    static bool getPresetPhoneType (const juce::String& presetName, TestAudioProcessor::PhoneType& phoneType);
+
+    // Output formats are picked from the destination file's extension
+    static juce::StringArray getSupportedExtensions()   { return { ".wav", ".flac" }; }
+
+private:
+    //==============================================================================
+    void applySettings (const RenderSettings& settings);
+    juce::String renderStream (juce::AudioFormatReader& reader, juce::AudioFormatWriter::ThreadedWriter& writer,
+                               const RenderSettings& settings, juce::int64& samplesWritten);
+
+    juce::AudioFormatManager formatManager;
+    juce::TimeSliceThread readerThread { "Cellyz render reader" };
+    juce::TimeSliceThread writerThread { "Cellyz render writer" };
+    std::unique_ptr<TestAudioProcessor> processor;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OfflineRenderer)
+};